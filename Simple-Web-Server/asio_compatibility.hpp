@@ -46,6 +46,10 @@ namespace SimpleWeb {
   asio::executor get_socket_executor(socket_type &socket) {
     return socket.get_executor();
   }
+  template <typename socket_type, typename handler_type>
+  inline void post_to_socket(socket_type &socket, handler_type &&handler) {
+    asio::post(socket.get_executor(), std::forward<handler_type>(handler));
+  }
   template <typename handler_type>
   void async_resolve(asio::ip::tcp::resolver &resolver, const std::pair<std::string, std::string> &host_port, handler_type &&handler) {
     resolver.async_resolve(host_port.first, host_port.second, std::forward<handler_type>(handler));
@@ -72,6 +76,10 @@ namespace SimpleWeb {
   io_context &get_socket_executor(socket_type &socket) {
     return socket.get_io_service();
   }
+  template <typename socket_type, typename handler_type>
+  inline void post_to_socket(socket_type &socket, handler_type &&handler) {
+    socket.get_io_service().post(std::forward<handler_type>(handler));
+  }
   template <typename handler_type>
   void async_resolve(asio::ip::tcp::resolver &resolver, const std::pair<std::string, std::string> &host_port, handler_type &&handler) {
     resolver.async_resolve(asio::ip::tcp::resolver::query(host_port.first, host_port.second), std::forward<handler_type>(handler));
@@ -26,7 +26,7 @@ namespace SimpleWeb {
      */
     Client(const std::string &server_port_path, bool verify_certificate = true, const std::string &certification_file = std::string(),
            const std::string &private_key_file = std::string(), const std::string &verify_file = std::string())
-        : ClientBase<HTTPS>::ClientBase(server_port_path, 443), context(asio::ssl::context::tlsv12) {
+        : ClientBase<HTTPS>::ClientBase(server_port_path, 443), shared_context(std::make_shared<asio::ssl::context>(asio::ssl::context::tlsv12)), context(*shared_context) {
       if(certification_file.size() > 0 && private_key_file.size() > 0) {
         context.use_certificate_chain_file(certification_file);
         context.use_private_key_file(private_key_file, asio::ssl::context::pem);
@@ -46,8 +46,22 @@ namespace SimpleWeb {
         context.set_verify_mode(asio::ssl::verify_none);
     }
 
+    /**
+     * Constructs a client object using an already configured SSL context. The context may be shared
+     * between several clients, e.g. to load credentials only once.
+     *
+     * @param server_port_path Server resource given by host[:port][/path]
+     * @param context          The configured SSL context to use for all connections.
+     */
+    Client(const std::string &server_port_path, std::shared_ptr<asio::ssl::context> context)
+        : ClientBase<HTTPS>::ClientBase(server_port_path, 443), shared_context(std::move(context)), context(*shared_context) {}
+
+    /// Called before the TLS handshake of a new connection starts, e.g. to set a session to resume.
+    std::function<void(HTTPS &)> on_handshake;
+
   protected:
-    asio::ssl::context context;
+    std::shared_ptr<asio::ssl::context> shared_context;
+    asio::ssl::context &context;
 
     std::shared_ptr<Connection> create_connection() noexcept override {
       return std::make_shared<Connection>(handler_runner, *io_service, context);
@@ -132,6 +146,8 @@ namespace SimpleWeb {
 
     void handshake(const std::shared_ptr<Session> &session) {
       SSL_set_tlsext_host_name(session->connection->socket->native_handle(), this->host.c_str());
+      if(on_handshake)
+        on_handshake(*session->connection->socket);
 
       session->connection->set_timeout(this->config.timeout_connect);
       session->connection->socket->async_handshake(asio::ssl::stream_base::client, [this, session](const error_code &ec) {
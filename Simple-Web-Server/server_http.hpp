@@ -183,6 +183,13 @@ namespace SimpleWeb {
         write(StatusCode::success_ok, std::string(), header);
       }
 
+      /// Runs a function on the executor of the connection. Use this to write the response from a
+      /// thread that does not run the server's io_context.
+      template <typename handler_type>
+      void post(handler_type &&handler) {
+        post_to_socket(*session->connection->socket, std::forward<handler_type>(handler));
+      }
+
       /// If set to true, force server to close the connection after the response have been sent.
       ///
       /// This is useful when implementing a HTTP/1.0-server sending content
@@ -201,6 +208,13 @@ namespace SimpleWeb {
       std::string string() noexcept {
         return std::string(asio::buffers_begin(streambuf.data()), asio::buffers_end(streambuf.data()));
       }
+      /// Returns the content as null-terminated character array without copying it.
+      /// The array stays valid until the content is read from or the request is destroyed.
+      char *c_str() {
+        auto terminator = streambuf.prepare(1);
+        *static_cast<char *>(terminator.data()) = '\0';
+        return const_cast<char *>(static_cast<const char *>(streambuf.data().data()));
+      }
 
     private:
       asio::streambuf &streambuf;
@@ -291,6 +305,14 @@ namespace SimpleWeb {
 
       std::unique_ptr<asio::steady_timer> timer;
 
+      // The following members are guarded by the mutex of the server's connections
+      /// Whether the connection was accepted and counts towards the open connections.
+      bool accepted = false;
+      /// Whether the connection waits for the next request after a kept-alive response.
+      bool idle = false;
+      /// Position in the list of idle connections, valid while idle.
+      typename std::list<Connection *>::iterator idle_position;
+
       void close() noexcept {
         error_code ec;
         socket->lowest_layer().shutdown(asio::ip::tcp::socket::shutdown_both, ec);
@@ -346,6 +368,9 @@ namespace SimpleWeb {
       std::size_t thread_pool_size = 1;
       /// Timeout on request completion. Defaults to 5 seconds.
       long timeout_request = 5;
+      /// Timeout on receiving the first bytes of the next request on a kept-alive connection.
+      /// Set to 0 to wait without timeout. Defaults to 0.
+      long timeout_idle = 0;
       /// Timeout on request/response content completion. Defaults to 300 seconds.
       long timeout_content = 300;
       /// Maximum size of request stream buffer. Defaults to architecture maximum.
@@ -358,6 +383,13 @@ namespace SimpleWeb {
       bool reuse_address = true;
       /// Make use of RFC 7413 or TCP Fast Open (TFO)
       bool fast_open = false;
+      /// Set to true to allow several servers to accept connections on the same port (SO_REUSEPORT).
+      /// The kernel then distributes incoming connections between them. Defaults to false.
+      bool reuse_port = false;
+      /// Maximum number of open connections. Accepting a connection beyond the limit closes the
+      /// least recently used idle connection, or the accepted one if no connection is idle.
+      /// Set to 0 to not limit the connections. Defaults to 0.
+      std::size_t max_connections = 0;
     };
     /// Set before calling start().
     Config config;
@@ -429,6 +461,11 @@ namespace SimpleWeb {
         error_code ec;
         acceptor->set_option(asio::detail::socket_option::integer<IPPROTO_TCP, TCP_FASTOPEN>(qlen), ec);
 #endif // End Linux
+      }
+      if(config.reuse_port) {
+#if defined(SO_REUSEPORT)
+        acceptor->set_option(asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+#endif
       }
       acceptor->bind(endpoint);
 
@@ -470,6 +507,29 @@ namespace SimpleWeb {
       }
     }
 
+    /// Counters of the connections of the server.
+    struct ConnectionStatistics {
+      /// Number of accepted connections not yet closed.
+      std::size_t open = 0;
+      /// Number of open connections waiting for their next request.
+      std::size_t idle = 0;
+      /// Number of idle connections closed to stay within Config::max_connections.
+      std::size_t evicted = 0;
+      /// Number of accepted connections closed because no connection was idle to evict.
+      std::size_t rejected = 0;
+    };
+
+    /// Returns a snapshot of the connection counters.
+    ConnectionStatistics connection_statistics() const {
+      LockGuard lock(connections->mutex);
+      ConnectionStatistics statistics;
+      statistics.open = connections->open;
+      statistics.idle = connections->idle.size();
+      statistics.evicted = connections->evicted;
+      statistics.rejected = connections->rejected;
+      return statistics;
+    }
+
     /// Stop accepting new requests, and close current connections.
     void stop() noexcept {
       std::lock_guard<std::mutex> lock(start_stop_mutex);
@@ -506,6 +566,11 @@ namespace SimpleWeb {
     struct Connections {
       Mutex mutex;
       std::unordered_set<Connection *> set GUARDED_BY(mutex);
+      /// Idle connections, least recently used first.
+      std::list<Connection *> idle GUARDED_BY(mutex);
+      std::size_t open GUARDED_BY(mutex) = 0;
+      std::size_t evicted GUARDED_BY(mutex) = 0;
+      std::size_t rejected GUARDED_BY(mutex) = 0;
     };
     std::shared_ptr<Connections> connections;
 
@@ -525,6 +590,10 @@ namespace SimpleWeb {
           auto it = connections->set.find(connection);
           if(it != connections->set.end())
             connections->set.erase(it);
+          if(connection->idle)
+            connections->idle.erase(connection->idle_position);
+          if(connection->accepted)
+            --connections->open;
         }
         delete connection;
       });
@@ -535,6 +604,65 @@ namespace SimpleWeb {
       return connection;
     }
 
+    /// Counts an accepted connection as open and enforces Config::max_connections.
+    /// Returns false if the accepted connection has to be closed.
+    bool admit(const std::shared_ptr<Connection> &connection) {
+      std::shared_ptr<Connection> evicted;
+      {
+        LockGuard lock(connections->mutex);
+        connection->accepted = true;
+        ++connections->open;
+        if(config.max_connections == 0 || connections->open <= config.max_connections)
+          return true;
+        if(connections->idle.empty()) {
+          ++connections->rejected;
+          return false;
+        }
+        auto least_recently_used = connections->idle.front();
+        connections->idle.pop_front();
+        least_recently_used->idle = false;
+        ++connections->evicted;
+        // A connection that is already being destroyed does not need to be closed
+        evicted = least_recently_used->weak_from_this().lock();
+      }
+      if(evicted)
+        evicted->close();
+      return true;
+    }
+
+    void set_idle(Connection &connection, bool idle) {
+      LockGuard lock(connections->mutex);
+      if(connection.idle == idle)
+        return;
+      connection.idle = idle;
+      if(idle)
+        connection.idle_position = connections->idle.insert(connections->idle.end(), &connection);
+      else
+        connections->idle.erase(connection.idle_position);
+    }
+
+    /// Waits for the next request on a kept-alive connection. The connection is idle, and may be
+    /// evicted, until the first bytes of the request arrive.
+    void read_next(const std::shared_ptr<Session> &session) {
+      set_idle(*session->connection, true);
+      session->connection->set_timeout(config.timeout_idle);
+      auto &streambuf = session->request->streambuf;
+      auto buffer = streambuf.prepare(std::min<std::size_t>(4096, streambuf.max_size()));
+      session->connection->socket->async_read_some(buffer, [this, session](const error_code &ec, std::size_t bytes_transferred) {
+        auto lock = session->connection->handler_runner->continue_lock();
+        if(!lock)
+          return;
+        this->set_idle(*session->connection, false);
+
+        if(!ec) {
+          session->request->streambuf.commit(bytes_transferred);
+          this->read(session);
+        }
+        else if(this->on_error)
+          this->on_error(session->request, ec);
+      });
+    }
+
     void read(const std::shared_ptr<Session> &session) {
       session->connection->set_timeout(config.timeout_request);
       asio::async_read_until(*session->connection->socket, session->request->streambuf, "\r\n\r\n", [this, session](const error_code &ec, std::size_t bytes_transferred) {
@@ -578,6 +706,9 @@ namespace SimpleWeb {
               return;
             }
             if(content_length > num_additional_bytes) {
+              // Reserve the content and its null-terminator at once instead of growing the buffer per read
+              if(content_length < session->request->streambuf.max_size())
+                session->request->streambuf.prepare(content_length - num_additional_bytes + 1);
               asio::async_read(*session->connection->socket, session->request->streambuf, asio::transfer_exactly(content_length - num_additional_bytes), [this, session](const error_code &ec, std::size_t /*bytes_transferred*/) {
                 auto lock = session->connection->handler_runner->continue_lock();
                 if(!lock)
@@ -758,13 +889,13 @@ namespace SimpleWeb {
                 return;
               else if(case_insensitive_equal(it->second, "keep-alive")) {
                 auto new_session = std::make_shared<Session>(this->config.max_request_streambuf_size, response->session->connection);
-                this->read(new_session);
+                this->read_next(new_session);
                 return;
               }
             }
             if(response->session->request->http_version >= "1.1") {
               auto new_session = std::make_shared<Session>(this->config.max_request_streambuf_size, response->session->connection);
-              this->read(new_session);
+              this->read_next(new_session);
               return;
             }
           }
@@ -811,6 +942,10 @@ namespace SimpleWeb {
         auto session = std::make_shared<Session>(config.max_request_streambuf_size, connection);
 
         if(!ec) {
+          if(!this->admit(connection)) {
+            connection->close();
+            return;
+          }
           asio::ip::tcp::no_delay option(true);
           error_code ec;
           session->connection->socket->set_option(option, ec);
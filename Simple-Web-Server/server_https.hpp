@@ -28,7 +28,7 @@ namespace SimpleWeb {
      * @param verify_file        If non-empty, use this certificate authority file to perform verification of client's certificate and hostname according to RFC 2818.
      */
     Server(const std::string &certification_file, const std::string &private_key_file, const std::string &verify_file = std::string())
-        : ServerBase<HTTPS>::ServerBase(443), context(asio::ssl::context::tlsv12) {
+        : ServerBase<HTTPS>::ServerBase(443), shared_context(std::make_shared<asio::ssl::context>(asio::ssl::context::tlsv12)), context(*shared_context) {
       context.use_certificate_chain_file(certification_file);
       context.use_private_key_file(private_key_file, asio::ssl::context::pem);
 
@@ -39,8 +39,22 @@ namespace SimpleWeb {
       }
     }
 
+    /**
+     * Constructs a server object using an already configured SSL context. The context may be shared
+     * between several servers, e.g. to share a TLS session cache. The session id context has to be
+     * set on the context if sessions should be resumed while client certificates are verified.
+     *
+     * @param context The configured SSL context to use for all connections.
+     */
+    explicit Server(std::shared_ptr<asio::ssl::context> context)
+        : ServerBase<HTTPS>::ServerBase(443), shared_context(std::move(context)), context(*shared_context) {}
+
+    /// Called after the TLS handshake of a connection completed successfully.
+    std::function<void(HTTPS &)> on_handshake;
+
   protected:
-    asio::ssl::context context;
+    std::shared_ptr<asio::ssl::context> shared_context;
+    asio::ssl::context &context;
 
     void after_bind() override {
       if(set_session_id_context) {
@@ -67,6 +81,10 @@ namespace SimpleWeb {
         auto session = std::make_shared<Session>(config.max_request_streambuf_size, connection);
 
         if(!ec) {
+          if(!this->admit(connection)) {
+            connection->close();
+            return;
+          }
           asio::ip::tcp::no_delay option(true);
           error_code ec;
           session->connection->socket->lowest_layer().set_option(option, ec);
@@ -77,8 +95,11 @@ namespace SimpleWeb {
             auto lock = session->connection->handler_runner->continue_lock();
             if(!lock)
               return;
-            if(!ec)
+            if(!ec) {
+              if(this->on_handshake)
+                this->on_handshake(*session->connection->socket);
               this->read(session);
+            }
             else if(this->on_error)
               this->on_error(session->request, ec);
           });
@@ -0,0 +1,121 @@
+#include "Log.hpp"
+#include "MetadataProvider.hpp"
+#include "MicroSDC.hpp"
+#include "StateHandler.hpp"
+#include "client_http.hpp"
+#include "networking/NetworkConfig.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Measures GetMdib throughput of the web server for 1 to N I/O threads.
+///
+/// Usage: WebServerBenchmark [maxThreads] [clients] [seconds] [--reuseport]
+
+static constexpr std::uint16_t PORT = 8080;
+static constexpr std::size_t METRIC_COUNT = 32;
+
+static const std::string GET_MDIB_REQUEST =
+    R"(<?xml version="1.0" encoding="utf-8"?>)"
+    R"(<soap:Envelope xmlns:soap="http://www.w3.org/2003/05/soap-envelope")"
+    R"( xmlns:wsa="http://www.w3.org/2005/08/addressing")"
+    R"( xmlns:mm="http://standards.ieee.org/downloads/11073/11073-10207-2017/message">)"
+    R"(<soap:Header>)"
+    R"(<wsa:Action>http://standards.ieee.org/downloads/11073/11073-20701-2018/GetService/GetMdib)"
+    R"(</wsa:Action>)"
+    R"(<wsa:MessageID>urn:uuid:benchmark</wsa:MessageID>)"
+    R"(</soap:Header>)"
+    R"(<soap:Body><mm:GetMdib/></soap:Body>)"
+    R"(</soap:Envelope>)";
+
+std::unique_ptr<MicroSDC> createDevice(std::size_t threads, bool reusePort)
+{
+  auto microSDC = std::make_unique<MicroSDC>();
+  auto networkConfig = std::make_unique<NetworkConfig>(false, "127.0.0.1", PORT);
+  networkConfig->setThreadCount(threads);
+  networkConfig->setReusePort(reusePort);
+  microSDC->setNetworkConfig(std::move(networkConfig));
+  microSDC->setEndpointReference("urn:uuid:MicroSDC-benchmark");
+
+  BICEPS::PM::ChannelDescriptor channel("channel");
+  for (std::size_t i = 0; i < METRIC_COUNT; ++i)
+  {
+    const auto handle = "metric_" + std::to_string(i);
+    channel.Metric.emplace_back(std::make_shared<BICEPS::PM::NumericMetricDescriptor>(
+        handle, BICEPS::PM::CodedValue("3840"), BICEPS::PM::MetricCategory::Msrmt,
+        BICEPS::PM::MetricAvailability::Cont, 1));
+    microSDC->addMdState(std::make_shared<NumericStateHandler>(handle));
+  }
+  BICEPS::PM::VmdDescriptor vmd("vmd");
+  vmd.Channel.emplace_back(channel);
+  BICEPS::PM::MdsDescriptor mds("mds");
+  mds.Vmd.emplace_back(vmd);
+  BICEPS::PM::MdDescription mdDescription;
+  mdDescription.Mds.emplace_back(mds);
+  microSDC->setMdDescription(mdDescription);
+  return microSDC;
+}
+
+double measure(std::size_t clients, std::chrono::seconds duration)
+{
+  std::atomic_bool keepRunning{true};
+  std::atomic<std::size_t> requests{0};
+  std::vector<std::thread> clientThreads;
+  for (std::size_t i = 0; i < clients; ++i)
+  {
+    clientThreads.emplace_back([&]() {
+      SimpleWeb::Client<SimpleWeb::HTTP> client("127.0.0.1:" + std::to_string(PORT));
+      while (keepRunning.load())
+      {
+        try
+        {
+          auto response = client.request(
+              "POST", std::string(MetadataProvider::DEFAULT_BASE_PATH) + "/GetService",
+              GET_MDIB_REQUEST);
+          response->content.string();
+          ++requests;
+        }
+        catch (const SimpleWeb::system_error& e)
+        {
+          std::cerr << "Request failed: " << e.what() << std::endl;
+        }
+      }
+    });
+  }
+  std::this_thread::sleep_for(duration);
+  keepRunning.store(false);
+  for (auto& thread : clientThreads)
+  {
+    thread.join();
+  }
+  return static_cast<double>(requests.load()) / static_cast<double>(duration.count());
+}
+
+int main(int argc, char* argv[])
+{
+  Log::setLogLevel(LogLevel::WARNING);
+  const std::size_t maxThreads =
+      argc > 1 ? std::stoul(argv[1]) : std::thread::hardware_concurrency();
+  const std::size_t clients = argc > 2 ? std::stoul(argv[2]) : 2 * maxThreads;
+  const std::chrono::seconds duration(argc > 3 ? std::stoul(argv[3]) : 5);
+  const bool reusePort = argc > 4 && std::strcmp(argv[4], "--reuseport") == 0;
+
+  std::cout << "GetMdib throughput with " << clients << " clients, " << METRIC_COUNT
+            << " metrics, " << (reusePort ? "SO_REUSEPORT acceptors" : "shared acceptor")
+            << std::endl;
+  for (std::size_t threads = 1; threads <= maxThreads; ++threads)
+  {
+    auto microSDC = createDevice(threads, reusePort);
+    microSDC->start();
+    const auto throughput = measure(clients, duration);
+    microSDC->stop();
+    std::cout << std::setw(3) << threads << " thread(s): " << std::fixed << std::setprecision(1)
+              << throughput << " requests/s" << std::endl;
+  }
+  return 0;
+}
@@ -1,10 +1,15 @@
 #include "ClientSession.esp.hpp"
 #include "Log.hpp"
+#include <array>
+#include <chrono>
 
 #include "esp_http_client.h"
 
-std::unique_ptr<ClientSessionInterface> ClientSessionFactory::produce(const std::string& address)
+std::unique_ptr<ClientSessionInterface>
+ClientSessionFactory::produce(const std::string& address,
+                              std::shared_ptr<asio::io_context> /*ioContext*/)
 {
+  // esp_http_client sends synchronously on the calling task
   return std::make_unique<ClientSessionEsp32>(address);
 }
 
@@ -21,6 +26,8 @@ ClientSessionEsp32::ClientSessionEsp32(std::string notifyTo)
   config.transport_type = HTTP_TRANSPORT_OVER_TCP;
   config.use_global_ca_store = true;
   config.skip_cert_common_name_check = true;
+  config.timeout_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(REQUEST_TIMEOUT).count();
   session_ = esp_http_client_init(&config);
 }
 
@@ -37,18 +44,38 @@ ClientSessionEsp32::~ClientSessionEsp32()
   }
 }
 
-void ClientSessionEsp32::send(const std::string& message)
+bool ClientSessionEsp32::send(const Notification& notification)
 {
-  esp_http_client_set_post_field(session_, message.c_str(), message.length());
-  esp_err_t err = esp_http_client_perform(session_);
-  if (err == ESP_OK)
+  esp_err_t err = esp_http_client_open(session_, notification.size());
+  if (err != ESP_OK)
   {
-    LOG(LogLevel::DEBUG, "HTTPS Status = " << esp_http_client_get_status_code(session_)
-                                           << " , content_length = "
-                                           << esp_http_client_get_content_length(session_));
+    LOG(LogLevel::ERROR, "Error open http connection " << esp_err_to_name(err));
+    return false;
   }
-  else
+  // write the fragments subsequently instead of gathering them into a single buffer first
+  for (const auto* fragment :
+       {notification.prefix.get(), &notification.header, notification.suffix.get()})
+  {
+    if (esp_http_client_write(session_, fragment->c_str(), fragment->length()) < 0)
+    {
+      LOG(LogLevel::ERROR, "Error writing notification to " << notifyTo_);
+      esp_http_client_close(session_);
+      return false;
+    }
+  }
+  const auto contentLength = esp_http_client_fetch_headers(session_);
+  if (contentLength < 0)
+  {
+    LOG(LogLevel::ERROR, "Error receiving response from " << notifyTo_);
+    esp_http_client_close(session_);
+    return false;
+  }
+  const auto status = esp_http_client_get_status_code(session_);
+  LOG(LogLevel::DEBUG, "HTTPS Status = " << status << " , content_length = " << contentLength);
+  // drain the response to keep the connection alive for the next notification
+  std::array<char, 64> drain{};
+  while (esp_http_client_read(session_, drain.data(), drain.size()) > 0)
   {
-    LOG(LogLevel::ERROR, "Error perform http request " << esp_err_to_name(err));
   }
+  return status >= 200 && status < 300;
 }
@@ -13,7 +13,7 @@ public:
   ClientSessionEsp32& operator=(const ClientSessionEsp32&) = delete;
   ClientSessionEsp32& operator=(ClientSessionEsp32&&) = delete;
   ~ClientSessionEsp32() override;
-  void send(const std::string& message) override;
+  bool send(const Notification& notification) override;
 
 private:
   esp_http_client* session_{};
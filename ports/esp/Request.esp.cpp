@@ -1,11 +1,41 @@
 #include "Request.esp.hpp"
+#include "esp_idf_version.h"
 
-RequestEsp32::RequestEsp32(httpd_req_t* req, std::string msg)
-  : Request(std::move(msg))
+RequestEsp32::RequestEsp32(httpd_req_t* req, std::unique_ptr<char[]> message,
+                           AdmissionControl::Ticket ticket)
+  : Request(message.get())
   , httpdReq_(req)
+  , message_(std::move(message))
+  , ticket_(std::move(ticket))
 {
 }
 
+RequestEsp32::~RequestEsp32()
+{
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+  if (deferred_)
+  {
+    httpd_req_async_handler_complete(httpdReq_);
+  }
+#endif
+}
+
+bool RequestEsp32::defer()
+{
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+  httpd_req_t* asyncReq = nullptr;
+  if (httpd_req_async_handler_begin(httpdReq_, &asyncReq) != ESP_OK)
+  {
+    return false;
+  }
+  httpdReq_ = asyncReq;
+  deferred_ = true;
+  return true;
+#else
+  return false;
+#endif
+}
+
 void RequestEsp32::sendResponse(const std::string& msg) const
 {
   httpd_resp_send(httpdReq_, msg.c_str(), msg.length());
@@ -1,15 +1,37 @@
 #pragma once
 
+#include "WebServer/AdmissionControl.hpp"
 #include "WebServer/Request.hpp"
 #include "esp_https_server.h"
+#include <memory>
 
 class RequestEsp32 : public Request
 {
 public:
-  explicit RequestEsp32(httpd_req_t* req, std::string msg);
+  /// @brief constructs a request parsing the received message in place
+  /// @param req the httpd request to respond to
+  /// @param message the received null-terminated message
+  /// @param ticket the in-flight slot of the admitted request
+  RequestEsp32(httpd_req_t* req, std::unique_ptr<char[]> message, AdmissionControl::Ticket ticket);
+  RequestEsp32(const RequestEsp32&) = delete;
+  RequestEsp32(RequestEsp32&&) = delete;
+  RequestEsp32& operator=(const RequestEsp32&) = delete;
+  RequestEsp32& operator=(RequestEsp32&&) = delete;
+  ~RequestEsp32() override;
+
+  /// @brief copies the httpd request, so httpd keeps the connection open after the handler
+  /// returned and the response can be sent from any task. Requires ESP-IDF 5.1 or later.
+  /// @return whether the request was deferred
+  bool defer() override;
 
 private:
   void sendResponse(const std::string& msg) const override;
 
   httpd_req_t* httpdReq_;
+  /// whether httpdReq_ is an asynchronous copy that has to be completed
+  bool deferred_{false};
+  /// the receive buffer holding the message
+  std::unique_ptr<char[]> message_;
+  /// counts this request as in flight until it is destroyed
+  AdmissionControl::Ticket ticket_;
 };
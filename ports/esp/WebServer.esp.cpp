@@ -5,19 +5,23 @@
 #include "networking/NetworkConfig.hpp"
 #include "rapidxml.hpp"
 #include "services/ServiceInterface.hpp"
+#include "lwip/sockets.h"
 #include <algorithm>
 #include <array>
 #include <memory>
 #include <string>
-#include <vector>
 
 std::unique_ptr<WebServerInterface>
-WebServerFactory::produce(const std::shared_ptr<const NetworkConfig>& networkConfig)
+WebServerFactory::produce(const std::shared_ptr<const NetworkConfig>& networkConfig,
+                          std::shared_ptr<asio::io_context> /*ioContext*/)
 {
-  return std::make_unique<WebServerEsp32>(networkConfig->useTLS());
+  // esp_http_server runs its own task
+  return std::make_unique<WebServerEsp32>(*networkConfig);
 }
 
-WebServerEsp32::WebServerEsp32(bool useTLS)
+WebServerEsp32::WebServerEsp32(const NetworkConfig& networkConfig)
+  : admission_(networkConfig)
+  , bodyTimeout_(networkConfig.bodyTimeout())
 {
   extern const unsigned char ca_crt_start[] asm("_binary_ca_crt_start");
   extern const unsigned char ca_crt_end[] asm("_binary_ca_crt_end");
@@ -33,10 +37,28 @@ WebServerEsp32::WebServerEsp32(bool useTLS)
   config_.prvtkey_pem = server_key_start;
   config_.prvtkey_len = server_key_end - server_key_start;
 
-  config_.transport_mode = useTLS ? HTTPD_SSL_TRANSPORT_SECURE : HTTPD_SSL_TRANSPORT_INSECURE;
+  config_.transport_mode = networkConfig.useTLS() ? HTTPD_SSL_TRANSPORT_SECURE
+                                                  : HTTPD_SSL_TRANSPORT_INSECURE;
+  config_.port_secure = networkConfig.port();
+  config_.port_insecure = networkConfig.port();
+#ifdef CONFIG_ESP_TLS_SERVER_SESSION_TICKETS
+  config_.session_tickets = networkConfig.tlsSessionTickets();
+#endif
   // use the URI wildcard matching function
   config_.httpd.uri_match_fn = httpd_uri_match_wildcard;
+  // close the least recently used connection when the socket limit is reached. httpd does not
+  // time out idle connections, so the idle timeout has no equivalent here.
   config_.httpd.lru_purge_enable = true;
+  if (networkConfig.maxConnections() > 0)
+  {
+    // httpd uses three of the lwip sockets internally
+    config_.httpd.max_open_sockets = static_cast<std::uint16_t>(
+        std::min<std::size_t>(networkConfig.maxConnections(), CONFIG_LWIP_MAX_SOCKETS - 3));
+  }
+  // httpd applies these per socket operation instead of per request part
+  config_.httpd.recv_wait_timeout = static_cast<std::uint16_t>(
+      std::max(networkConfig.headerTimeout(), networkConfig.bodyTimeout()).count());
+  config_.httpd.send_wait_timeout = static_cast<std::uint16_t>(networkConfig.bodyTimeout().count());
   config_.httpd.stack_size = 16384;
 }
 
@@ -64,42 +86,90 @@ void WebServerEsp32::stop()
   httpd_stop(server_);
 }
 
+WebServerStatistics WebServerEsp32::statistics() const
+{
+  // esp_https_server does not report whether a handshake resumed a session nor which connections
+  // are idle or were purged
+  WebServerStatistics statistics;
+  statistics.rejectedRequests = admission_.statistics();
+  std::array<int, CONFIG_LWIP_MAX_SOCKETS> clients{};
+  std::size_t clientCount = clients.size();
+  if (server_ != nullptr && httpd_get_client_list(server_, &clientCount, clients.data()) == ESP_OK)
+  {
+    statistics.openConnections = clientCount;
+  }
+  return statistics;
+}
+
 void WebServerEsp32::addService(std::shared_ptr<ServiceInterface> service)
 {
-  services_.emplace_back(service);
+  router_.addService(std::move(service));
 }
 
 esp_err_t WebServerEsp32::handlerCallback(httpd_req_t* req)
 {
-  std::vector<char> buffer;
-  buffer.resize(req->content_len + 1);
-  size_t received = httpd_req_recv(req, buffer.data(), req->content_len);
-  if (received != req->content_len)
-  {
-    LOG(LogLevel::ERROR, "Could not receive all bytes!");
-    return ESP_FAIL;
-  }
-  // null-terminate the buffer
-  buffer.emplace_back('\0');
-  LOG(LogLevel::DEBUG, "Received " << std::to_string(received) << " of "
-                                   << std::to_string(req->content_len) << " bytes: \n"
-                                   << buffer.data());
   auto* webServer = static_cast<WebServerEsp32*>(req->user_ctx);
   LOG(LogLevel::INFO, "Dispatch URI: " << req->uri);
-  auto service = std::find_if(
-      webServer->services_.begin(), webServer->services_.end(),
-      [&](const auto& service) { return strcmp(service->getURI().c_str(), req->uri) == 0; });
-  if (service == webServer->services_.end())
+
+  // admit the request before receiving its content
+  std::array<char, INET6_ADDRSTRLEN> client{};
+  sockaddr_in6 peer{};
+  socklen_t peerLength = sizeof(peer);
+  if (getpeername(httpd_req_to_sockfd(req), reinterpret_cast<sockaddr*>(&peer), &peerLength) == 0)
+  {
+    inet_ntop(AF_INET6, &peer.sin6_addr, client.data(), client.size());
+  }
+  AdmissionControl::Ticket ticket;
+  const auto decision = webServer->admission_.admit(client.data(), req->content_len, ticket);
+  if (decision != AdmissionControl::Decision::ADMITTED)
+  {
+    return reject(req, decision);
+  }
+
+  const auto service = webServer->router_.route(req->uri);
+  if (service == nullptr)
   {
     // send 404 and close socket
     httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "404 Service not found");
     return ESP_FAIL;
   }
 
+  // receive the content sized by Content-Length directly into the buffer parsed by the request
+  std::unique_ptr<char[]> buffer(new char[req->content_len + 1]);
+  std::size_t received = 0;
+  const auto deadline = std::chrono::steady_clock::now() + webServer->bodyTimeout_;
+  while (received < req->content_len)
+  {
+    const auto ret = httpd_req_recv(req, buffer.get() + received, req->content_len - received);
+    if (ret == HTTPD_SOCK_ERR_TIMEOUT)
+    {
+      // retry a receive timeout only while the body timeout did not elapse, so a stalling client
+      // does not pin the server task
+      if (std::chrono::steady_clock::now() < deadline)
+      {
+        continue;
+      }
+      LOG(LogLevel::WARNING, "Timed out receiving the content of " << req->uri);
+      httpd_resp_send_err(req, HTTPD_408_REQ_TIMEOUT, "408 Request Timeout");
+      return ESP_FAIL;
+    }
+    if (ret <= 0)
+    {
+      LOG(LogLevel::ERROR, "Could not receive all bytes!");
+      return ESP_FAIL;
+    }
+    received += static_cast<std::size_t>(ret);
+  }
+  // null-terminate the buffer
+  buffer[received] = '\0';
+  LOG(LogLevel::DEBUG, "Received " << std::to_string(received) << " of "
+                                   << std::to_string(req->content_len) << " bytes: \n"
+                                   << buffer.get());
+
   try
   {
-    (*service)->handleRequest(
-        std::make_unique<RequestEsp32>(req, std::string(buffer.begin(), buffer.end())));
+    service->handleRequest(
+        std::make_unique<RequestEsp32>(req, std::move(buffer), std::move(ticket)));
   }
   catch (rapidxml::parse_error& e)
   {
@@ -125,6 +195,28 @@ esp_err_t WebServerEsp32::handlerCallback(httpd_req_t* req)
   return ESP_OK;
 }
 
+esp_err_t WebServerEsp32::reject(httpd_req_t* req, AdmissionControl::Decision decision)
+{
+  switch (decision)
+  {
+    case AdmissionControl::Decision::PAYLOAD_TOO_LARGE:
+      httpd_resp_set_status(req, "413 Payload Too Large");
+      httpd_resp_send(req, nullptr, 0);
+      // close the connection instead of draining the content
+      return ESP_FAIL;
+    case AdmissionControl::Decision::TOO_MANY_REQUESTS:
+      httpd_resp_set_status(req, "429 Too Many Requests");
+      break;
+    case AdmissionControl::Decision::OVERLOADED:
+    case AdmissionControl::Decision::ADMITTED:
+      httpd_resp_set_status(req, "503 Service Unavailable");
+      break;
+  }
+  httpd_resp_set_hdr(req, "Retry-After", "1");
+  httpd_resp_send(req, nullptr, 0);
+  return ESP_OK;
+}
+
 void WebServerEsp32::registerUriHandlers()
 {
   LOG(LogLevel::INFO, "Registering URI handlers...");
@@ -1,24 +1,38 @@
 #pragma once
 
+#include "WebServer/AdmissionControl.hpp"
+#include "WebServer/Router.hpp"
 #include "WebServer/WebServer.hpp"
 #include "esp_https_server.h"
+#include <chrono>
 #include <vector>
 
+class NetworkConfig;
 class ServiceInterface;
 
 class WebServerEsp32 : public WebServerInterface
 {
 public:
-  explicit WebServerEsp32(bool useTLS);
+  explicit WebServerEsp32(const NetworkConfig& networkConfig);
   void start() override;
   void stop() override;
 
   void addService(std::shared_ptr<ServiceInterface> service) override;
+  WebServerStatistics statistics() const override;
 
 private:
   httpd_handle_t server_{nullptr};
   httpd_ssl_config_t config_ = HTTPD_SSL_CONFIG_DEFAULT();
-  std::vector<std::shared_ptr<ServiceInterface>> services_;
+  Router router_;
+  /// decides which requests are handled before receiving their content
+  AdmissionControl admission_;
+  /// the time to receive the content of a request, however many receive timeouts it spans
+  const std::chrono::seconds bodyTimeout_;
   static esp_err_t handlerCallback(httpd_req_t* req);
+  /// @brief answers a request that was not admitted
+  /// @param req the rejected request
+  /// @param decision the reason of the rejection
+  /// @return the result to return from the handler
+  static esp_err_t reject(httpd_req_t* req, AdmissionControl::Decision decision);
   void registerUriHandlers();
 };
@@ -1,18 +1,288 @@
 #include "ClientSession.linux.hpp"
-#include <regex>
+#include <future>
 
-std::unique_ptr<ClientSessionInterface> ClientSessionFactory::produce(const std::string& address)
+std::unique_ptr<ClientSessionInterface>
+ClientSessionFactory::produce(const std::string& address,
+                              std::shared_ptr<asio::io_context> ioContext)
 {
-  return std::make_unique<ClientSessionSimple>(address);
+  auto url = URL::parse(address);
+  if (ioContext == nullptr)
+  {
+    ioContext = ClientIOContext::instance().ioContext();
+  }
+  if (url.isSecure())
+  {
+    return std::make_unique<ClientSessionSimple<SimpleWeb::HTTPS>>(std::move(url),
+                                                                    std::move(ioContext));
+  }
+  return std::make_unique<ClientSessionSimple<SimpleWeb::HTTP>>(std::move(url),
+                                                                 std::move(ioContext));
 }
 
-ClientSessionSimple::ClientSessionSimple(const std::string& address)
-  : client_(std::regex_replace(address, std::regex("http(s)?://"), ""), false, "certs/server.crt",
-            "certs/server.key", "certs/ca.crt")
+ClientTLSContext::ClientTLSContext()
+  : context_(std::make_shared<asio::ssl::context>(asio::ssl::context::tlsv12))
+  , hostPortIndex_(SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr))
 {
+  context_->use_certificate_chain_file("certs/server.crt");
+  context_->use_private_key_file("certs/server.key", asio::ssl::context::pem);
+  context_->load_verify_file("certs/ca.crt");
+  context_->set_verify_mode(asio::ssl::verify_none);
+  // OpenSSL does not look up client sessions itself, they are set by prepare() before handshakes
+  SSL_CTX_set_session_cache_mode(context_->native_handle(),
+                                 SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+  SSL_CTX_sess_set_new_cb(context_->native_handle(), &ClientTLSContext::onNewSession);
 }
 
-void ClientSessionSimple::send(const std::string& message)
+ClientTLSContext::~ClientTLSContext()
 {
-  client_.request("POST", "", message);
+  for (auto& [hostPort, session] : sessions_)
+  {
+    SSL_SESSION_free(session);
+  }
 }
+
+ClientTLSContext& ClientTLSContext::instance()
+{
+  static ClientTLSContext instance;
+  return instance;
+}
+
+std::shared_ptr<asio::ssl::context> ClientTLSContext::context() const
+{
+  return context_;
+}
+
+void ClientTLSContext::prepare(SimpleWeb::HTTPS& socket, const std::string& hostPort)
+{
+  auto* ssl = socket.native_handle();
+  SSL_set_ex_data(ssl, hostPortIndex_, const_cast<std::string*>(&hostPort));
+  std::lock_guard<std::mutex> lock(sessionsMutex_);
+  const auto it = sessions_.find(hostPort);
+  if (it != sessions_.end())
+  {
+    // the connection gets its own copy, as an unclean close marks its session as not resumable
+    auto* session = SSL_SESSION_dup(it->second);
+    SSL_set_session(ssl, session);
+    SSL_SESSION_free(session);
+  }
+}
+
+int ClientTLSContext::onNewSession(SSL* ssl, SSL_SESSION* session)
+{
+  auto& self = instance();
+  const auto* hostPort = static_cast<const std::string*>(SSL_get_ex_data(ssl, self.hostPortIndex_));
+  if (hostPort == nullptr)
+  {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(self.sessionsMutex_);
+  auto& cached = self.sessions_[*hostPort];
+  if (cached != nullptr)
+  {
+    SSL_SESSION_free(cached);
+  }
+  // Simple-Web-Server closes connections without SSL_shutdown, which marks their sessions as not
+  // resumable. Keep a copy that is unaffected by that.
+  cached = SSL_SESSION_dup(session);
+  return 0;
+}
+
+ClientIOContext::ClientIOContext()
+  : ioContext_(std::make_shared<asio::io_context>())
+  , workGuard_(asio::make_work_guard(*ioContext_))
+  , thread_([this]() { ioContext_->run(); })
+{
+}
+
+ClientIOContext::~ClientIOContext()
+{
+  workGuard_.reset();
+  ioContext_->stop();
+  thread_.join();
+}
+
+ClientIOContext& ClientIOContext::instance()
+{
+  static ClientIOContext instance;
+  return instance;
+}
+
+std::shared_ptr<asio::io_context> ClientIOContext::ioContext() const
+{
+  return ioContext_;
+}
+
+template <class SocketType>
+std::shared_ptr<ClientConnection<SocketType>>
+ClientConnection<SocketType>::get(const URL& url, std::shared_ptr<asio::io_context> ioContext)
+{
+  static std::mutex connectionsMutex;
+  static std::map<std::pair<std::string, const asio::io_context*>,
+                  std::weak_ptr<ClientConnection>>
+      connections;
+  std::lock_guard<std::mutex> lock(connectionsMutex);
+  for (auto it = connections.begin(); it != connections.end();)
+  {
+    it = it->second.expired() ? connections.erase(it) : std::next(it);
+  }
+  const auto hostPort = url.hostPort();
+  auto& weakConnection = connections[{hostPort, ioContext.get()}];
+  auto connection = weakConnection.lock();
+  if (connection == nullptr)
+  {
+    connection = std::make_shared<ClientConnection>(hostPort, std::move(ioContext));
+    weakConnection = connection;
+  }
+  return connection;
+}
+
+template <>
+ClientConnection<SimpleWeb::HTTPS>::ClientConnection(std::string hostPort,
+                                                     std::shared_ptr<asio::io_context> ioContext)
+  : hostPort_(std::move(hostPort))
+  , strand_(asio::make_strand(*ioContext))
+  , client_(hostPort_, ClientTLSContext::instance().context())
+{
+  client_.io_service = std::move(ioContext);
+  client_.config.timeout_connect = ClientSessionInterface::CONNECT_TIMEOUT.count();
+  client_.config.timeout = ClientSessionInterface::REQUEST_TIMEOUT.count();
+  client_.on_handshake = [this](SimpleWeb::HTTPS& socket) {
+    ClientTLSContext::instance().prepare(socket, hostPort_);
+  };
+}
+
+template <>
+ClientConnection<SimpleWeb::HTTP>::ClientConnection(std::string hostPort,
+                                                    std::shared_ptr<asio::io_context> ioContext)
+  : hostPort_(std::move(hostPort))
+  , strand_(asio::make_strand(*ioContext))
+  , client_(hostPort_)
+{
+  client_.io_service = std::move(ioContext);
+  client_.config.timeout_connect = ClientSessionInterface::CONNECT_TIMEOUT.count();
+  client_.config.timeout = ClientSessionInterface::REQUEST_TIMEOUT.count();
+}
+
+template <class SocketType>
+void ClientConnection<SocketType>::enqueue(std::string path, Notification notification,
+                                           ClientSessionInterface::SendCallback callback)
+{
+  asio::post(strand_,
+             [self = this->shared_from_this(),
+              request = PendingRequest{std::move(path), std::move(notification),
+                                       std::move(callback),
+                                       std::chrono::steady_clock::now()}]() mutable {
+               self->queue_.emplace_back(std::move(request));
+               self->sendNext();
+             });
+}
+
+template <class SocketType>
+void ClientConnection<SocketType>::sendNext()
+{
+  if (busy_ || queue_.empty())
+  {
+    return;
+  }
+  busy_ = true;
+  const auto& notification = queue_.front().notification;
+  buffer_.clear();
+  buffer_.reserve(notification.size());
+  buffer_.append(*notification.prefix).append(notification.header).append(*notification.suffix);
+  // the client copies the content into its request stream, so the buffer can be reused. The
+  // completion must not own the connection, the client waits for it when being destroyed.
+  client_.request(
+      "POST", queue_.front().path, buffer_,
+      [weakSelf = this->weak_from_this()](
+          std::shared_ptr<typename SimpleWeb::Client<SocketType>::Response> response,
+          const SimpleWeb::error_code& ec) {
+        auto self = weakSelf.lock();
+        if (self == nullptr)
+        {
+          // the last session to the server was released while the request was in flight
+          return;
+        }
+        const auto completed = std::chrono::steady_clock::now();
+        SendResult result;
+        if (ec)
+        {
+          result.status = ec.message();
+        }
+        else
+        {
+          result.status = response->status_code;
+          result.delivered = response->status_code.compare(0, 1, "2") == 0;
+        }
+        // continue on the strand outside of the client's handler, which must not destroy the
+        // client. The posted handler takes over the reference, so it releases the last one.
+        const auto strand = self->strand_;
+        asio::post(strand, [self = std::move(self), completed, result]() mutable {
+          auto request = std::move(self->queue_.front());
+          self->queue_.pop_front();
+          result.latency = std::chrono::duration_cast<std::chrono::microseconds>(
+              completed - request.queued);
+          request.callback(result);
+          self->busy_ = false;
+          self->sendNext();
+        });
+      });
+}
+
+template <>
+ClientSessionSimple<SimpleWeb::HTTPS>::ClientSessionSimple(
+    URL url, std::shared_ptr<asio::io_context> ioContext)
+  : url_(std::move(url))
+  , connection_(ClientConnection<SimpleWeb::HTTPS>::get(url_, std::move(ioContext)))
+  , guard_(std::make_shared<CallbackGuard>())
+{
+}
+
+template <>
+ClientSessionSimple<SimpleWeb::HTTP>::ClientSessionSimple(
+    URL url, std::shared_ptr<asio::io_context> ioContext)
+  : url_(std::move(url))
+  , connection_(ClientConnection<SimpleWeb::HTTP>::get(url_, std::move(ioContext)))
+  , guard_(std::make_shared<CallbackGuard>())
+{
+}
+
+template <class SocketType>
+ClientSessionSimple<SocketType>::~ClientSessionSimple()
+{
+  std::lock_guard<std::mutex> lock(guard_->mutex);
+  guard_->alive = false;
+}
+
+template <class SocketType>
+bool ClientSessionSimple<SocketType>::send(const Notification& notification)
+{
+  std::promise<bool> delivered;
+  auto future = delivered.get_future();
+  sendAsync(notification,
+            [&delivered](const SendResult& result) { delivered.set_value(result.delivered); });
+  return future.get();
+}
+
+template <class SocketType>
+void ClientSessionSimple<SocketType>::sendAsync(const Notification& notification,
+                                                SendCallback callback)
+{
+  connection_->enqueue(url_.path, notification,
+                       [guard = guard_, callback = std::move(callback)](const SendResult& result) {
+                         std::lock_guard<std::mutex> lock(guard->mutex);
+                         if (!guard->alive)
+                         {
+                           return;
+                         }
+                         if (!result.delivered)
+                         {
+                           LOG(LogLevel::ERROR, "Error sending notification: " << result.status);
+                         }
+                         callback(result);
+                       });
+}
+
+template class ClientConnection<SimpleWeb::HTTP>;
+template class ClientConnection<SimpleWeb::HTTPS>;
+template class ClientSessionSimple<SimpleWeb::HTTP>;
+template class ClientSessionSimple<SimpleWeb::HTTPS>;
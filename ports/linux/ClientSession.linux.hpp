@@ -3,14 +3,184 @@
 #include "Log.hpp"
 #include "SessionManager/SessionManager.hpp"
 #include "client_https.hpp"
+#include "networking/URL.hpp"
+#include <asio/ssl.hpp>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
 
+/// @brief ClientTLSContext holds the process wide TLS context of all outbound connections. The
+/// credentials are loaded once and sessions negotiated with a server are cached by host and port,
+/// so new connections to the same server resume the session instead of a full handshake.
+class ClientTLSContext
+{
+public:
+  ClientTLSContext(const ClientTLSContext&) = delete;
+  ClientTLSContext(ClientTLSContext&&) = delete;
+  ClientTLSContext& operator=(const ClientTLSContext&) = delete;
+  ClientTLSContext& operator=(ClientTLSContext&&) = delete;
+  ~ClientTLSContext();
+
+  /// @brief gets the process wide instance, loading the credentials on first use
+  /// @return the shared client context
+  static ClientTLSContext& instance();
+
+  /// @brief gets the SSL context to construct clients with
+  /// @return the shared SSL context
+  std::shared_ptr<asio::ssl::context> context() const;
+
+  /// @brief prepares a connection before its handshake by setting the cached session of its
+  /// server, if any
+  /// @param socket the socket of the connection
+  /// @param hostPort the server of the connection. Has to outlive the connection.
+  void prepare(SimpleWeb::HTTPS& socket, const std::string& hostPort);
+
+private:
+  ClientTLSContext();
+
+  /// @brief OpenSSL callback storing a session negotiated with a server
+  /// @param ssl the connection the session was negotiated on
+  /// @param session the new session
+  /// @return 0 as the session itself is not kept
+  static int onNewSession(SSL* ssl, SSL_SESSION* session);
+
+  /// the SSL context shared by all outbound connections
+  std::shared_ptr<asio::ssl::context> context_;
+  /// index of the host and port a connection belongs to in its SSL ex data. The app data is
+  /// occupied by asio.
+  const int hostPortIndex_;
+  /// mutex protecting the cached sessions
+  std::mutex sessionsMutex_;
+  /// the last session negotiated with a server, by host and port
+  std::map<std::string, SSL_SESSION*> sessions_;
+};
+
+/// @brief ClientIOContext runs the io_context all outbound connections are multiplexed on, so
+/// round trips to many clients overlap on a single thread. Connections of sessions created for
+/// another io context run on that one instead.
+class ClientIOContext
+{
+public:
+  ClientIOContext(const ClientIOContext&) = delete;
+  ClientIOContext(ClientIOContext&&) = delete;
+  ClientIOContext& operator=(const ClientIOContext&) = delete;
+  ClientIOContext& operator=(ClientIOContext&&) = delete;
+  ~ClientIOContext();
+
+  /// @brief gets the process wide instance, starting its thread on first use
+  /// @return the shared io context
+  static ClientIOContext& instance();
+
+  /// @brief gets the io_context to run clients on
+  /// @return the shared io_context
+  std::shared_ptr<asio::io_context> ioContext() const;
+
+private:
+  ClientIOContext();
+
+  /// the io_context all outbound connections run on
+  std::shared_ptr<asio::io_context> ioContext_;
+  /// keeps the io_context running while no request is pending
+  asio::executor_work_guard<asio::io_context::executor_type> workGuard_;
+  /// thread running the io_context
+  std::thread thread_;
+};
+
+/// @brief ClientConnection holds a persistent connection to a single host and port. It is shared
+/// by all sessions to that server on the same io context. Requests are queued and sent one after
+/// another, so notifications arrive in order and the connection is kept alive in between. The
+/// queue is worked off on a strand, so the io context may be run by several threads.
+template <class SocketType>
+class ClientConnection : public std::enable_shared_from_this<ClientConnection<SocketType>>
+{
+public:
+  /// @brief gets the connection to the server of a given URL, creating it if none exists
+  /// @param url the address of the server
+  /// @param ioContext the io context to run the connection on
+  /// @return the shared connection
+  static std::shared_ptr<ClientConnection> get(const URL& url,
+                                               std::shared_ptr<asio::io_context> ioContext);
+
+  /// @brief constructs a connection. Use get() to share connections.
+  /// @param hostPort the server to connect to
+  /// @param ioContext the io context to run the connection on
+  ClientConnection(std::string hostPort, std::shared_ptr<asio::io_context> ioContext);
+
+  /// @brief queues a notification to be posted. Safe to be called from any thread.
+  /// @param path the path to post to
+  /// @param notification the notification to post
+  /// @param callback invoked on the strand once the request completed
+  void enqueue(std::string path, Notification notification,
+               ClientSessionInterface::SendCallback callback);
+
+private:
+  /// @brief PendingRequest holds a queued request
+  struct PendingRequest
+  {
+    /// the path to post to
+    std::string path;
+    /// the notification to post
+    Notification notification;
+    /// invoked once the request completed
+    ClientSessionInterface::SendCallback callback;
+    /// the time the request was queued
+    std::chrono::steady_clock::time_point queued;
+  };
+
+  /// host and port of the server, the key of its cached TLS session
+  const std::string hostPort_;
+  /// serializes the access to the queue
+  const asio::strand<asio::io_context::executor_type> strand_;
+  /// the client running on the shared io_context
+  SimpleWeb::Client<SocketType> client_;
+  /// queued requests, only accessed on the strand
+  std::deque<PendingRequest> queue_;
+  /// whether a request is in flight, only accessed on the strand
+  bool busy_{false};
+  /// reused buffer the notification fragments are gathered into
+  std::string buffer_;
+
+  /// @brief sends the next queued request if none is in flight. Runs on the strand.
+  void sendNext();
+};
+
+/// @brief ClientSessionSimple sends notifications to an http or https endpoint
+template <class SocketType>
 class ClientSessionSimple : public ClientSessionInterface
 {
 public:
-  explicit ClientSessionSimple(const std::string& address);
+  /// @brief constructs a client session sending to a given endpoint
+  /// @param url the parsed address of the endpoint
+  /// @param ioContext the io context to send on
+  ClientSessionSimple(URL url, std::shared_ptr<asio::io_context> ioContext);
+  ClientSessionSimple(const ClientSessionSimple&) = delete;
+  ClientSessionSimple(ClientSessionSimple&&) = delete;
+  ClientSessionSimple& operator=(const ClientSessionSimple&) = delete;
+  ClientSessionSimple& operator=(ClientSessionSimple&&) = delete;
+  /// @brief waits for running completion callbacks. Callbacks of requests still queued are not
+  /// invoked anymore.
+  ~ClientSessionSimple() override;
 
-  void send(const std::string& message) override;
+  /// @brief sends a notification and waits for its response. Must not be called on a thread running
+  /// the io context of the session.
+  bool send(const Notification& notification) override;
+  void sendAsync(const Notification& notification, SendCallback callback) override;
 
 private:
-  SimpleWeb::Client<SimpleWeb::HTTPS> client_;
+  /// @brief CallbackGuard prevents completions from calling back into a destroyed session owner
+  struct CallbackGuard
+  {
+    /// held while a callback runs
+    std::mutex mutex;
+    /// whether callbacks may still be invoked
+    bool alive{true};
+  };
+
+  /// the address notifications are sent to
+  const URL url_;
+  /// the connection to the server of the address
+  const std::shared_ptr<ClientConnection<SocketType>> connection_;
+  /// guard shared with the pending completions of this session
+  const std::shared_ptr<CallbackGuard> guard_;
 };
@@ -1,36 +1,63 @@
 #pragma once
 
 #include "Log.hpp"
+#include "WebServer/AdmissionControl.hpp"
 #include "WebServer/Request.hpp"
 #include "server_https.hpp"
+#include <thread>
 
+/// @brief RequestSimple is a request received by Simple-Web-Server. Responses from threads other
+/// than the server thread the request was received on are posted to the connection's executor.
 template <class SocketType>
 class RequestSimple : public Request
 {
 public:
-  explicit RequestSimple(std::shared_ptr<typename SimpleWeb::Server<SocketType>::Response> response,
-                         std::shared_ptr<typename SimpleWeb::Server<SocketType>::Request> request);
+  RequestSimple(std::shared_ptr<typename SimpleWeb::Server<SocketType>::Response> response,
+                std::shared_ptr<typename SimpleWeb::Server<SocketType>::Request> request,
+                AdmissionControl::Ticket ticket);
   RequestSimple(const RequestSimple&) = delete;
   RequestSimple(RequestSimple&&) = delete;
   RequestSimple& operator=(const RequestSimple&) = delete;
   RequestSimple& operator=(RequestSimple&&) = delete;
-  ~RequestSimple() override = default;
+  ~RequestSimple() override;
 
 private:
   void sendResponse(const std::string& msg) const override;
 
-  const std::shared_ptr<typename SimpleWeb::Server<SocketType>::Response> response_;
+  /// @brief returns whether the calling thread is the server thread that received this request
+  /// @return whether the response can be written directly
+  bool onServerThread() const;
+
+  /// the server thread the request was received on
+  const std::thread::id serverThread_{std::this_thread::get_id()};
+  /// the response, sent by the server when the last reference to it is released
+  std::shared_ptr<typename SimpleWeb::Server<SocketType>::Response> response_;
   const std::shared_ptr<const typename SimpleWeb::Server<SocketType>::Request> request_;
+  /// counts this request as in flight until it is destroyed
+  const AdmissionControl::Ticket ticket_;
 };
 
 template <class SocketType>
 RequestSimple<SocketType>::RequestSimple(
     std::shared_ptr<typename SimpleWeb::Server<SocketType>::Response> response,
-    std::shared_ptr<typename SimpleWeb::Server<SocketType>::Request> request)
-  : Request(request->content.string())
+    std::shared_ptr<typename SimpleWeb::Server<SocketType>::Request> request,
+    AdmissionControl::Ticket ticket)
+  : Request(request->content.c_str())
   , response_(std::move(response))
   , request_(std::move(request))
+  , ticket_(std::move(ticket))
+{
+}
+
+template <class SocketType>
+RequestSimple<SocketType>::~RequestSimple<SocketType>()
 {
+  // the response is sent once released, which has to happen on the connection's executor
+  if (!onServerThread())
+  {
+    auto* target = response_.get();
+    target->post([response = std::move(response_)]() {});
+  }
 }
 
 template <class SocketType>
@@ -38,5 +65,16 @@ void RequestSimple<SocketType>::sendResponse(const std::string& msg) const
 {
   LOG(LogLevel::DEBUG, "Writing: \n" << msg);
   // response_->close_connection_after_response = true;
-  response_->write(msg);
+  if (onServerThread())
+  {
+    response_->write(msg);
+    return;
+  }
+  response_->post([response = response_, msg]() { response->write(msg); });
+}
+
+template <class SocketType>
+bool RequestSimple<SocketType>::onServerThread() const
+{
+  return std::this_thread::get_id() == serverThread_;
 }
@@ -2,34 +2,112 @@
 #include "networking/NetworkConfig.hpp"
 
 std::unique_ptr<WebServerInterface>
-WebServerFactory::produce(const std::shared_ptr<const NetworkConfig>& networkConfig)
+WebServerFactory::produce(const std::shared_ptr<const NetworkConfig>& networkConfig,
+                          std::shared_ptr<asio::io_context> ioContext)
 {
   if (networkConfig->useTLS())
   {
-    return std::make_unique<WebServerSimple<SimpleWeb::HTTPS>>();
+    return std::make_unique<WebServerSimple<SimpleWeb::HTTPS>>(networkConfig,
+                                                                std::move(ioContext));
   }
-  return std::make_unique<WebServerSimple<SimpleWeb::HTTP>>();
+  return std::make_unique<WebServerSimple<SimpleWeb::HTTP>>(networkConfig, std::move(ioContext));
 }
 
+/// identifies the sessions of this server in the session cache
+static constexpr unsigned char SESSION_ID_CONTEXT[] = "MicroSDC";
+
 template <>
-WebServerSimple<SimpleWeb::HTTPS>::WebServerSimple()
-  : server_(std::make_unique<SimpleWeb::Server<SimpleWeb::HTTPS>>(
-        "./certs/server.crt", "./certs/server.key", "./certs/ca.crt"))
+std::shared_ptr<asio::ssl::context>
+WebServerSimple<SimpleWeb::HTTPS>::makeSSLContext(const NetworkConfig& networkConfig)
 {
-  server_->config.port = 8080;
-  server_->config.timeout_content = 0;
-  server_->config.timeout_request = 0;
-  server_->on_error = [](std::shared_ptr<SimpleWeb::Server<SimpleWeb::HTTPS>::Request> /*request*/,
+  auto context = std::make_shared<asio::ssl::context>(asio::ssl::context::tlsv12);
+  context->use_certificate_chain_file("./certs/server.crt");
+  context->use_private_key_file("./certs/server.key", asio::ssl::context::pem);
+  context->load_verify_file("./certs/ca.crt");
+  context->set_verify_mode(asio::ssl::verify_peer | asio::ssl::verify_fail_if_no_peer_cert |
+                           asio::ssl::verify_client_once);
+
+  auto* nativeContext = context->native_handle();
+  // resumption of sessions with verified client certificates requires a session id context
+  SSL_CTX_set_session_id_context(nativeContext, SESSION_ID_CONTEXT, sizeof(SESSION_ID_CONTEXT) - 1);
+  if (networkConfig.tlsSessionCacheSize() > 0)
+  {
+    SSL_CTX_set_session_cache_mode(nativeContext, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_sess_set_cache_size(nativeContext,
+                                static_cast<long>(networkConfig.tlsSessionCacheSize()));
+  }
+  else
+  {
+    SSL_CTX_set_session_cache_mode(nativeContext, SSL_SESS_CACHE_OFF);
+  }
+  SSL_CTX_set_timeout(nativeContext, static_cast<long>(networkConfig.tlsSessionLifetime().count()));
+  // Connections are closed without SSL_shutdown, which makes OpenSSL drop their sessions from the
+  // cache. A client closing with close_notify ended the session cleanly, so mark it as shut down.
+  SSL_CTX_set_info_callback(nativeContext, [](const SSL* ssl, int where, int ret) {
+    if ((where & SSL_CB_READ_ALERT) != 0 && (ret & 0xff) == SSL_AD_CLOSE_NOTIFY)
+    {
+      SSL_set_shutdown(const_cast<SSL*>(ssl), SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+    }
+  });
+  if (networkConfig.tlsSessionTickets())
+  {
+    SSL_CTX_clear_options(nativeContext, SSL_OP_NO_TICKET);
+  }
+  else
+  {
+    SSL_CTX_set_options(nativeContext, SSL_OP_NO_TICKET);
+  }
+  LOG(LogLevel::INFO, "TLS session cache size "
+                          << networkConfig.tlsSessionCacheSize() << ", lifetime "
+                          << networkConfig.tlsSessionLifetime().count() << "s, session tickets "
+                          << (networkConfig.tlsSessionTickets() ? "on" : "off"));
+  return context;
+}
+
+template <>
+std::shared_ptr<asio::ssl::context>
+WebServerSimple<SimpleWeb::HTTP>::makeSSLContext(const NetworkConfig& /*networkConfig*/)
+{
+  return nullptr;
+}
+
+template <>
+std::unique_ptr<SimpleWeb::Server<SimpleWeb::HTTPS>> WebServerSimple<SimpleWeb::HTTPS>::makeServer()
+{
+  auto server = std::make_unique<SimpleWeb::Server<SimpleWeb::HTTPS>>(sslContext_);
+  server->on_handshake = [this](SimpleWeb::HTTPS& socket) {
+    if (SSL_session_reused(socket.native_handle()) != 0)
+    {
+      ++resumedHandshakes_;
+    }
+    else
+    {
+      ++fullHandshakes_;
+    }
+  };
+  server->on_error = [this](
+                         std::shared_ptr<SimpleWeb::Server<SimpleWeb::HTTPS>::Request> /*request*/,
                          const SimpleWeb::error_code& ec) {
+    if (ec == SimpleWeb::errc::message_size)
+    {
+      admission_.rejectTooLarge();
+    }
     LOG(LogLevel::ERROR, "Error processing request: " << ec);
   };
+  return server;
 }
 
 template <>
-WebServerSimple<SimpleWeb::HTTP>::WebServerSimple()
-  : server_(std::make_unique<SimpleWeb::Server<SimpleWeb::HTTP>>())
+std::unique_ptr<SimpleWeb::Server<SimpleWeb::HTTP>> WebServerSimple<SimpleWeb::HTTP>::makeServer()
 {
-  server_->config.port = 8080;
-  // server_->config.timeout_content = 10;
-  // server_->config.timeout_request = 10;
+  auto server = std::make_unique<SimpleWeb::Server<SimpleWeb::HTTP>>();
+  server->on_error = [this](
+                         std::shared_ptr<SimpleWeb::Server<SimpleWeb::HTTP>::Request> /*request*/,
+                         const SimpleWeb::error_code& ec) {
+    if (ec == SimpleWeb::errc::message_size)
+    {
+      admission_.rejectTooLarge();
+    }
+  };
+  return server;
 }
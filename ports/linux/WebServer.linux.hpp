@@ -2,10 +2,18 @@
 
 #include "Log.hpp"
 #include "Request.linux.hpp"
+#include "WebServer/AdmissionControl.hpp"
+#include "WebServer/Router.hpp"
 #include "WebServer/WebServer.hpp"
+#include "networking/NetworkConfig.hpp"
 #include "rapidxml.hpp"
 #include "server_https.hpp"
 #include "services/ServiceInterface.hpp"
+#include <asio/ssl.hpp>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
 
 class ServiceInterface;
 
@@ -13,36 +21,151 @@ template <class SocketType>
 class WebServerSimple : public WebServerInterface
 {
 public:
-  explicit WebServerSimple();
+  /// @brief constructs the server(s) listening on the configured port. With SO_REUSEPORT enabled
+  /// one single threaded server is created per configured thread, otherwise a single server runs
+  /// a pool of the configured number of threads. The connection limit is divided among the
+  /// servers, as the kernel distributes the connections evenly between them. On a shared io
+  /// context a single server runs on the threads of that context instead.
+  /// @param networkConfig the network configuration of MicroSDC
+  /// @param ioContext the io context to serve on, shared with other components, if any
+  WebServerSimple(const std::shared_ptr<const NetworkConfig>& networkConfig,
+                  std::shared_ptr<asio::io_context> ioContext);
   ~WebServerSimple() override;
   void start() override;
   void stop() override;
 
   void addService(std::shared_ptr<ServiceInterface> service) override;
+  WebServerStatistics statistics() const override;
 
 private:
-  std::unique_ptr<SimpleWeb::Server<SocketType>> server_;
-  std::thread serverThread_{};
+  /// TLS context shared by all servers, so every acceptor resumes sessions of the others. Only
+  /// present for HTTPS.
+  std::shared_ptr<asio::ssl::context> sslContext_;
+  /// number of TLS handshakes negotiating a new session
+  std::atomic<std::size_t> fullHandshakes_{0};
+  /// number of TLS handshakes resuming a session
+  std::atomic<std::size_t> resumedHandshakes_{0};
+  /// servers accepting connections on the same port
+  std::vector<std::unique_ptr<SimpleWeb::Server<SocketType>>> servers_;
+  /// the io context the servers run on if it is shared with other components
+  const std::shared_ptr<asio::io_context> ioContext_;
+  /// threads running the servers, empty on a shared io context
+  std::vector<std::thread> serverThreads_;
+  /// whether the servers are started
+  bool started_{false};
+  /// router dispatching requests to the registered services
+  Router router_;
+  /// decides which requests are handled before parsing them
+  AdmissionControl admission_;
+
+  /// the space of the request buffer reserved for the request line and header fields
+  static constexpr std::size_t MAX_HEADER_SIZE = 8192;
+
+  /// @brief dispatches a request to the service registered at its path if it is admitted
+  /// @param response the response of the request
+  /// @param request the request to dispatch
+  void dispatch(std::shared_ptr<typename SimpleWeb::Server<SocketType>::Response> response,
+                std::shared_ptr<typename SimpleWeb::Server<SocketType>::Request> request);
+
+  /// @brief creates the TLS context shared by all servers of this socket type
+  /// @param networkConfig the network configuration holding the TLS session settings
+  /// @return the configured context or nullptr if this socket type does not use TLS
+  static std::shared_ptr<asio::ssl::context> makeSSLContext(const NetworkConfig& networkConfig);
+
+  /// @brief constructs a single server of this socket type
+  /// @return the constructed server
+  std::unique_ptr<SimpleWeb::Server<SocketType>> makeServer();
 };
 
+template <class SocketType>
+WebServerSimple<SocketType>::WebServerSimple(
+    const std::shared_ptr<const NetworkConfig>& networkConfig,
+    std::shared_ptr<asio::io_context> ioContext)
+  : sslContext_(makeSSLContext(*networkConfig))
+  , ioContext_(std::move(ioContext))
+  , admission_(*networkConfig)
+{
+  // acceptors sharing the port only spread the connections across threads of their own
+  const auto serverCount =
+      networkConfig->reusePort() && ioContext_ == nullptr ? networkConfig->threadCount() : 1;
+  for (std::size_t i = 0; i < serverCount; ++i)
+  {
+    auto server = makeServer();
+    // a server given an io context only serves on it instead of running it
+    server->io_service = ioContext_;
+    server->config.port = networkConfig->port();
+    server->config.thread_pool_size =
+        networkConfig->reusePort() ? 1 : networkConfig->threadCount();
+    server->config.reuse_port = networkConfig->reusePort();
+    server->config.timeout_idle = networkConfig->idleTimeout().count();
+    server->config.timeout_request = networkConfig->headerTimeout().count();
+    server->config.timeout_content = networkConfig->bodyTimeout().count();
+    server->config.max_connections =
+        (networkConfig->maxConnections() + serverCount - 1) / serverCount;
+    // bodies announced beyond the buffer are rejected with 413 before they are read
+    server->config.max_request_streambuf_size = admission_.maxRequestSize() + MAX_HEADER_SIZE;
+    // every request is dispatched by the router instead of matching regex resources
+    const auto handler =
+        [this](std::shared_ptr<typename SimpleWeb::Server<SocketType>::Response> response,
+               std::shared_ptr<typename SimpleWeb::Server<SocketType>::Request> request) {
+          dispatch(std::move(response), std::move(request));
+        };
+    server->default_resource["GET"] = handler;
+    server->default_resource["POST"] = handler;
+    servers_.emplace_back(std::move(server));
+  }
+}
+
 template <class SocketType>
 void WebServerSimple<SocketType>::start()
 {
-  // Start server and receive assigned port when server is listening for requests
-  std::promise<std::uint16_t> serverPort;
-  serverThread_ = std::thread([this, &serverPort]() {
-    // Start server
-    server_->start([this, &serverPort](unsigned short port) { serverPort.set_value(port); });
-  });
-  LOG(LogLevel::INFO, "Server listening on port " << serverPort.get_future().get());
+  started_ = true;
+  if (ioContext_ != nullptr)
+  {
+    servers_.front()->start();
+    LOG(LogLevel::INFO, "Server listening on port " << servers_.front()->config.port
+                                                    << " on the shared io context");
+    return;
+  }
+  std::uint16_t port = 0;
+  for (auto& server : servers_)
+  {
+    // all acceptors share the port assigned to the first one
+    if (port != 0)
+    {
+      server->config.port = port;
+    }
+    // Start server and receive assigned port when server is listening for requests
+    std::promise<std::uint16_t> serverPort;
+    serverThreads_.emplace_back([&server, &serverPort]() {
+      server->start([&serverPort](unsigned short port) { serverPort.set_value(port); });
+    });
+    port = serverPort.get_future().get();
+  }
+  LOG(LogLevel::INFO, "Server listening on port " << port << " with " << servers_.size()
+                                                  << " acceptor(s) and "
+                                                  << servers_.front()->config.thread_pool_size
+                                                  << " thread(s) each");
 }
 
 template <class SocketType>
 void WebServerSimple<SocketType>::stop()
 {
-  server_->stop();
+  if (!started_)
+  {
+    return;
+  }
+  started_ = false;
+  for (auto& server : servers_)
+  {
+    server->stop();
+  }
   LOG(LogLevel::INFO, "Server stopping...");
-  serverThread_.join();
+  for (auto& thread : serverThreads_)
+  {
+    thread.join();
+  }
+  serverThreads_.clear();
 }
 
 template <class SocketType>
@@ -54,26 +177,71 @@ WebServerSimple<SocketType>::~WebServerSimple<SocketType>()
 template <class SocketType>
 void WebServerSimple<SocketType>::addService(std::shared_ptr<ServiceInterface> service)
 {
-  const auto handler =
-      [service](std::shared_ptr<typename SimpleWeb::Server<SocketType>::Response> response,
-                std::shared_ptr<typename SimpleWeb::Server<SocketType>::Request> request) {
-        try
-        {
-          service->handleRequest(std::make_unique<RequestSimple<SocketType>>(response, request));
-        }
-        catch (rapidxml::parse_error& e)
-        {
-          LOG(LogLevel::ERROR, "Rapidxml Parse error: " << e.what());
-        }
-        catch (std::exception& e)
-        {
-          LOG(LogLevel::ERROR, "Error handling Request: std::exception: " << e.what());
-        }
-        catch (...)
-        {
-          LOG(LogLevel::ERROR, "Error while handling request!");
-        }
-      };
-  server_->resource["^" + service->getURI() + "$"]["GET"] = handler;
-  server_->resource["^" + service->getURI() + "$"]["POST"] = handler;
+  router_.addService(std::move(service));
+}
+
+template <class SocketType>
+WebServerStatistics WebServerSimple<SocketType>::statistics() const
+{
+  WebServerStatistics statistics;
+  statistics.fullHandshakes = fullHandshakes_.load();
+  statistics.resumedHandshakes = resumedHandshakes_.load();
+  statistics.rejectedRequests = admission_.statistics();
+  for (const auto& server : servers_)
+  {
+    const auto connections = server->connection_statistics();
+    statistics.openConnections += connections.open;
+    statistics.idleConnections += connections.idle;
+    statistics.evictedConnections += connections.evicted;
+    statistics.rejectedConnections += connections.rejected;
+  }
+  return statistics;
+}
+
+template <class SocketType>
+void WebServerSimple<SocketType>::dispatch(
+    std::shared_ptr<typename SimpleWeb::Server<SocketType>::Response> response,
+    std::shared_ptr<typename SimpleWeb::Server<SocketType>::Request> request)
+{
+  AdmissionControl::Ticket ticket;
+  switch (admission_.admit(request->remote_endpoint().address().to_string(),
+                           request->content.size(), ticket))
+  {
+    case AdmissionControl::Decision::ADMITTED:
+      break;
+    case AdmissionControl::Decision::PAYLOAD_TOO_LARGE:
+      response->write(SimpleWeb::StatusCode::client_error_payload_too_large);
+      return;
+    case AdmissionControl::Decision::TOO_MANY_REQUESTS:
+      response->write(SimpleWeb::StatusCode::client_error_too_many_requests,
+                      {{"Retry-After", "1"}});
+      return;
+    case AdmissionControl::Decision::OVERLOADED:
+      response->write(SimpleWeb::StatusCode::server_error_service_unavailable,
+                      {{"Retry-After", "1"}});
+      return;
+  }
+  const auto service = router_.route(request->path);
+  if (service == nullptr)
+  {
+    response->write(SimpleWeb::StatusCode::client_error_not_found);
+    return;
+  }
+  try
+  {
+    service->handleRequest(
+        std::make_unique<RequestSimple<SocketType>>(response, request, std::move(ticket)));
+  }
+  catch (rapidxml::parse_error& e)
+  {
+    LOG(LogLevel::ERROR, "Rapidxml Parse error: " << e.what());
+  }
+  catch (std::exception& e)
+  {
+    LOG(LogLevel::ERROR, "Error handling Request: std::exception: " << e.what());
+  }
+  catch (...)
+  {
+    LOG(LogLevel::ERROR, "Error while handling request!");
+  }
 }
@@ -0,0 +1,51 @@
+#include "ExecutionContext.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+static constexpr const char* TAG = "ExecutionContext";
+
+ExecutionContext::ExecutionContext(std::size_t threadCount)
+  : ioContext_(std::make_shared<asio::io_context>())
+  , workGuard_(asio::make_work_guard(*ioContext_))
+{
+  threadCount = std::max<std::size_t>(threadCount, 1);
+  for (std::size_t i = 0; i < threadCount; ++i)
+  {
+    threads_.emplace_back([this]() { ioContext_->run(); });
+  }
+  LOG(LogLevel::INFO, "Running all activity on " << threadCount << " thread(s)");
+}
+
+ExecutionContext::ExecutionContext(std::shared_ptr<asio::io_context> ioContext)
+  : ioContext_(std::move(ioContext))
+{
+  if (ioContext_ == nullptr)
+  {
+    throw std::runtime_error("ExecutionContext needs an io context!");
+  }
+}
+
+ExecutionContext::~ExecutionContext()
+{
+  if (threads_.empty())
+  {
+    return;
+  }
+  workGuard_.reset();
+  ioContext_->stop();
+  for (auto& thread : threads_)
+  {
+    thread.join();
+  }
+}
+
+std::shared_ptr<asio::io_context> ExecutionContext::ioContext() const
+{
+  return ioContext_;
+}
+
+std::size_t ExecutionContext::threadCount() const
+{
+  return threads_.size();
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <asio.hpp>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+/// @brief ExecutionContext is a single io context driving the discovery, the web server, the
+/// timers and the notification delivery of MicroSDC instances. It is run either by a pool of
+/// threads owned by this context or by threads of the application. Components relying on the
+/// order of their handlers run them on a strand, so any number of threads may run the io context.
+class ExecutionContext
+{
+public:
+  /// @brief constructs a context run by threads of its own
+  /// @param threadCount the number of threads running the io context, at least one
+  explicit ExecutionContext(std::size_t threadCount = 1);
+
+  /// @brief constructs a context on an io context run by the application. It has to be run as long
+  /// as a component using this context is started, including while the component stops.
+  /// @param ioContext the io context of the application
+  explicit ExecutionContext(std::shared_ptr<asio::io_context> ioContext);
+  ExecutionContext(const ExecutionContext&) = delete;
+  ExecutionContext(ExecutionContext&&) = delete;
+  ExecutionContext& operator=(const ExecutionContext&) = delete;
+  ExecutionContext& operator=(ExecutionContext&&) = delete;
+  /// @brief stops and joins the owned threads. Must not be called on one of them.
+  ~ExecutionContext();
+
+  /// @brief gets the io context to create sockets, timers and strands with
+  /// @return the shared io context
+  std::shared_ptr<asio::io_context> ioContext() const;
+
+  /// @brief gets the number of threads owned by this context
+  /// @return the number of owned threads, zero if the application runs the io context
+  std::size_t threadCount() const;
+
+private:
+  /// the io context all components of this context run on
+  const std::shared_ptr<asio::io_context> ioContext_;
+  /// keeps the owned threads running while no handler is pending
+  std::optional<asio::executor_work_guard<asio::io_context::executor_type>> workGuard_;
+  /// the threads running the io context, empty if the application runs it
+  std::vector<std::thread> threads_;
+};
@@ -4,30 +4,34 @@
 #include "networking/NetworkConfig.hpp"
 
 MetadataProvider::MetadataProvider(std::shared_ptr<const NetworkConfig> networkConfig,
-                                   DeviceCharacteristics devChar)
+                                   DeviceCharacteristics devChar,
+                                   std::optional<std::string> streamAddress,
+                                   std::string basePath)
   : networkConfig_(std::move(networkConfig))
   , deviceCharacteristics_(std::move(devChar))
+  , streamAddress_(std::move(streamAddress))
+  , basePath_(std::move(basePath))
 {
 }
 
-std::string MetadataProvider::getDeviceServicePath()
+std::string MetadataProvider::getDeviceServicePath() const
 {
-  return std::string("/MicroSDC");
+  return basePath_;
 }
 
-std::string MetadataProvider::getGetServicePath()
+std::string MetadataProvider::getGetServicePath() const
 {
-  return std::string("/MicroSDC/GetService");
+  return basePath_ + "/GetService";
 }
 
-std::string MetadataProvider::getSetServicePath()
+std::string MetadataProvider::getSetServicePath() const
 {
-  return std::string("/MicroSDC/SetService");
+  return basePath_ + "/SetService";
 }
 
-std::string MetadataProvider::getStateEventServicePath()
+std::string MetadataProvider::getStateEventServicePath() const
 {
-  return std::string("/MicroSDC/StateEventService");
+  return basePath_ + "/StateEventService";
 }
 
 WS::ADDRESSING::URIType MetadataProvider::getSetServiceURI() const
@@ -78,6 +82,10 @@ void MetadataProvider::fillStateEventServiceMetadata(MESSAGEMODEL::Envelope& env
 {
   auto& metadata = envelope.Body.Metadata = WS::MEX::Metadata();
   metadata->MetadataSection.emplace_back(createMetadataSectionWSDLStateEventService());
+  if (streamAddress_.has_value())
+  {
+    metadata->MetadataSection.emplace_back(createMetadataSectionStreamDescriptions());
+  }
   metadata->MetadataSection.emplace_back(
       createMetadataSectionRelationship(createHostMetadata(), {createHostedStateEventService()}));
 }
@@ -129,7 +137,7 @@ MetadataProvider::Hosted MetadataProvider::createHostedGetService() const
   endpointReference.emplace_back(Hosted::EndpointReferenceType::AddressType(xaddress));
   // Types
   Hosted::TypesType types;
-  types.emplace_back(SDC::NS_GLUE_PREFIX, SDC::QNAME_GETSERVICE);
+  types.emplace_back(SDC::NS_GLUE, SDC::QNAME_GETSERVICE);
   // Service Id
   Hosted::ServiceIdType serviceId("GetService");
   return Hosted(endpointReference, types, serviceId);
@@ -153,7 +161,7 @@ MetadataProvider::Hosted MetadataProvider::createHostedSetService() const
   endpointReference.emplace_back(Hosted::EndpointReferenceType::AddressType(getSetServiceURI()));
   // Types
   Hosted::TypesType types;
-  types.emplace_back(SDC::NS_GLUE_PREFIX, SDC::QNAME_SETSERVICE);
+  types.emplace_back(SDC::NS_GLUE, SDC::QNAME_SETSERVICE);
   // Service Id
   Hosted::ServiceIdType serviceId("SetService");
   return Hosted(endpointReference, types, serviceId);
@@ -178,7 +186,7 @@ MetadataProvider::Hosted MetadataProvider::createHostedStateEventService() const
       Hosted::EndpointReferenceType::AddressType(getStateEventServiceURI()));
   // Types
   Hosted::TypesType types;
-  types.emplace_back(SDC::NS_GLUE_PREFIX, SDC::QNAME_STATEEVENTSERVICE);
+  types.emplace_back(SDC::NS_GLUE, SDC::QNAME_STATEEVENTSERVICE);
   // Service Id
   Hosted::ServiceIdType serviceId("StateEventService");
   return Hosted(endpointReference, types, serviceId);
@@ -195,3 +203,19 @@ MetadataProvider::createMetadataSectionWSDLStateEventService() const
       std::to_string(networkConfig_->port()) + getStateEventServicePath() + "/wsdl");
   return wsdlSection;
 }
+
+MetadataProvider::MetadataSection MetadataProvider::createMetadataSectionStreamDescriptions() const
+{
+  MetadataSection streamSection =
+      MetadataSection(WS::ADDRESSING::URIType(MDPWS::WS_MEX_DIALECT_STREAM));
+  auto& streamDescriptions = streamSection.StreamDescriptions =
+      MDPWS::StreamDescriptionsType(WS::ADDRESSING::URIType(SDC::NS_GLUE));
+  MDPWS::StreamTypeType streamType(SDC::STREAM_ID_WAVEFORM,
+                                   WS::ADDRESSING::URIType(SDC::STREAM_TYPE_WAVEFORM),
+                                   WS::ADDRESSING::URIType(SDC::ACTION_WAVEFORM_STREAM),
+                                   SDC::QNAME_WAVEFORM_STREAM);
+  streamType.StreamTransmission.StreamAddress =
+      MDPWS::StreamTransmissionType::StreamAddressType(streamAddress_.value());
+  streamDescriptions->StreamType.emplace_back(std::move(streamType));
+  return streamSection;
+}
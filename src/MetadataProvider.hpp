@@ -18,24 +18,32 @@ public:
   /// @brief constructs a MetadataProvider object from given Device Characteristics
   /// @param networkConfig the network configuration of MicroSDC
   /// @param devChar Device Characteristics to provide with this MetadataProvider
+  /// @param streamAddress the address waveforms are streamed to if this device streams waveforms
+  /// @param basePath the path the services of this device are served below, distinguishing the
+  /// devices sharing a web server
   MetadataProvider(std::shared_ptr<const NetworkConfig> networkConfig,
-                   DeviceCharacteristics devChar);
+                   DeviceCharacteristics devChar,
+                   std::optional<std::string> streamAddress = std::nullopt,
+                   std::string basePath = DEFAULT_BASE_PATH);
+
+  /// the base path of the services of a device not sharing its web server
+  static constexpr const char* DEFAULT_BASE_PATH = "/MicroSDC";
 
   /// @brief get the URI of the Device Service
   /// @return string containing the URI
-  static std::string getDeviceServicePath();
+  std::string getDeviceServicePath() const;
 
   /// @brief get the URI of the GetService
   /// @return string containing the URI
-  static std::string getGetServicePath();
+  std::string getGetServicePath() const;
 
   /// @brief get the URI of the SetService
   /// @return string containing the URI
-  static std::string getSetServicePath();
+  std::string getSetServicePath() const;
 
   /// @brief get the URI of the StateEventService
   /// @return string containing the URI
-  static std::string getStateEventServicePath();
+  std::string getStateEventServicePath() const;
 
   /// @brief gets the endpoint URI of the SetService
   /// @return URI containing information regarding the set service
@@ -92,6 +100,10 @@ public:
   /// @return constructed MetadataSection
   MetadataSection createMetadataSectionWSDLStateEventService() const;
 
+  /// @brief compile the MDPWS stream descriptions of the waveform stream
+  /// @return constructed MetadataSection
+  MetadataSection createMetadataSectionStreamDescriptions() const;
+
   /// @brief construct Hosted section for GetService
   /// @brief Hosted element
   Hosted createHostedGetService() const;
@@ -109,4 +121,8 @@ private:
   const std::shared_ptr<const NetworkConfig> networkConfig_;
   /// device characteristics to provide
   const DeviceCharacteristics deviceCharacteristics_;
+  /// address of the waveform stream, if any
+  const std::optional<std::string> streamAddress_;
+  /// the path the services of this device are served below
+  const std::string basePath_;
 };
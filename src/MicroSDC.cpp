@@ -19,6 +19,8 @@
 #include "wsdl/StateEventServiceWSDL.hpp"
 
 #include "asio/system_error.hpp"
+#include <algorithm>
+#include <optional>
 
 MicroSDC::MicroSDC()
   : mdib_(std::make_unique<BICEPS::PM::Mdib>(WS::ADDRESSING::URIType("0")))
@@ -35,84 +37,207 @@ void MicroSDC::start()
   }
 
   std::lock_guard<std::mutex> lock(runningMutex_);
+  if (hosted_)
+  {
+    LOG(LogLevel::ERROR, "called MicroSDC start but it is started by its MicroSDCHost!");
+    return;
+  }
   if (running_)
   {
     LOG(LogLevel::WARNING, "called MicroSDC start but already running!");
     return;
   }
-  webserver_ = WebServerFactory::produce(networkConfig_);
+  // MicroSDC is ready and running once startup() activated it
   startup();
-  // MicroSDC is now ready und is running
-  running_ = true;
 }
 
 void MicroSDC::startup()
 {
   LOG(LogLevel::INFO, "Initialize...");
+  const auto ioContext =
+      executionContext_ != nullptr ? executionContext_->ioContext() : nullptr;
+  webserver_ = WebServerFactory::produce(networkConfig_, ioContext);
+  prepare(MetadataProvider::DEFAULT_BASE_PATH, ioContext);
+
+  const auto interfaces = discoveryAddresses(*networkConfig_);
+  discoveryService_ = std::make_shared<DiscoveryService>(
+      interfaces, std::vector<DiscoveryService::Target>{discoveryTarget(interfaces)}, ioContext);
+
+  // expensive actions are deferred from the web server threads to the workers
+  SoapService::Executor workerExecutor;
+  if (workerThreadCount_ > 0)
+  {
+    workers_ = std::make_unique<asio::thread_pool>(workerThreadCount_);
+    workerExecutor = [workers = workers_.get()](std::function<void()> task) {
+      asio::post(*workers, std::move(task));
+    };
+  }
+  attach(*webserver_, discoveryService_, 0, nullptr, std::move(workerExecutor), ioContext);
 
-  const auto metadata =
-      std::make_shared<const MetadataProvider>(networkConfig_, deviceCharacteristics_);
+  webserver_->start();
+  discoveryService_->start();
+  activate();
+}
 
-  // construct xAddresses containing reference to the service
-  WS::DISCOVERY::UriListType xAddresses;
-  std::string protocol = networkConfig_->useTLS() ? "https" : "http";
-  std::string xaddress = protocol + "://" + networkConfig_->ipAddress() + ":" +
-                         std::to_string(networkConfig_->port()) +
-                         MetadataProvider::getDeviceServicePath();
-  xAddresses.emplace_back(xaddress);
+void MicroSDC::prepare(std::string basePath, const std::shared_ptr<asio::io_context>& ioContext)
+{
+  // waveforms are streamed via udp multicast instead of being reported to each subscriber
+  const bool providesWaveforms =
+      std::any_of(stateHandlers_.begin(), stateHandlers_.end(), [](const auto& handler) {
+        return isa<RealTimeSampleArrayStateHandler>(handler);
+      });
+  std::optional<std::string> streamAddress;
+  if (providesWaveforms)
+  {
+    streamingService_ = std::make_unique<StreamingService>(
+        networkConfig_->streamingAddress(), networkConfig_->streamingPort(), ioContext);
+    streamAddress = streamingService_->getStreamAddress();
+  }
 
-  // fill discovery types
-  WS::DISCOVERY::QNameListType types;
-  types.emplace_back(MDPWS::WS_NS_DPWS_PREFIX, "Device");
-  types.emplace_back(MDPWS::NS_MDPWS_PREFIX, "MedicalDevice");
+  metadata_ = std::make_shared<const MetadataProvider>(
+      networkConfig_, deviceCharacteristics_, std::move(streamAddress), std::move(basePath));
 
   initializeMdStates();
+}
 
-  discoveryService_ = std::make_unique<DiscoveryService>(
-      WS::ADDRESSING::EndpointReferenceType::AddressType(endpointReference_), types, xAddresses);
+std::vector<asio::ip::address> MicroSDC::discoveryAddresses(const NetworkConfig& networkConfig)
+{
+  std::vector<asio::ip::address> addresses;
+  for (const auto& interfaceAddress : networkConfig.discoveryInterfaces())
+  {
+    addresses.emplace_back(asio::ip::make_address(interfaceAddress));
+  }
+  if (addresses.empty())
+  {
+    addresses.emplace_back(asio::ip::address_v4::any());
+  }
+  return addresses;
+}
+
+DiscoveryService::Target
+MicroSDC::discoveryTarget(const std::vector<asio::ip::address>& interfaces) const
+{
+  DiscoveryService::Target target;
+  target.endpointReference =
+      WS::ADDRESSING::EndpointReferenceType::AddressType(getEndpointReference());
+  // fill discovery types
+  target.types.emplace_back(MDPWS::WS_NS_DPWS, "Device");
+  target.types.emplace_back(MDPWS::NS_MDPWS, "MedicalDevice");
+
+  // construct xAddresses containing reference to the service on each discovery interface
+  const std::string protocol = networkConfig_->useTLS() ? "https" : "http";
+  for (const auto& address : interfaces)
+  {
+    std::string host;
+    if (address.is_unspecified())
+    {
+      host = networkConfig_->ipAddress();
+    }
+    else if (address.is_v4())
+    {
+      host = address.to_string();
+    }
+    else
+    {
+      // the scope of a link local address only identifies the interface on this device
+      auto address6 = address.to_v6();
+      address6.scope_id(0);
+      host = "[" + address6.to_string() + "]";
+    }
+    auto& xAddresses = target.xAddresses.emplace_back();
+    xAddresses.emplace_back(protocol + "://" + host + ":" + std::to_string(networkConfig_->port()) +
+                            metadata_->getDeviceServicePath());
+  }
+  return target;
+}
+
+void MicroSDC::attach(WebServerInterface& webserver,
+                      std::shared_ptr<DiscoveryService> discoveryService,
+                      DiscoveryService::TargetId discoveryTarget,
+                      std::shared_ptr<SessionManager> sessionManager,
+                      SoapService::Executor workerExecutor,
+                      const std::shared_ptr<asio::io_context>& ioContext)
+{
+  discoveryService_ = std::move(discoveryService);
+  discoveryTarget_ = discoveryTarget;
   if (locationContextState_ != nullptr && locationContextState_->LocationDetail.has_value())
   {
-    discoveryService_->setLocation(locationContextState_->LocationDetail.value());
+    discoveryService_->setLocation(discoveryTarget_,
+                                   locationContextState_->LocationDetail.value());
   }
 
   // construct subscription manager
-  subscriptionManager_ = std::make_shared<SubscriptionManager>();
+  subscriptionManager_ = std::make_shared<SubscriptionManager>(
+      notificationBatchingWindow_, std::move(sessionManager), ioContext,
+      notificationBatchingPolicy_);
 
   // construct web services
-  auto deviceService = std::make_shared<DeviceService>(metadata);
-  auto getService = std::make_shared<GetService>(*this, metadata);
+  auto deviceService =
+      std::make_shared<DeviceService>(metadata_, *discoveryService_, discoveryTarget_);
+  auto getService = std::make_shared<GetService>(*this, metadata_);
   auto getWSDLService =
       std::make_shared<StaticService>(getService->getURI() + "/wsdl", WSDL::GET_SERVICE_WSDL);
-  auto setService = std::make_shared<SetService>(*this, metadata, subscriptionManager_);
+  auto setService = std::make_shared<SetService>(*this, metadata_, subscriptionManager_);
   auto setWSDLService =
       std::make_shared<StaticService>(setService->getURI() + "/wsdl", WSDL::SET_SERVICE_WSDL);
   auto stateEventService =
-      std::make_shared<StateEventService>(*this, metadata, subscriptionManager_);
+      std::make_shared<StateEventService>(*this, metadata_, subscriptionManager_);
   auto stateEventWSDLService = std::make_shared<StaticService>(
       stateEventService->getURI() + "/wsdl", WSDL::STATE_EVENT_SERVICE_SERVICE_WSDL);
 
+  if (workerExecutor)
+  {
+    getService->setWorkerExecutor(workerExecutor);
+    setService->setWorkerExecutor(workerExecutor);
+  }
+
   // register webservices
-  webserver_->addService(deviceService);
-  webserver_->addService(getService);
-  webserver_->addService(getWSDLService);
-  webserver_->addService(setService);
-  webserver_->addService(setWSDLService);
-  webserver_->addService(stateEventService);
-  webserver_->addService(stateEventWSDLService);
+  webserver.addService(deviceService);
+  webserver.addService(getService);
+  webserver.addService(getWSDLService);
+  webserver.addService(setService);
+  webserver.addService(setWSDLService);
+  webserver.addService(stateEventService);
+  webserver.addService(stateEventWSDLService);
+}
 
-  webserver_->start();
-  discoveryService_->start();
+void MicroSDC::activate()
+{
+  if (streamingService_ != nullptr)
+  {
+    streamingService_->start();
+  }
+  running_ = true;
+}
+
+void MicroSDC::deactivate()
+{
+  if (streamingService_ != nullptr)
+  {
+    streamingService_->stop();
+  }
+  running_ = false;
 }
 
 void MicroSDC::stop()
 {
   std::lock_guard<std::mutex> lock(runningMutex_);
+  if (hosted_)
+  {
+    LOG(LogLevel::ERROR, "called MicroSDC stop but it is stopped by its MicroSDCHost!");
+    return;
+  }
   if (running_)
   {
     discoveryService_->stop();
+    deactivate();
     webserver_->stop();
-    sdcThread_.join();
-    running_ = false;
+    if (workers_ != nullptr)
+    {
+      // finish the deferred requests still referring to the services
+      workers_->join();
+      workers_.reset();
+    }
     LOG(LogLevel::INFO, "stopped");
   }
 }
@@ -123,6 +248,26 @@ bool MicroSDC::isRunning() const
   return running_;
 }
 
+WebServerStatistics MicroSDC::getWebServerStatistics() const
+{
+  std::lock_guard<std::mutex> lock(runningMutex_);
+  if (webserver_ == nullptr)
+  {
+    return WebServerStatistics();
+  }
+  return webserver_->statistics();
+}
+
+DiscoveryStatistics MicroSDC::getDiscoveryStatistics() const
+{
+  std::lock_guard<std::mutex> lock(runningMutex_);
+  if (discoveryService_ == nullptr)
+  {
+    return DiscoveryStatistics();
+  }
+  return discoveryService_->statistics();
+}
+
 void MicroSDC::initializeMdStates()
 {
   for (const auto& handler : stateHandlers_)
@@ -133,6 +278,12 @@ void MicroSDC::initializeMdStates()
       std::lock_guard<std::mutex> lock(mdibMutex_);
       mdib_->MdState->State.emplace_back(numericHandler->getInitialState());
     }
+    else if (const auto sampleArrayHandler = dyn_cast<RealTimeSampleArrayStateHandler>(handler);
+             sampleArrayHandler != nullptr)
+    {
+      std::lock_guard<std::mutex> lock(mdibMutex_);
+      mdib_->MdState->State.emplace_back(sampleArrayHandler->getInitialState());
+    }
   }
 }
 
@@ -141,35 +292,45 @@ void MicroSDC::setLocation(const std::string& descriptorHandle,
 {
   auto mdibVersion = getMdibVersion();
   std::lock_guard<std::mutex> lock(mdibMutex_);
-  if (locationContextState_ == nullptr)
-  {
-    locationContextState_ =
-        std::make_shared<BICEPS::PM::LocationContextState>(descriptorHandle, descriptorHandle);
-    mdib_->MdState->State.emplace_back(locationContextState_);
-  }
-  locationContextState_->LocationDetail = locationDetail;
+  // states are never modified in place as mdib snapshots may be serialized concurrently
+  auto state = locationContextState_ == nullptr
+                   ? std::make_shared<BICEPS::PM::LocationContextState>(descriptorHandle,
+                                                                        descriptorHandle)
+                   : std::make_shared<BICEPS::PM::LocationContextState>(*locationContextState_);
+  state->LocationDetail = locationDetail;
 
   BICEPS::PM::InstanceIdentifier identification;
   identification.Root = WS::ADDRESSING::URIType("sdc.ctxt.loc.detail");
   identification.Extension = locationDetail.Facility.value() + "///" + locationDetail.PoC.value() +
                              "//" + locationDetail.Bed.value();
-  locationContextState_->Identification.emplace_back(identification);
+  state->Identification.emplace_back(identification);
 
   BICEPS::PM::InstanceIdentifier validator;
   identification.Root = WS::ADDRESSING::URIType("Validator");
   identification.Extension = "System";
-  locationContextState_->Validator.emplace_back(validator);
+  state->Validator.emplace_back(validator);
 
-  locationContextState_->ContextAssociation = BICEPS::PM::ContextAssociation::Assoc;
-  locationContextState_->BindingMdibVersion = mdibVersion;
+  state->ContextAssociation = BICEPS::PM::ContextAssociation::Assoc;
+  state->BindingMdibVersion = mdibVersion;
+
+  auto& states = mdib_->MdState->State;
+  if (auto it = std::find(states.begin(), states.end(), locationContextState_); it != states.end())
+  {
+    *it = state;
+  }
+  else
+  {
+    states.emplace_back(state);
+  }
+  locationContextState_ = std::move(state);
 
   if (discoveryService_ != nullptr && locationContextState_->LocationDetail.has_value())
   {
-    discoveryService_->setLocation(locationContextState_->LocationDetail.value());
+    discoveryService_->setLocation(discoveryTarget_, locationContextState_->LocationDetail.value());
   }
 }
 
-const BICEPS::PM::Mdib& MicroSDC::getMdib() const
+BICEPS::PM::Mdib MicroSDC::getMdib() const
 {
   std::lock_guard<std::mutex> lock(mdibMutex_);
   return *mdib_;
@@ -220,6 +381,46 @@ void MicroSDC::setNetworkConfig(std::unique_ptr<NetworkConfig> networkConfig)
   networkConfig_ = std::move(networkConfig);
 }
 
+void MicroSDC::setNotificationBatchingWindow(std::chrono::milliseconds batchingWindow)
+{
+  std::lock_guard<std::mutex> lock(runningMutex_);
+  if (running_)
+  {
+    throw std::runtime_error("MicroSDC has to be stopped to set the notification batching window!");
+  }
+  notificationBatchingWindow_ = batchingWindow;
+}
+
+void MicroSDC::setNotificationBatchingPolicy(NotificationBatchingPolicy batchingPolicy)
+{
+  std::lock_guard<std::mutex> lock(runningMutex_);
+  if (running_)
+  {
+    throw std::runtime_error("MicroSDC has to be stopped to set the notification batching policy!");
+  }
+  notificationBatchingPolicy_ = std::move(batchingPolicy);
+}
+
+void MicroSDC::setWorkerThreadCount(std::size_t workerThreadCount)
+{
+  std::lock_guard<std::mutex> lock(runningMutex_);
+  if (running_)
+  {
+    throw std::runtime_error("MicroSDC has to be stopped to set the worker thread count!");
+  }
+  workerThreadCount_ = workerThreadCount;
+}
+
+void MicroSDC::setExecutionContext(std::shared_ptr<ExecutionContext> executionContext)
+{
+  std::lock_guard<std::mutex> lock(runningMutex_);
+  if (running_)
+  {
+    throw std::runtime_error("MicroSDC has to be stopped to set the execution context!");
+  }
+  executionContext_ = std::move(executionContext);
+}
+
 std::string MicroSDC::calculateUUID()
 {
   auto uuid = UUIDGenerator{}();
@@ -248,6 +449,18 @@ void MicroSDC::updateState(const std::shared_ptr<BICEPS::PM::NumericMetricState>
   notifyEpisodicMetricReport(newState);
 }
 
+void MicroSDC::updateState(
+    const std::shared_ptr<BICEPS::PM::RealTimeSampleArrayMetricState>& state)
+{
+  std::lock_guard<std::mutex> lock(runningMutex_);
+  if (!running_)
+  {
+    return;
+  }
+  auto newState = updateMdib(state);
+  streamingService_->publish({std::move(newState)}, getMdibVersion());
+}
+
 template <class T>
 std::shared_ptr<const T> MicroSDC::updateMdib(std::shared_ptr<T> newState)
 {
@@ -1,14 +1,21 @@
 #pragma once
 
 #include "DeviceCharacteristics.hpp"
+#include "ExecutionContext.hpp"
 #include "WebServer/WebServer.hpp"
 #include "discovery/DiscoveryService.hpp"
+#include "services/SoapService.hpp"
+#include "streaming/StreamingService.hpp"
+#include <asio.hpp>
+#include <chrono>
+#include <functional>
 #include <map>
 #include <mutex>
-#include <thread>
 #include <vector>
 
+class MetadataProvider;
 class NetworkConfig;
+class SessionManager;
 class StateHandler;
 class SubscriptionManager;
 namespace BICEPS::PM
@@ -18,7 +25,12 @@ namespace BICEPS::PM
   class MdDescription;
   class Mdib;
   class NumericMetricState;
+  class RealTimeSampleArrayMetricState;
 } // namespace BICEPS::PM
+namespace WS::EVENTING
+{
+  struct Subscribe;
+} // namespace WS::EVENTING
 
 /// @brief MicroSDC implements the central SDC instance with an interface to any SDC utility
 class MicroSDC
@@ -27,19 +39,31 @@ public:
   /// @brief constructs an MicroSDC instance
   explicit MicroSDC();
 
-  /// @brief starts the sdcThread calling startup()
+  /// @brief starts all SDC components and services. A device added to a MicroSDCHost is started by
+  /// its host instead.
   void start();
 
-  /// @brief stops all components when disconnected
+  /// @brief stops all components when disconnected. A device added to a MicroSDCHost is stopped
+  /// by its host instead.
   void stop();
 
   /// @brief returns whether MicroSDC is running
   /// @return whether MicroSDC is running
   bool isRunning() const;
 
-  /// @brief gets the mdib representation of this MicroSDC instance
-  /// @return constant reference to the mdib
-  const BICEPS::PM::Mdib& getMdib() const;
+  /// @brief gets the counters of the web server, e.g. full and resumed TLS handshakes
+  /// @return a snapshot of the web server statistics
+  WebServerStatistics getWebServerStatistics() const;
+
+  /// @brief gets the counters of the discovery service, e.g. received and answered probes
+  /// @return a snapshot of the discovery statistics
+  DiscoveryStatistics getDiscoveryStatistics() const;
+
+  /// @brief gets a snapshot of the mdib representation of this MicroSDC instance. States are
+  /// shared and replaced on update, so the snapshot stays consistent while requests are served
+  /// concurrently.
+  /// @return copy of the mdib
+  BICEPS::PM::Mdib getMdib() const;
 
   /// @brief updates the MdDescription part of the mdib
   /// @param mdDescription the new mdDescription
@@ -65,6 +89,37 @@ public:
   /// @param networkConfig the pointer to the network configuration
   void setNetworkConfig(std::unique_ptr<NetworkConfig> networkConfig);
 
+  /// @brief sets the time window reports to a single subscriber are collected in and merged before
+  /// being sent. This should be set before start is called!
+  /// @param batchingWindow the batching window, e.g. 0-100ms. Zero sends every report immediately.
+  void setNotificationBatchingWindow(std::chrono::milliseconds batchingWindow);
+
+  /// chooses the batching window of a single subscription from its subscribe request
+  using NotificationBatchingPolicy =
+      std::function<std::chrono::milliseconds(const WS::EVENTING::Subscribe& subscribeRequest)>;
+
+  /// @brief sets the policy choosing the batching window of each subscription, e.g. a window for
+  /// subscribers of high rate metrics and none for others by their NotifyTo address or filter. This
+  /// should be set before start is called!
+  /// @param batchingPolicy the policy overriding the notification batching window. Null applies the
+  /// notification batching window to every subscription.
+  void setNotificationBatchingPolicy(NotificationBatchingPolicy batchingPolicy);
+
+  /// @brief sets the number of worker threads handling expensive requests, e.g. GetMdib and
+  /// SetValue, so they do not block the web server threads. This should be set before start is
+  /// called!
+  /// @param workerThreadCount the number of worker threads. Zero handles every request on the web
+  /// server threads.
+  void setWorkerThreadCount(std::size_t workerThreadCount);
+
+  /// @brief sets the execution context driving the discovery, the web server, the streaming, the
+  /// batching timer and the notification delivery of this instance together, including the
+  /// SubscriptionEnd messages, instead of a thread for each of them. The worker threads are not
+  /// affected. This should be set before start is called!
+  /// @param executionContext the execution context, which may be shared with other instances.
+  /// Null restores a thread for each component.
+  void setExecutionContext(std::shared_ptr<ExecutionContext> executionContext);
+
   /// @brief get a valid message id for WS-Addressing
   /// @return string of a message id
   static std::string calculateMessageID();
@@ -81,6 +136,11 @@ public:
   /// @param state the state to update
   void updateState(const std::shared_ptr<BICEPS::PM::NumericMetricState>& state);
 
+  /// @brief updates a given sample array state in the mdib representation and publishes its
+  /// samples on the waveform stream
+  /// @param state the state to update
+  void updateState(const std::shared_ptr<BICEPS::PM::RealTimeSampleArrayMetricState>& state);
+
   /// @brief sets the location of this instance
   /// @param descriptorHandle the descriptor of the location state descriptor
   /// @param locationDetail the location information to set
@@ -88,16 +148,26 @@ public:
                    const BICEPS::PM::LocationDetailType& locationDetail);
 
 private:
+  /// the host starts and stops its devices
+  friend class MicroSDCHost;
+
   /// a pointer to the location context state holding location descriptor of this instance
   std::shared_ptr<BICEPS::PM::LocationContextState> locationContextState_{nullptr};
-  /// the SDC thread
-  std::thread sdcThread_;
-  /// pointer to the discovery service
-  std::unique_ptr<DiscoveryService> discoveryService_{nullptr};
+  /// pointer to the discovery service, shared with the other devices of a MicroSDCHost
+  std::shared_ptr<DiscoveryService> discoveryService_{nullptr};
+  /// the target service of this instance at the discovery service
+  DiscoveryService::TargetId discoveryTarget_{0};
+  /// the metadata of this instance, describing the services of the last start
+  std::shared_ptr<const MetadataProvider> metadata_{nullptr};
+  /// pointer to the waveform streaming service. Only present if waveforms are provided
+  std::unique_ptr<StreamingService> streamingService_{nullptr};
   /// pointer to the subscription manager
   std::shared_ptr<SubscriptionManager> subscriptionManager_{nullptr};
-  /// pointer to the WebServer
+  /// pointer to the WebServer. Not present if the WebServer of a MicroSDCHost is used
   std::unique_ptr<WebServerInterface> webserver_{nullptr};
+  /// worker threads handling deferred requests. Declared after the WebServer so pending requests
+  /// are finished before the services are destroyed.
+  std::unique_ptr<asio::thread_pool> workers_{nullptr};
   /// pointer to the mdib representation
   std::unique_ptr<BICEPS::PM::Mdib> mdib_{nullptr};
   /// mutex protecting changes in the mdib
@@ -108,6 +178,8 @@ private:
   std::shared_ptr<NetworkConfig> networkConfig_{nullptr};
   /// whether SDC is started or stopped
   bool running_{false};
+  /// whether this instance was added to a MicroSDCHost starting and stopping it
+  bool hosted_{false};
   /// mutex protecting running_ member
   mutable std::mutex runningMutex_;
   /// endpoint reference of this MicroSDC instance
@@ -117,11 +189,58 @@ private:
 
   /// Device Characteristics of this instance
   DeviceCharacteristics deviceCharacteristics_;
+  /// the batching window of notifications applied to subscriptions
+  std::chrono::milliseconds notificationBatchingWindow_{0};
+  /// the policy choosing the batching window of each subscription, if set
+  NotificationBatchingPolicy notificationBatchingPolicy_{nullptr};
+  /// the number of worker threads handling deferred requests
+  std::size_t workerThreadCount_{1};
+  /// the execution context driving all components, a thread for each component if null
+  std::shared_ptr<ExecutionContext> executionContext_{nullptr};
 
 
   /// @brief Starts and initializes all SDC components and services
   void startup();
 
+  /// @brief creates the streaming service and metadata of this instance and initializes its
+  /// states. runningMutex_ has to be held.
+  /// @param basePath the path the services of this instance are served below
+  /// @param ioContext the io context to stream on, a thread of its own if null
+  void prepare(std::string basePath, const std::shared_ptr<asio::io_context>& ioContext);
+
+  /// @brief gets the addresses of the network interfaces discovery messages are exchanged on
+  /// @param networkConfig the network configuration
+  /// @return the configured addresses or the unspecified ipv4 address for the default interface
+  static std::vector<asio::ip::address> discoveryAddresses(const NetworkConfig& networkConfig);
+
+  /// @brief describes this instance as target service of a DiscoveryService. Requires prepare().
+  /// @param interfaces the addresses of the network interfaces this instance is announced on
+  /// @return the target service with the address of the device service on each interface
+  DiscoveryService::Target discoveryTarget(const std::vector<asio::ip::address>& interfaces) const;
+
+  /// @brief creates the subscription manager and web services of this instance and registers them
+  /// at a web server. Requires prepare(), runningMutex_ has to be held.
+  /// @param webserver the web server to serve the services
+  /// @param discoveryService the discovery service announcing this instance
+  /// @param discoveryTarget the target service of this instance at the discovery service
+  /// @param sessionManager the client sessions to deliver notifications with, a new one if null
+  /// @param workerExecutor runs expensive requests off the web server threads, if set
+  /// @param ioContext the io context to batch and deliver notifications on, threads of their own
+  /// if null
+  void attach(WebServerInterface& webserver, std::shared_ptr<DiscoveryService> discoveryService,
+              DiscoveryService::TargetId discoveryTarget,
+              std::shared_ptr<SessionManager> sessionManager,
+              SoapService::Executor workerExecutor,
+              const std::shared_ptr<asio::io_context>& ioContext);
+
+  /// @brief starts streaming waveforms and marks this instance running. runningMutex_ has to be
+  /// held.
+  void activate();
+
+  /// @brief stops streaming waveforms and marks this instance stopped. runningMutex_ has to be
+  /// held.
+  void deactivate();
+
   /// @brief updates the internal mdib representation with a given state
   /// @tparam infered state type of the state to update
   /// @param state the new state to update in the mdib
@@ -0,0 +1,185 @@
+#include "MicroSDCHost.hpp"
+#include "Log.hpp"
+#include "MicroSDC.hpp"
+#include "SessionManager/SessionManager.hpp"
+#include "networking/NetworkConfig.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+static constexpr const char* TAG = "MicroSDCHost";
+
+MicroSDCHost::MicroSDCHost(std::unique_ptr<NetworkConfig> networkConfig)
+  : networkConfig_(std::move(networkConfig))
+{
+  if (networkConfig_ == nullptr)
+  {
+    throw std::runtime_error("MicroSDCHost needs a NetworkConfig!");
+  }
+}
+
+MicroSDCHost::~MicroSDCHost()
+{
+  stop();
+}
+
+void MicroSDCHost::addDevice(std::shared_ptr<MicroSDC> device, std::string basePath)
+{
+  std::lock_guard<std::mutex> lock(runningMutex_);
+  if (running_)
+  {
+    throw std::runtime_error("MicroSDCHost has to be stopped to add a device!");
+  }
+  if (basePath.empty() || basePath.front() != '/')
+  {
+    throw std::runtime_error("Base path '" + basePath + "' of a device has to start with '/'!");
+  }
+  const auto endpointReference = device->getEndpointReference();
+  for (const auto& hosted : devices_)
+  {
+    if (hosted.basePath == basePath)
+    {
+      throw std::runtime_error("Base path '" + basePath + "' is used by another device!");
+    }
+    if (hosted.device->getEndpointReference() == endpointReference)
+    {
+      throw std::runtime_error("Endpoint reference '" + endpointReference +
+                               "' is used by another device!");
+    }
+  }
+  {
+    std::lock_guard<std::mutex> deviceLock(device->runningMutex_);
+    if (device->running_ || device->hosted_)
+    {
+      throw std::runtime_error("MicroSDC has to be stopped and not hosted to be added to a host!");
+    }
+    device->hosted_ = true;
+    device->networkConfig_ = networkConfig_;
+  }
+  devices_.push_back({std::move(device), std::move(basePath)});
+}
+
+void MicroSDCHost::setWorkerThreadCount(std::size_t workerThreadCount)
+{
+  std::lock_guard<std::mutex> lock(runningMutex_);
+  if (running_)
+  {
+    throw std::runtime_error("MicroSDCHost has to be stopped to set the worker thread count!");
+  }
+  workerThreadCount_ = workerThreadCount;
+}
+
+void MicroSDCHost::setExecutionContext(std::shared_ptr<ExecutionContext> executionContext)
+{
+  std::lock_guard<std::mutex> lock(runningMutex_);
+  if (running_)
+  {
+    throw std::runtime_error("MicroSDCHost has to be stopped to set the execution context!");
+  }
+  executionContext_ = std::move(executionContext);
+}
+
+void MicroSDCHost::start()
+{
+  std::lock_guard<std::mutex> lock(runningMutex_);
+  if (running_)
+  {
+    LOG(LogLevel::WARNING, "called MicroSDCHost start but already running!");
+    return;
+  }
+  if (devices_.empty())
+  {
+    LOG(LogLevel::ERROR, "Failed to start MicroSDCHost. Add a device first!");
+    return;
+  }
+  LOG(LogLevel::INFO, "Initialize " << devices_.size() << " devices...");
+  const auto ioContext =
+      executionContext_ != nullptr ? executionContext_->ioContext() : nullptr;
+  webserver_ = WebServerFactory::produce(networkConfig_, ioContext);
+
+  const auto interfaces = MicroSDC::discoveryAddresses(*networkConfig_);
+  std::vector<DiscoveryService::Target> targets;
+  for (const auto& hosted : devices_)
+  {
+    std::lock_guard<std::mutex> deviceLock(hosted.device->runningMutex_);
+    hosted.device->prepare(hosted.basePath, ioContext);
+    targets.emplace_back(hosted.device->discoveryTarget(interfaces));
+  }
+  discoveryService_ =
+      std::make_shared<DiscoveryService>(interfaces, std::move(targets), ioContext);
+  sessionManager_ = std::make_shared<SessionManager>(ioContext);
+
+  // expensive actions of all devices are deferred from the web server threads to the workers
+  SoapService::Executor workerExecutor;
+  if (workerThreadCount_ > 0)
+  {
+    workers_ = std::make_unique<asio::thread_pool>(workerThreadCount_);
+    workerExecutor = [workers = workers_.get()](std::function<void()> task) {
+      asio::post(*workers, std::move(task));
+    };
+  }
+  for (std::size_t i = 0; i < devices_.size(); ++i)
+  {
+    const auto& device = devices_[i].device;
+    std::lock_guard<std::mutex> deviceLock(device->runningMutex_);
+    device->attach(*webserver_, discoveryService_, i, sessionManager_, workerExecutor, ioContext);
+  }
+
+  webserver_->start();
+  discoveryService_->start();
+  for (const auto& hosted : devices_)
+  {
+    std::lock_guard<std::mutex> deviceLock(hosted.device->runningMutex_);
+    hosted.device->activate();
+  }
+  running_ = true;
+}
+
+void MicroSDCHost::stop()
+{
+  std::lock_guard<std::mutex> lock(runningMutex_);
+  if (!running_)
+  {
+    return;
+  }
+  discoveryService_->stop();
+  for (const auto& hosted : devices_)
+  {
+    std::lock_guard<std::mutex> deviceLock(hosted.device->runningMutex_);
+    hosted.device->deactivate();
+  }
+  webserver_->stop();
+  if (workers_ != nullptr)
+  {
+    // finish the deferred requests still referring to the services
+    workers_->join();
+    workers_.reset();
+  }
+  running_ = false;
+  LOG(LogLevel::INFO, "stopped");
+}
+
+bool MicroSDCHost::isRunning() const
+{
+  std::lock_guard<std::mutex> lock(runningMutex_);
+  return running_;
+}
+
+WebServerStatistics MicroSDCHost::getWebServerStatistics() const
+{
+  std::lock_guard<std::mutex> lock(runningMutex_);
+  if (webserver_ == nullptr)
+  {
+    return WebServerStatistics();
+  }
+  return webserver_->statistics();
+}
+
+DiscoveryStatistics MicroSDCHost::getDiscoveryStatistics() const
+{
+  std::lock_guard<std::mutex> lock(runningMutex_);
+  if (discoveryService_ == nullptr)
+  {
+    return DiscoveryStatistics();
+  }
+  return discoveryService_->statistics();
+}
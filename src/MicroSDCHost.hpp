@@ -0,0 +1,102 @@
+#pragma once
+
+#include "ExecutionContext.hpp"
+#include "WebServer/WebServer.hpp"
+#include "discovery/DiscoveryService.hpp"
+#include <asio.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class MicroSDC;
+class NetworkConfig;
+class SessionManager;
+
+/// @brief MicroSDCHost runs several SDC devices in a single process, e.g. a gateway bridging
+/// legacy devices. The devices are served by a single web server below their own base paths and
+/// announced by a single discovery service answering for each of them with its own endpoint
+/// reference. Their notifications are delivered by shared client sessions and their expensive
+/// requests are handled by shared worker threads.
+class MicroSDCHost
+{
+public:
+  /// @brief constructs a host
+  /// @param networkConfig the network configuration of the web server and discovery shared by all
+  /// devices
+  explicit MicroSDCHost(std::unique_ptr<NetworkConfig> networkConfig);
+  MicroSDCHost(const MicroSDCHost&) = delete;
+  MicroSDCHost(MicroSDCHost&&) = delete;
+  MicroSDCHost& operator=(const MicroSDCHost&) = delete;
+  MicroSDCHost& operator=(MicroSDCHost&&) = delete;
+  ~MicroSDCHost();
+
+  /// @brief adds a device to this host. The device is configured as if it was run alone except
+  /// for its network configuration, which is the one of this host. It is started and stopped with
+  /// this host. This should be called before start is called!
+  /// @param device the device to add
+  /// @param basePath the path the services of the device are served below, e.g. "/device1"
+  void addDevice(std::shared_ptr<MicroSDC> device, std::string basePath);
+
+  /// @brief sets the number of worker threads handling expensive requests of all devices. This
+  /// should be set before start is called!
+  /// @param workerThreadCount the number of worker threads. Zero handles every request on the web
+  /// server threads.
+  void setWorkerThreadCount(std::size_t workerThreadCount);
+
+  /// @brief sets the execution context driving the discovery, the web server, the streaming, the
+  /// batching timers and the notification delivery of all devices together, including the
+  /// SubscriptionEnd messages, instead of a thread for each of them. The worker threads are not
+  /// affected. This should be set before start is called!
+  /// @param executionContext the execution context. Null restores a thread for each component.
+  void setExecutionContext(std::shared_ptr<ExecutionContext> executionContext);
+
+  /// @brief starts the web server, the discovery service and all devices
+  void start();
+
+  /// @brief stops all devices, the discovery service and the web server
+  void stop();
+
+  /// @brief returns whether this host is running
+  /// @return whether this host is running
+  bool isRunning() const;
+
+  /// @brief gets the counters of the web server shared by all devices
+  /// @return a snapshot of the web server statistics
+  WebServerStatistics getWebServerStatistics() const;
+
+  /// @brief gets the counters of the discovery service shared by all devices
+  /// @return a snapshot of the discovery statistics
+  DiscoveryStatistics getDiscoveryStatistics() const;
+
+private:
+  /// @brief a device of this host
+  struct HostedDevice
+  {
+    /// the device
+    std::shared_ptr<MicroSDC> device;
+    /// the path the services of the device are served below
+    std::string basePath;
+  };
+
+  /// the network configuration shared by all devices
+  const std::shared_ptr<NetworkConfig> networkConfig_;
+  /// the devices of this host
+  std::vector<HostedDevice> devices_;
+  /// the web server serving all devices
+  std::unique_ptr<WebServerInterface> webserver_{nullptr};
+  /// the discovery service announcing all devices
+  std::shared_ptr<DiscoveryService> discoveryService_{nullptr};
+  /// the client sessions notifications of all devices are delivered with
+  std::shared_ptr<SessionManager> sessionManager_{nullptr};
+  /// worker threads handling the deferred requests of all devices
+  std::unique_ptr<asio::thread_pool> workers_{nullptr};
+  /// the number of worker threads handling deferred requests
+  std::size_t workerThreadCount_{1};
+  /// the execution context driving all components, a thread for each component if null
+  std::shared_ptr<ExecutionContext> executionContext_{nullptr};
+  /// whether this host is started or stopped
+  bool running_{false};
+  /// mutex protecting running_ and the configuration of this host
+  mutable std::mutex runningMutex_;
+};
@@ -56,4 +56,11 @@ namespace SDC
       "http://standards.ieee.org/downloads/11073/11073-20701-2018/StateEventService/"
       "PeriodicOperationalStateReport";
 
+  SDCConstant ACTION_WAVEFORM_STREAM =
+      "http://standards.ieee.org/downloads/11073/11073-20701-2018/WaveformService/WaveformStream";
+  SDCConstant STREAM_TYPE_WAVEFORM =
+      "http://standards.ieee.org/downloads/11073/11073-20701-2018/StreamingService/WaveformStream";
+  SDCConstant STREAM_ID_WAVEFORM = "WaveformStream";
+  SDCConstant QNAME_WAVEFORM_STREAM = "mm:WaveformStream";
+
 } // namespace SDC
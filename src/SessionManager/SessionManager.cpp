@@ -1,29 +1,132 @@
 #include "SessionManager.hpp"
 #include "Log.hpp"
+#include <algorithm>
+
+void ClientSessionInterface::sendAsync(const Notification& notification, SendCallback callback)
+{
+  const auto start = std::chrono::steady_clock::now();
+  SendResult result;
+  result.delivered = send(notification);
+  result.status = result.delivered ? "delivered" : "failed";
+  result.latency = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  callback(result);
+}
+
+SessionManager::SessionManager(std::shared_ptr<asio::io_context> ioContext)
+  : ioContext_(std::move(ioContext))
+{
+}
 
 void SessionManager::createSession(const std::string& notifyTo)
 {
-  if (sessions_.count(notifyTo) != 0)
+  std::lock_guard<std::mutex> lock(sessionsMutex_);
+  if (auto sessionIt = sessions_.find(notifyTo); sessionIt != sessions_.end())
   {
     LOG(LogLevel::INFO, "Client session already exists");
+    ++sessionIt->second.users;
     return;
   }
-  sessions_.emplace(notifyTo, ClientSessionFactory::produce(notifyTo));
+  sessions_.emplace(notifyTo, Session{ClientSessionFactory::produce(notifyTo, ioContext_)});
 }
 
-void SessionManager::sendToSession(const std::string& notifyTo, const std::string& message)
+bool SessionManager::isAvailable(const std::string& notifyTo) const
 {
+  std::lock_guard<std::mutex> lock(sessionsMutex_);
   auto sessionIt = sessions_.find(notifyTo);
   if (sessionIt == sessions_.end())
   {
-    LOG(LogLevel::ERROR, "Cannot find client session with address " << notifyTo);
-    return;
+    return false;
+  }
+  const auto& session = sessionIt->second;
+  return session.failures < FAILURE_BUDGET &&
+         session.retryTime <= std::chrono::steady_clock::now();
+}
+
+bool SessionManager::isFailing(const std::string& notifyTo) const
+{
+  std::lock_guard<std::mutex> lock(sessionsMutex_);
+  auto sessionIt = sessions_.find(notifyTo);
+  return sessionIt != sessions_.end() && sessionIt->second.failures > 0;
+}
+
+bool SessionManager::isExhausted(const std::string& notifyTo) const
+{
+  std::lock_guard<std::mutex> lock(sessionsMutex_);
+  auto sessionIt = sessions_.find(notifyTo);
+  return sessionIt != sessions_.end() && sessionIt->second.failures >= FAILURE_BUDGET;
+}
+
+void SessionManager::sendToSession(const std::string& notifyTo, const Notification& notification,
+                                   ClientSessionInterface::SendCallback onComplete)
+{
+  std::shared_ptr<ClientSessionInterface> client;
+  {
+    std::lock_guard<std::mutex> lock(sessionsMutex_);
+    auto sessionIt = sessions_.find(notifyTo);
+    if (sessionIt == sessions_.end())
+    {
+      LOG(LogLevel::ERROR, "Cannot find client session with address " << notifyTo);
+      if (onComplete)
+      {
+        onComplete(SendResult{false, "no session", std::chrono::microseconds{0}});
+      }
+      return;
+    }
+    client = sessionIt->second.client;
   }
   LOG(LogLevel::INFO, "Sending to " << notifyTo);
-  sessionIt->second->send(message);
+  // the client is invoked outside of the lock as it may complete synchronously
+  client->sendAsync(notification, [this, notifyTo, sender = client.get(),
+                                   onComplete = std::move(onComplete)](const SendResult& result) {
+    onDeliveryCompleted(notifyTo, sender, result);
+    if (onComplete)
+    {
+      onComplete(result);
+    }
+  });
+}
+
+void SessionManager::onDeliveryCompleted(const std::string& notifyTo,
+                                         const ClientSessionInterface* client,
+                                         const SendResult& result)
+{
+  std::lock_guard<std::mutex> lock(sessionsMutex_);
+  auto sessionIt = sessions_.find(notifyTo);
+  if (sessionIt == sessions_.end() || sessionIt->second.client.get() != client)
+  {
+    return;
+  }
+  auto& session = sessionIt->second;
+  if (result.delivered)
+  {
+    LOG(LogLevel::DEBUG, "Delivered to " << notifyTo << " in " << result.latency.count()
+                                         << "us: " << result.status);
+    session.failures = 0;
+    return;
+  }
+  ++session.failures;
+  const auto backoff =
+      std::min<std::chrono::milliseconds>(
+          INITIAL_BACKOFF * (1U << (std::min(session.failures, FAILURE_BUDGET) - 1)), MAX_BACKOFF);
+  session.retryTime = std::chrono::steady_clock::now() + backoff;
+  LOG(LogLevel::WARNING, "Delivery to " << notifyTo << " failed (" << result.status << ") "
+                                        << session.failures << " times, backing off for "
+                                        << backoff.count() << "ms");
 }
 
 void SessionManager::deleteSession(const std::string& notifyTo)
 {
-  sessions_.erase(notifyTo);
+  std::shared_ptr<ClientSessionInterface> client;
+  {
+    std::lock_guard<std::mutex> lock(sessionsMutex_);
+    auto sessionIt = sessions_.find(notifyTo);
+    if (sessionIt == sessions_.end() || --sessionIt->second.users > 0)
+    {
+      return;
+    }
+    client = std::move(sessionIt->second.client);
+    sessions_.erase(sessionIt);
+  }
+  // the session is destroyed outside of the lock as it waits for running completions
 }
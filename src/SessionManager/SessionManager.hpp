@@ -1,44 +1,165 @@
 #pragma once
 
+#include <asio.hpp>
+#include <chrono>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 
+/// @brief Notification holds a serialized notification message split into fragments. The fragments
+/// shared by all receivers of an event are serialized once and held in refcounted immutable
+/// buffers, only the header is serialized for each receiver individually.
+struct Notification
+{
+  /// refcounted immutable buffer shared between the notifications of a single event
+  using SharedBuffer = std::shared_ptr<const std::string>;
+
+  /// xml declaration and soap:Envelope start tag
+  SharedBuffer prefix;
+  /// the soap:Header addressing a single receiver
+  std::string header;
+  /// soap:Body and soap:Envelope end tag
+  SharedBuffer suffix;
+
+  /// @brief returns the accumulated size of all fragments
+  /// @return the size of the serialized message in bytes
+  std::size_t size() const
+  {
+    return prefix->size() + header.size() + suffix->size();
+  }
+};
+
+/// @brief SendResult describes the outcome of sending a notification to a client
+struct SendResult
+{
+  /// whether the client accepted the notification with a 2xx status
+  bool delivered{false};
+  /// the HTTP status of the response or the error that prevented the delivery
+  std::string status;
+  /// the time from handing the notification to the session until its completion
+  std::chrono::microseconds latency{0};
+};
+
 /// @brief ClientSessionInterface defines an interface to a client session
 class ClientSessionInterface
 {
 public:
+  /// callback invoked once a notification was delivered or failed
+  using SendCallback = std::function<void(const SendResult& result)>;
+
+  /// timeout for establishing the connection to a client
+  static constexpr std::chrono::seconds CONNECT_TIMEOUT{2};
+  /// timeout for writing a request and receiving the response of a client
+  static constexpr std::chrono::seconds REQUEST_TIMEOUT{5};
+
   // TODO copy constructors etc
   virtual ~ClientSessionInterface() = default;
-  /// @brief sends a given data message string the this client
-  /// @param message the message to send
-  virtual void send(const std::string& message) = 0;
+  /// @brief sends a given notification to this client. The fragments are written subsequently
+  /// without concatenating them first where the port allows it.
+  /// @param notification the notification to send
+  /// @return whether the client accepted the notification
+  virtual bool send(const Notification& notification) = 0;
+
+  /// @brief sends a given notification without waiting for the response. The default
+  /// implementation sends synchronously and invokes the callback before returning.
+  /// @param notification the notification to send
+  /// @param callback invoked with the result once the notification completed. It must not destroy
+  /// this session, but may hold the last reference to it, which is released after the callback
+  /// returned. Releasing the last session to a server aborts its pending notifications.
+  virtual void sendAsync(const Notification& notification, SendCallback callback);
 };
 
 /// @brief SessionManager defines an interface to client sessions for eventing
-/// notifications
+/// notifications. A session may be shared by several users, e.g. the SubscriptionManagers of the
+/// devices of a MicroSDCHost notifying the same client, and is deleted once its last user released
+/// it.
 class SessionManager
 {
 public:
-  /// @brief creates a new session for a given client address
+  /// number of consecutive failed deliveries after which a session is given up
+  static constexpr unsigned int FAILURE_BUDGET = 5;
+  /// time to wait before retrying a session after its first failed delivery
+  static constexpr std::chrono::milliseconds INITIAL_BACKOFF{500};
+  /// upper bound of the exponentially growing time to wait before retrying a session
+  static constexpr std::chrono::milliseconds MAX_BACKOFF{30000};
+
+  /// @brief constructs a SessionManager
+  /// @param ioContext the io context the sessions deliver on, shared with other components. The
+  /// process wide client io context of the port is used if none is given.
+  explicit SessionManager(std::shared_ptr<asio::io_context> ioContext = nullptr);
+
+  /// @brief creates a new session for a given client address or adds a user to the existing one
   /// @param notifyTo the address of the client
   void createSession(const std::string& notifyTo);
 
-  /// @brief sends a message string to a client session with given address
+  /// @brief returns whether a session should be sent to, i.e. it is not backing off after a failed
+  /// delivery and did not exhaust its failure budget
+  /// @param notifyTo the address of the client
+  /// @return whether sending to this session is currently allowed
+  bool isAvailable(const std::string& notifyTo) const;
+
+  /// @brief returns whether a session had failed deliveries recently
+  /// @param notifyTo the address of the client
+  /// @return whether the last delivery to the session failed
+  bool isFailing(const std::string& notifyTo) const;
+
+  /// @brief returns whether a session exhausted its budget of consecutive failed deliveries
   /// @param notifyTo the address of the client
-  /// @param message the message to send to the client
-  void sendToSession(const std::string& notifyTo, const std::string& message);
+  /// @return whether the session should be given up
+  bool isExhausted(const std::string& notifyTo) const;
 
-  /// @brief deletes the session of the client with given address
+  /// @brief sends a notification to a client session with given address without waiting for its
+  /// response. A failed delivery backs the session off exponentially.
+  /// @param notifyTo the address of the client
+  /// @param notification the notification to send to the client
+  /// @param onComplete optionally invoked with the result after the session state was updated
+  void sendToSession(const std::string& notifyTo, const Notification& notification,
+                     ClientSessionInterface::SendCallback onComplete = nullptr);
+
+  /// @brief releases the session of the client with given address, deleting it if this was its
+  /// last user
   /// @param notifyTo the address of the client
   void deleteSession(const std::string& notifyTo);
 
 private:
-  std::map<std::string, std::shared_ptr<ClientSessionInterface>> sessions_;
+  /// @brief Session holds a client session and its delivery failure state
+  struct Session
+  {
+    /// the client session
+    std::shared_ptr<ClientSessionInterface> client;
+    /// number of consecutive failed deliveries
+    unsigned int failures{0};
+    /// the time the session may be sent to again after a failed delivery
+    std::chrono::steady_clock::time_point retryTime{};
+    /// number of users that created the session and did not release it yet
+    unsigned int users{1};
+  };
+
+  /// the io context the sessions deliver on, if shared with other components
+  const std::shared_ptr<asio::io_context> ioContext_;
+  /// mutex protecting the sessions, which are updated on completion of their deliveries
+  mutable std::mutex sessionsMutex_;
+  /// the client sessions by their address
+  std::map<std::string, Session> sessions_;
+
+  /// @brief updates the failure state of a session after a delivery completed
+  /// @param notifyTo the address of the client
+  /// @param client the session the delivery was sent with
+  /// @param result the result of the delivery
+  void onDeliveryCompleted(const std::string& notifyTo, const ClientSessionInterface* client,
+                           const SendResult& result);
 };
 
 class ClientSessionFactory
 {
 public:
-  static std::unique_ptr<ClientSessionInterface> produce(const std::string& address);
+  /// @brief creates a client session of the platform
+  /// @param address the address of the client
+  /// @param ioContext the io context to deliver on, the process wide client io context of the port
+  /// if none is given. Ports not based on asio ignore it.
+  /// @return the created session
+  static std::unique_ptr<ClientSessionInterface>
+  produce(const std::string& address, std::shared_ptr<asio::io_context> ioContext = nullptr);
 };
@@ -13,6 +13,7 @@ public:
   enum class StateHandlerKind
   {
     NUMERIC_METRIC,
+    REAL_TIME_SAMPLE_ARRAY_METRIC,
   };
 
   /// @brief Constructs a new StateHandler referring to a descriptor
@@ -107,3 +108,42 @@ public:
     updateState(state);
   }
 };
+
+/// @brief Implements a MdStateHandler for RealTimeSampleArrayMetricStates. Samples are published
+/// via the waveform stream.
+class RealTimeSampleArrayStateHandler
+  : public MdStateHandler<BICEPS::PM::RealTimeSampleArrayMetricState>
+{
+public:
+  /// @brief constructs a new RealTimeSampleArrayStateHandler attached to a given descriptor
+  /// @param descriptorHandle the handle of the state's descriptor
+  explicit RealTimeSampleArrayStateHandler(const std::string& descriptorHandle)
+    : MdStateHandler(StateHandlerKind::REAL_TIME_SAMPLE_ARRAY_METRIC, descriptorHandle)
+  {
+  }
+
+  static bool classof(const StateHandler* other)
+  {
+    return other->getKind() == StateHandlerKind::REAL_TIME_SAMPLE_ARRAY_METRIC;
+  }
+
+  std::shared_ptr<BICEPS::PM::RealTimeSampleArrayMetricState> getInitialState() const override
+  {
+    auto state =
+        std::make_shared<BICEPS::PM::RealTimeSampleArrayMetricState>(getDescriptorHandle());
+    state->MetricValue = std::make_optional<BICEPS::PM::SampleArrayValue>(
+        BICEPS::PM::MetricQualityType{BICEPS::PM::MeasurementValidity::Vld});
+    state->MetricValue->Samples = BICEPS::PM::SampleArrayValue::SamplesType();
+    return state;
+  }
+
+  /// @brief sets a new block of samples to the state handled by this handler, updates the mdib
+  /// and streams the samples
+  /// @param samples the new sample block to set
+  void setSamples(BICEPS::PM::SampleArrayValue::SamplesType samples)
+  {
+    auto state = getInitialState();
+    state->MetricValue->Samples = std::move(samples);
+    updateState(state);
+  }
+};
@@ -12,8 +12,67 @@
 
 static constexpr const char* TAG = "SubscriptionManager";
 
+SubscriptionManager::SubscriptionManager(std::chrono::milliseconds batchingWindow,
+                                         std::shared_ptr<SessionManager> sessionManager,
+                                         std::shared_ptr<asio::io_context> ioContext,
+                                         BatchingPolicy batchingPolicy)
+  : ioContext_(std::move(ioContext))
+  , sessionManager_(sessionManager != nullptr ? std::move(sessionManager)
+                                              : std::make_shared<SessionManager>(ioContext_))
+  , batchingWindow_(batchingWindow)
+  , batchingPolicy_(std::move(batchingPolicy))
+{
+  if (batchingWindow_.count() == 0 && batchingPolicy_ == nullptr)
+  {
+    return;
+  }
+  batchingRunning_ = true;
+  if (ioContext_ != nullptr)
+  {
+    batchingTimer_.emplace(*ioContext_);
+    return;
+  }
+  batchingThread_ = std::thread([this]() { runBatchedDelivery(); });
+}
+
+SubscriptionManager::~SubscriptionManager()
+{
+  {
+    // waits for a running timer handler, pending ones return without touching this manager
+    std::lock_guard<std::mutex> guardLock(batchingGuard_->mutex);
+    batchingGuard_->alive = false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(subscriptionMutex_);
+    batchingRunning_ = false;
+    if (batchingTimer_.has_value())
+    {
+      batchingTimer_->cancel();
+    }
+  }
+  batchingCondition_.notify_all();
+  if (batchingThread_.joinable())
+  {
+    batchingThread_.join();
+  }
+  // release the sessions of the remaining subscriptions, the SessionManager may outlive this
+  std::vector<std::string> clients;
+  for (const auto& [identifier, info] : subscriptions_)
+  {
+    if (std::find(clients.begin(), clients.end(), info.notifyTo.Address) == clients.end())
+    {
+      clients.emplace_back(info.notifyTo.Address);
+    }
+  }
+  for (const auto& notifyTo : clients)
+  {
+    sessionManager_->deleteSession(notifyTo);
+  }
+}
+
 WS::EVENTING::SubscribeResponse
-SubscriptionManager::dispatch(const WS::EVENTING::Subscribe& subscribeRequest)
+SubscriptionManager::dispatch(const WS::EVENTING::Subscribe& subscribeRequest,
+                              const WS::ADDRESSING::URIType& subscriptionManagerAddress)
 {
   if (!subscribeRequest.Filter.has_value())
   {
@@ -33,18 +92,31 @@ SubscriptionManager::dispatch(const WS::EVENTING::Subscribe& subscribeRequest)
       Duration(Duration::Years{0}, Duration::Months{0}, Duration::Days{0}, Duration::Hours{1},
                Duration::Minutes{0}, Duration::Seconds{0}, false))));
   const auto expires = duration.toExpirationTimePoint();
-  SubscriptionInformation info{subscribeRequest.Delivery.NotifyTo, subscribeRequest.Filter.value(),
-                               expires};
+  const auto batchingWindow =
+      batchingPolicy_ != nullptr
+          ? std::max(batchingPolicy_(subscribeRequest), std::chrono::milliseconds{0})
+          : batchingWindow_;
+  SubscriptionInformation info{subscribeRequest.Delivery.NotifyTo,
+                               subscribeRequest.Filter.value(),
+                               subscribeRequest.EndTo,
+                               subscriptionManagerAddress,
+                               expires,
+                               batchingWindow};
 
+  std::lock_guard<std::mutex> lock(subscriptionMutex_);
+  // this manager uses a single session per client, however many subscriptions it has
+  const bool knownClient =
+      std::any_of(subscriptions_.begin(), subscriptions_.end(), [&info](const auto& it) {
+        return it.second.notifyTo.Address == info.notifyTo.Address;
+      });
+  subscriptions_.emplace(identifier, info);
+  if (!knownClient)
   {
-    std::lock_guard<std::mutex> lock(subscriptionMutex_);
-    subscriptions_.emplace(identifier, info);
+    sessionManager_->createSession(info.notifyTo.Address);
   }
-  sessionManager_.createSession(info.notifyTo.Address);
 
   WS::EVENTING::SubscribeResponse::SubscriptionManagerType subscriptionManager(
-      WS::ADDRESSING::EndpointReferenceType(
-          WS::ADDRESSING::URIType("To be filled by Soap Service")));
+      subscriptionManagerAddress);
   subscriptionManager.ReferenceParameters =
       WS::ADDRESSING::ReferenceParametersType(WS::EVENTING::Identifier{identifier});
   WS::EVENTING::SubscribeResponse subscribeResponse(
@@ -91,7 +163,7 @@ void SubscriptionManager::dispatch(const WS::EVENTING::Unsubscribe& /*unsubscrib
 
   if (numSameClient == 1)
   {
-    sessionManager_.deleteSession(notifyTo);
+    sessionManager_->deleteSession(notifyTo);
   }
   subscriptions_.erase(subscriptionInfo);
   printSubscriptions();
@@ -100,38 +172,193 @@ void SubscriptionManager::dispatch(const WS::EVENTING::Unsubscribe& /*unsubscrib
 void SubscriptionManager::fireEvent(const BICEPS::MM::EpisodicMetricReport& report)
 {
   LOG(LogLevel::DEBUG, "Fire Event: EpisodicMetricReport");
-  std::lock_guard<std::mutex> lock(subscriptionMutex_);
+  {
+    std::lock_guard<std::mutex> lock(subscriptionMutex_);
+    notifySubscribers(report);
+  }
+  sendSubscriptionEnds();
+}
+
+void SubscriptionManager::notifySubscribers(const BICEPS::MM::EpisodicMetricReport& report)
+{
+  handleDeliveryFailures();
   std::vector<const SubscriptionInformation*> subscriber;
-  for (const auto& [id, info] : subscriptions_)
+  bool batchStarted = false;
+  for (auto& [id, info] : subscriptions_)
   {
-    if (std::find(info.filter.begin(), info.filter.end(), SDC::ACTION_EPISODIC_METRIC_REPORT) !=
+    if (std::find(info.filter.begin(), info.filter.end(), SDC::ACTION_EPISODIC_METRIC_REPORT) ==
         info.filter.end())
+    {
+      continue;
+    }
+    if (!sessionManager_->isAvailable(info.notifyTo.Address))
+    {
+      // a shared session may have been exhausted by the deliveries of another device
+      if (sessionManager_->isExhausted(info.notifyTo.Address))
+      {
+        deliveryFailed_->store(true);
+      }
+      continue;
+    }
+    if (info.batchingWindow.count() == 0)
     {
       subscriber.emplace_back(&info);
+      continue;
+    }
+    if (!info.pendingReport.has_value())
+    {
+      info.pendingDueTime = std::chrono::steady_clock::now() + info.batchingWindow;
+      batchStarted = true;
+      if (batchingTimer_.has_value())
+      {
+        scheduleBatchedDelivery(info.pendingDueTime);
+      }
     }
+    mergeReport(info, report);
   }
-  if (subscriber.empty())
+  if (batchStarted && !batchingTimer_.has_value())
   {
-    return;
+    batchingCondition_.notify_all();
   }
-  MESSAGEMODEL::Header header;
-  header.MessageID = MESSAGEMODEL::Header::MessageIDType(MicroSDC::calculateMessageID());
-  header.Action = WS::ADDRESSING::URIType(SDC::ACTION_EPISODIC_METRIC_REPORT);
+  if (!subscriber.empty())
+  {
+    sendReport(std::move(subscriber), report);
+  }
+  // sessions completing synchronously already reported their failures
+  handleDeliveryFailures();
+}
 
-  MESSAGEMODEL::Body body;
-  body.EpisodicMetricReport = report;
+void SubscriptionManager::sendReport(std::vector<const SubscriptionInformation*> subscriber,
+                                     const BICEPS::MM::EpisodicMetricReport& report)
+{
+  // serve healthy subscribers first so a failing peer does not delay them
+  std::stable_partition(subscriber.begin(), subscriber.end(), [this](const auto* info) {
+    return !sessionManager_->isFailing(info->notifyTo.Address);
+  });
 
+  // serialize the report once, only the header addressing the subscriber is built per subscriber
   MESSAGEMODEL::Envelope notifyEnvelope;
-  notifyEnvelope.Header = std::move(header);
-  notifyEnvelope.Body = std::move(body);
+  notifyEnvelope.Header.Action = WS::ADDRESSING::URIType(SDC::ACTION_EPISODIC_METRIC_REPORT);
+  notifyEnvelope.Body.EpisodicMetricReport = report;
 
   MessageSerializer serializer;
   serializer.serialize(notifyEnvelope);
-  const auto messageStr = serializer.str();
-  LOG(LogLevel::DEBUG, "SENDING: " << messageStr);
+  auto [prefix, suffix] = serializer.strSplitAtHeader();
+  const auto sharedPrefix = std::make_shared<const std::string>(std::move(prefix));
+  const auto sharedSuffix = std::make_shared<const std::string>(std::move(suffix));
+  LOG(LogLevel::DEBUG, "SENDING: " << *sharedPrefix << *sharedSuffix);
   for (const auto* const info : subscriber)
   {
-    sessionManager_.sendToSession(info->notifyTo.Address, messageStr);
+    MESSAGEMODEL::Header header;
+    header.Action = notifyEnvelope.Header.Action;
+    header.MessageID = MESSAGEMODEL::Header::MessageIDType(MicroSDC::calculateMessageID());
+    header.To = info->notifyTo.Address;
+    if (info->notifyTo.ReferenceParameters.has_value() &&
+        info->notifyTo.ReferenceParameters->Identifier.has_value())
+    {
+      header.Identifier = info->notifyTo.ReferenceParameters->Identifier;
+      header.Identifier->IsReferenceParameter = true;
+    }
+    Notification notification{sharedPrefix, MessageSerializer::serializeHeader(header),
+                              sharedSuffix};
+    sessionManager_->sendToSession(info->notifyTo.Address, notification,
+                                   [deliveryFailed = deliveryFailed_](const SendResult& result) {
+                                     if (!result.delivered)
+                                     {
+                                       deliveryFailed->store(true);
+                                     }
+                                   });
+  }
+}
+
+void SubscriptionManager::handleDeliveryFailures()
+{
+  if (deliveryFailed_->exchange(false))
+  {
+    endExhaustedSubscriptions();
+  }
+}
+
+void SubscriptionManager::endExhaustedSubscriptions()
+{
+  std::vector<std::string> exhaustedSessions;
+  for (auto it = subscriptions_.begin(); it != subscriptions_.end();)
+  {
+    const auto& notifyTo = it->second.notifyTo.Address;
+    if (!sessionManager_->isExhausted(notifyTo))
+    {
+      ++it;
+      continue;
+    }
+    LOG(LogLevel::WARNING,
+        "Ending subscription " << it->first << " after repeated delivery failures");
+    queueSubscriptionEnd(it->first, it->second, MDPWS::WS_EVENTING_STATUS_DELIVERY_FAILURE);
+    // all subscriptions of the client end, its session was created once for all of them
+    if (std::find(exhaustedSessions.begin(), exhaustedSessions.end(), notifyTo) ==
+        exhaustedSessions.end())
+    {
+      exhaustedSessions.emplace_back(notifyTo);
+    }
+    it = subscriptions_.erase(it);
+  }
+  for (const auto& notifyTo : exhaustedSessions)
+  {
+    sessionManager_->deleteSession(notifyTo);
+  }
+  printSubscriptions();
+}
+
+void SubscriptionManager::queueSubscriptionEnd(const std::string& identifier,
+                                               const SubscriptionInformation& info,
+                                               const std::string& status)
+{
+  if (!info.endTo.has_value())
+  {
+    return;
+  }
+  MESSAGEMODEL::Envelope envelope;
+  envelope.Header.Action = WS::ADDRESSING::URIType(MDPWS::WS_ACTION_SUBSCRIPTION_END);
+  WS::ADDRESSING::EndpointReferenceType subscriptionManager(info.subscriptionManagerAddress);
+  subscriptionManager.ReferenceParameters =
+      WS::ADDRESSING::ReferenceParametersType(WS::EVENTING::Identifier{identifier});
+  envelope.Body.SubscriptionEnd = WS::EVENTING::SubscriptionEnd(subscriptionManager, status);
+
+  MessageSerializer serializer;
+  serializer.serialize(envelope);
+  auto [prefix, suffix] = serializer.strSplitAtHeader();
+
+  auto& header = envelope.Header;
+  header.MessageID = MESSAGEMODEL::Header::MessageIDType(MicroSDC::calculateMessageID());
+  header.To = info.endTo->Address;
+  if (info.endTo->ReferenceParameters.has_value() &&
+      info.endTo->ReferenceParameters->Identifier.has_value())
+  {
+    header.Identifier = info.endTo->ReferenceParameters->Identifier;
+    header.Identifier->IsReferenceParameter = true;
+  }
+  pendingSubscriptionEnds_.push_back(
+      {info.endTo->Address,
+       Notification{std::make_shared<const std::string>(std::move(prefix)),
+                    MessageSerializer::serializeHeader(header),
+                    std::make_shared<const std::string>(std::move(suffix))}});
+}
+
+void SubscriptionManager::sendSubscriptionEnds()
+{
+  std::vector<PendingSubscriptionEnd> subscriptionEnds;
+  {
+    std::lock_guard<std::mutex> lock(subscriptionMutex_);
+    subscriptionEnds.swap(pendingSubscriptionEnds_);
+  }
+  for (const auto& subscriptionEnd : subscriptionEnds)
+  {
+    LOG(LogLevel::INFO, "Sending SubscriptionEnd to " << subscriptionEnd.endTo);
+    // the subscription is gone already, so the outcome is of no interest. The completion holds
+    // the session, as releasing it aborts the request.
+    std::shared_ptr<ClientSessionInterface> session =
+        ClientSessionFactory::produce(subscriptionEnd.endTo, ioContext_);
+    session->sendAsync(subscriptionEnd.notification,
+                       [session](const SendResult& /*result*/) {});
   }
 }
 
@@ -155,3 +382,123 @@ void SubscriptionManager::printSubscriptions() const
   out << std::endl;
   LOG(LogLevel::DEBUG, out.str());
 }
+
+void SubscriptionManager::mergeReport(SubscriptionInformation& info,
+                                      const BICEPS::MM::EpisodicMetricReport& report)
+{
+  if (!info.pendingReport.has_value())
+  {
+    info.pendingReport = report;
+    return;
+  }
+  auto& pendingParts = info.pendingReport->ReportPart;
+  for (const auto& part : report.ReportPart)
+  {
+    for (const auto& state : part.MetricState)
+    {
+      for (auto& pendingPart : pendingParts)
+      {
+        auto& states = pendingPart.MetricState;
+        states.erase(std::remove_if(states.begin(), states.end(),
+                                    [&](const auto& pendingState) {
+                                      return pendingState->DescriptorHandle ==
+                                             state->DescriptorHandle;
+                                    }),
+                     states.end());
+      }
+    }
+  }
+  pendingParts.erase(std::remove_if(pendingParts.begin(), pendingParts.end(),
+                                    [](const auto& part) { return part.MetricState.empty(); }),
+                     pendingParts.end());
+  pendingParts.insert(pendingParts.end(), report.ReportPart.begin(), report.ReportPart.end());
+  info.pendingReport->MdibVersion = report.MdibVersion;
+}
+
+std::chrono::steady_clock::time_point SubscriptionManager::sendDueReports()
+{
+  const auto now = std::chrono::steady_clock::now();
+  auto nextDueTime = std::chrono::steady_clock::time_point::max();
+  for (auto& [id, info] : subscriptions_)
+  {
+    if (!info.pendingReport.has_value())
+    {
+      continue;
+    }
+    if (info.pendingDueTime > now)
+    {
+      nextDueTime = std::min(nextDueTime, info.pendingDueTime);
+      continue;
+    }
+    const auto pendingReport = std::move(info.pendingReport.value());
+    info.pendingReport.reset();
+    if (!sessionManager_->isAvailable(info.notifyTo.Address))
+    {
+      LOG(LogLevel::DEBUG, "Drop batched EpisodicMetricReport to backing off subscriber " << id);
+      continue;
+    }
+    LOG(LogLevel::DEBUG, "Send batched EpisodicMetricReport with "
+                             << pendingReport.ReportPart.size() << " parts to " << id);
+    sendReport({&info}, pendingReport);
+  }
+  handleDeliveryFailures();
+  return nextDueTime;
+}
+
+void SubscriptionManager::runBatchedDelivery()
+{
+  std::unique_lock<std::mutex> lock(subscriptionMutex_);
+  while (batchingRunning_)
+  {
+    const auto nextDueTime = sendDueReports();
+    if (!pendingSubscriptionEnds_.empty())
+    {
+      lock.unlock();
+      sendSubscriptionEnds();
+      lock.lock();
+      // reports may have been batched meanwhile
+      continue;
+    }
+    if (nextDueTime == std::chrono::steady_clock::time_point::max())
+    {
+      batchingCondition_.wait(lock);
+    }
+    else
+    {
+      batchingCondition_.wait_until(lock, nextDueTime);
+    }
+  }
+}
+
+void SubscriptionManager::scheduleBatchedDelivery(std::chrono::steady_clock::time_point dueTime)
+{
+  if (!batchingRunning_ || dueTime >= batchingTimerExpiry_)
+  {
+    return;
+  }
+  // re-arming aborts the wait for a later report, which is sent by this one instead
+  batchingTimerExpiry_ = dueTime;
+  batchingTimer_->expires_at(dueTime);
+  batchingTimer_->async_wait([this, guard = batchingGuard_](const std::error_code& ec) {
+    // the wait was aborted by re-arming the timer or destroying this manager
+    if (ec)
+    {
+      return;
+    }
+    std::lock_guard<std::mutex> guardLock(guard->mutex);
+    if (!guard->alive)
+    {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(subscriptionMutex_);
+      batchingTimerExpiry_ = std::chrono::steady_clock::time_point::max();
+      const auto nextDueTime = sendDueReports();
+      if (nextDueTime != std::chrono::steady_clock::time_point::max())
+      {
+        scheduleBatchedDelivery(nextDueTime);
+      }
+    }
+    sendSubscriptionEnds();
+  });
+}
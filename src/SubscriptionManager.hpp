@@ -2,29 +2,63 @@
 
 #include "SDCConstants.hpp"
 #include "SessionManager/SessionManager.hpp"
+#include "datamodel/BICEPS_MessageModel.hpp"
 #include "datamodel/ws-addressing.hpp"
 #include "datamodel/ws-eventing.hpp"
+#include <asio.hpp>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 #include <vector>
 
 struct esp_http_client;
-namespace BICEPS::MM
-{
-  class EpisodicMetricReport;
-} // namespace BICEPS::MM
 
 /// @brief SubscriptionManager manages subscriptions in terms of ws-eventing
 class SubscriptionManager
 {
 public:
+  /// chooses the batching window of a new subscription, e.g. by its NotifyTo address or filter
+  using BatchingPolicy =
+      std::function<std::chrono::milliseconds(const WS::EVENTING::Subscribe& subscribeRequest)>;
+
+  /// @brief constructs a new SubscriptionManager
+  /// @param batchingWindow the time window reports to a subscriber are collected in before they
+  /// are sent as a single merged report. A window of zero sends every report immediately. Applies
+  /// to subscriptions without a batching policy.
+  /// @param sessionManager the client sessions to deliver with, shared with the managers of other
+  /// devices notifying the same clients. A manager of its own is created if none is given.
+  /// @param ioContext the io context whose timer sends the batched reports and which
+  /// SubscriptionEnd messages are sent on, shared with other components. A thread of its own sends
+  /// the batched reports and the process wide client io context the SubscriptionEnds if none is
+  /// given.
+  /// @param batchingPolicy chooses the batching window of each subscription instead of the
+  /// batchingWindow, if given
+  explicit SubscriptionManager(
+      std::chrono::milliseconds batchingWindow = std::chrono::milliseconds{0},
+      std::shared_ptr<SessionManager> sessionManager = nullptr,
+      std::shared_ptr<asio::io_context> ioContext = nullptr,
+      BatchingPolicy batchingPolicy = nullptr);
+  SubscriptionManager(const SubscriptionManager&) = delete;
+  SubscriptionManager(SubscriptionManager&&) = delete;
+  SubscriptionManager& operator=(const SubscriptionManager&) = delete;
+  SubscriptionManager& operator=(SubscriptionManager&&) = delete;
+  ~SubscriptionManager();
+
   /// @brief dispatches a subscribe request, registers the new subscriber and creates a client
   /// session
   /// @param subscribeRequest the request the client send to subscribe
+  /// @param subscriptionManagerAddress the address of the service managing the subscription
   /// @return the response generated by processing the subscription request
-  WS::EVENTING::SubscribeResponse dispatch(const WS::EVENTING::Subscribe& subscribeRequest);
+  WS::EVENTING::SubscribeResponse
+  dispatch(const WS::EVENTING::Subscribe& subscribeRequest,
+           const WS::ADDRESSING::URIType& subscriptionManagerAddress);
 
   /// @brief dispatches a renew request and extends the duration of a subscription
   /// @param renewRequest the request the client send to renew
@@ -52,16 +86,70 @@ private:
     const WS::ADDRESSING::EndpointReferenceType notifyTo;
     /// the ws eventing filter of this subscripiton
     const WS::EVENTING::FilterType filter;
+    /// the address to send a SubscriptionEnd to if the subscription ends unexpectedly
+    const std::optional<WS::ADDRESSING::EndpointReferenceType> endTo;
+    /// the address of the service managing this subscription
+    const WS::ADDRESSING::URIType subscriptionManagerAddress;
     /// the time this subscription is valid for
     Duration::TimePoint expirationTime;
+    /// the time window reports are collected in before being sent as one report
+    const std::chrono::milliseconds batchingWindow;
+    /// the report merged from all reports collected in the current batching window
+    std::optional<BICEPS::MM::EpisodicMetricReport> pendingReport{};
+    /// the time the pending report is due to be sent
+    std::chrono::steady_clock::time_point pendingDueTime{};
   };
 
   /// mutex protecting subscriptions_ map
   mutable std::mutex subscriptionMutex_;
   /// active subscriptions of the subscriber with a unique identifier
   std::map<std::string, SubscriptionInformation> subscriptions_;
+  /// set by delivery completions when a delivery failed, so exhausted subscriptions are ended.
+  /// Shared with the completions, as sessions of a shared SessionManager may complete deliveries
+  /// after this manager was destroyed.
+  const std::shared_ptr<std::atomic_bool> deliveryFailed_{std::make_shared<std::atomic_bool>()};
+  /// the io context SubscriptionEnds are sent on, if shared with other components
+  const std::shared_ptr<asio::io_context> ioContext_;
   /// a pointer to the SessionManager implementation
-  SessionManager sessionManager_;
+  const std::shared_ptr<SessionManager> sessionManager_;
+  /// the batching window applied to new subscriptions without a batching policy
+  const std::chrono::milliseconds batchingWindow_;
+  /// chooses the batching window of new subscriptions, if set
+  const BatchingPolicy batchingPolicy_;
+  /// whether pending reports are sent by the batched delivery thread or timer
+  bool batchingRunning_{false};
+  /// notifies the batched delivery thread about new pending reports and shutdown
+  std::condition_variable batchingCondition_;
+  /// thread sending pending reports when their batching window elapsed, unless a timer on a shared
+  /// io context sends them
+  std::thread batchingThread_;
+
+  /// @brief BatchingGuard prevents the batching timer from calling into a destroyed manager
+  struct BatchingGuard
+  {
+    /// held while the timer handler runs
+    std::mutex mutex;
+    /// whether the manager still exists
+    bool alive{true};
+  };
+  /// guard shared with the handler of the batching timer
+  const std::shared_ptr<BatchingGuard> batchingGuard_{std::make_shared<BatchingGuard>()};
+  /// expires when the next pending report is due, if batching on a shared io context
+  std::optional<asio::steady_timer> batchingTimer_;
+  /// the time the batching timer is armed for, max if it is not armed
+  std::chrono::steady_clock::time_point batchingTimerExpiry_{
+      std::chrono::steady_clock::time_point::max()};
+  /// @brief PendingSubscriptionEnd holds a SubscriptionEnd to be sent after releasing
+  /// subscriptionMutex_
+  struct PendingSubscriptionEnd
+  {
+    /// the address of the EndTo endpoint
+    std::string endTo;
+    /// the serialized SubscriptionEnd
+    Notification notification;
+  };
+  /// SubscriptionEnds of ended subscriptions not sent yet, protected by subscriptionMutex_
+  std::vector<PendingSubscriptionEnd> pendingSubscriptionEnds_;
   /// all allowed subscriptions of this manager
   std::vector<std::string> allowedSubscriptionEventActions_{
       SDC::ACTION_OPERATION_INVOKED_REPORT,
@@ -76,4 +164,57 @@ private:
 
   /// @brief prints all current subscriptions to DEBUG Log
   void printSubscriptions() const;
+
+  /// @brief notifies the subscribers of a report or merges it into their batches.
+  /// subscriptionMutex_ has to be held.
+  /// @param report the report to notify about
+  void notifySubscribers(const BICEPS::MM::EpisodicMetricReport& report);
+
+  /// @brief serializes a report once and sends it to the given subscribers, each framed by its
+  /// own header. Subscribers with failing deliveries are served last. The deliveries run
+  /// concurrently, failures are recorded in deliveryFailed_ on completion.
+  /// @param subscriber the subscriptions to notify
+  /// @param report the report to send
+  void sendReport(std::vector<const SubscriptionInformation*> subscriber,
+                  const BICEPS::MM::EpisodicMetricReport& report);
+
+  /// @brief ends exhausted subscriptions if a delivery failed since the last call
+  void handleDeliveryFailures();
+
+  /// @brief removes all subscriptions whose client session exhausted its failure budget and
+  /// notifies their EndTo endpoints with a SubscriptionEnd
+  void endExhaustedSubscriptions();
+
+  /// @brief queues a SubscriptionEnd to the EndTo endpoint of a subscription if present.
+  /// subscriptionMutex_ has to be held.
+  /// @param identifier the identifier of the ending subscription
+  /// @param info the ending subscription
+  /// @param status the WS-Eventing status describing why the subscription ended
+  void queueSubscriptionEnd(const std::string& identifier, const SubscriptionInformation& info,
+                            const std::string& status);
+
+  /// @brief sends the queued SubscriptionEnds without waiting for their responses, so a dead
+  /// EndTo endpoint delays no other subscriber. subscriptionMutex_ must not be held.
+  void sendSubscriptionEnds();
+
+  /// @brief merges a report into the pending report of a subscription. Previous states of the
+  /// same descriptor handle are replaced by the latest state.
+  /// @param info the subscription to merge the report into
+  /// @param report the report to merge
+  static void mergeReport(SubscriptionInformation& info,
+                          const BICEPS::MM::EpisodicMetricReport& report);
+
+  /// @brief sends the pending reports of all subscriptions whose batching window elapsed.
+  /// subscriptionMutex_ has to be held.
+  /// @return the time the next pending report is due, max if none is pending
+  std::chrono::steady_clock::time_point sendDueReports();
+
+  /// @brief sends the pending reports of all subscriptions whose batching window elapsed until
+  /// the manager is destroyed
+  void runBatchedDelivery();
+
+  /// @brief arms the batching timer for a pending report unless it expires earlier already.
+  /// subscriptionMutex_ has to be held.
+  /// @param dueTime the time the report is due
+  void scheduleBatchedDelivery(std::chrono::steady_clock::time_point dueTime);
 };
@@ -0,0 +1,127 @@
+#include "AdmissionControl.hpp"
+#include "networking/NetworkConfig.hpp"
+#include <algorithm>
+
+AdmissionControl::Ticket::Ticket(AdmissionControl* admissionControl)
+  : admissionControl_(admissionControl)
+{
+}
+
+AdmissionControl::Ticket::Ticket(Ticket&& other) noexcept
+  : admissionControl_(other.admissionControl_)
+{
+  other.admissionControl_ = nullptr;
+}
+
+AdmissionControl::Ticket& AdmissionControl::Ticket::operator=(Ticket&& other) noexcept
+{
+  if (this != &other)
+  {
+    if (admissionControl_ != nullptr)
+    {
+      --admissionControl_->inFlight_;
+    }
+    admissionControl_ = other.admissionControl_;
+    other.admissionControl_ = nullptr;
+  }
+  return *this;
+}
+
+AdmissionControl::Ticket::~Ticket()
+{
+  if (admissionControl_ != nullptr)
+  {
+    --admissionControl_->inFlight_;
+  }
+}
+
+AdmissionControl::AdmissionControl(const NetworkConfig& networkConfig)
+  : maxRequestSize_(networkConfig.maxRequestSize())
+  , requestRate_(networkConfig.requestRate())
+  , requestBurst_(static_cast<double>(std::max<std::size_t>(networkConfig.requestBurst(), 1)))
+  , maxInFlight_(networkConfig.maxInFlightRequests())
+{
+}
+
+AdmissionControl::Decision AdmissionControl::admit(const std::string& client,
+                                                   std::size_t contentLength, Ticket& ticket)
+{
+  if (contentLength > maxRequestSize_)
+  {
+    ++tooLarge_;
+    return Decision::PAYLOAD_TOO_LARGE;
+  }
+  if (requestRate_ > 0 && !takeToken(client))
+  {
+    ++rateLimited_;
+    return Decision::TOO_MANY_REQUESTS;
+  }
+  if (const auto inFlight = ++inFlight_; maxInFlight_ > 0 && inFlight > maxInFlight_)
+  {
+    --inFlight_;
+    ++overloaded_;
+    return Decision::OVERLOADED;
+  }
+  ticket = Ticket(this);
+  return Decision::ADMITTED;
+}
+
+void AdmissionControl::rejectTooLarge()
+{
+  ++tooLarge_;
+}
+
+std::size_t AdmissionControl::maxRequestSize() const
+{
+  return maxRequestSize_;
+}
+
+AdmissionStatistics AdmissionControl::statistics() const
+{
+  AdmissionStatistics statistics;
+  statistics.tooLarge = tooLarge_.load();
+  statistics.rateLimited = rateLimited_.load();
+  statistics.overloaded = overloaded_.load();
+  return statistics;
+}
+
+bool AdmissionControl::takeToken(const std::string& client)
+{
+  const auto now = Clock::now();
+  std::lock_guard<std::mutex> lock(bucketsMutex_);
+  auto it = buckets_.find(client);
+  if (it == buckets_.end())
+  {
+    if (buckets_.size() >= MAX_TRACKED_CLIENTS)
+    {
+      dropFullBuckets(now);
+    }
+    it = buckets_.emplace(client, Bucket{requestBurst_, now}).first;
+  }
+  auto& bucket = it->second;
+  const std::chrono::duration<double> elapsed = now - bucket.lastRefill;
+  bucket.tokens = std::min(requestBurst_, bucket.tokens + elapsed.count() * requestRate_);
+  bucket.lastRefill = now;
+  if (bucket.tokens < 1.0)
+  {
+    return false;
+  }
+  bucket.tokens -= 1.0;
+  return true;
+}
+
+void AdmissionControl::dropFullBuckets(Clock::time_point now)
+{
+  for (auto it = buckets_.begin(); it != buckets_.end();)
+  {
+    const std::chrono::duration<double> elapsed = now - it->second.lastRefill;
+    if (it->second.tokens + elapsed.count() * requestRate_ >= requestBurst_)
+    {
+      it = buckets_.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+class NetworkConfig;
+
+/// @brief AdmissionStatistics holds the counters of requests rejected by AdmissionControl
+struct AdmissionStatistics
+{
+  /// requests rejected with 413 as their content exceeds the maximum request size
+  std::size_t tooLarge{0};
+  /// requests rejected with 429 as their client exceeded its request rate
+  std::size_t rateLimited{0};
+  /// requests rejected with 503 as too many requests were in flight
+  std::size_t overloaded{0};
+};
+
+/// @brief AdmissionControl decides whether a WebServer handles an incoming request before its
+/// content is parsed. It caps the size of requests, limits the request rate of each client by a
+/// token bucket and limits the number of requests handled at the same time.
+class AdmissionControl
+{
+public:
+  /// @brief the result of an admission
+  enum class Decision
+  {
+    ADMITTED,
+    PAYLOAD_TOO_LARGE,
+    TOO_MANY_REQUESTS,
+    OVERLOADED
+  };
+
+  /// @brief Ticket holds the in-flight slot of an admitted request until it is destroyed
+  class Ticket
+  {
+  public:
+    Ticket() = default;
+    Ticket(const Ticket&) = delete;
+    Ticket(Ticket&& other) noexcept;
+    Ticket& operator=(const Ticket&) = delete;
+    Ticket& operator=(Ticket&& other) noexcept;
+    ~Ticket();
+
+  private:
+    friend class AdmissionControl;
+    explicit Ticket(AdmissionControl* admissionControl);
+    /// the admission control to return the slot to, nullptr if this ticket holds no slot
+    AdmissionControl* admissionControl_{nullptr};
+  };
+
+  /// @brief constructs the admission control with the limits of a given configuration
+  /// @param networkConfig the configuration holding the request limits
+  explicit AdmissionControl(const NetworkConfig& networkConfig);
+
+  /// @brief decides whether to handle a request. This does not inspect the request content.
+  /// @param client the address identifying the client sending the request
+  /// @param contentLength the length of the request content
+  /// @param[out] ticket holds the in-flight slot of the request if admitted
+  /// @return whether the request is admitted or the reason to reject it
+  Decision admit(const std::string& client, std::size_t contentLength, Ticket& ticket);
+
+  /// @brief counts a request the transport rejected as too large before its admission
+  void rejectTooLarge();
+
+  /// @brief gets the maximum size of a request content
+  /// @return the maximum request size in bytes
+  std::size_t maxRequestSize() const;
+
+  /// @brief gets the counters of rejected requests
+  /// @return a snapshot of the statistics
+  AdmissionStatistics statistics() const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  /// @brief the token bucket of a client
+  struct Bucket
+  {
+    /// the tokens available to the client
+    double tokens;
+    /// the time the tokens were last refilled
+    Clock::time_point lastRefill;
+  };
+
+  /// the maximum number of clients tracked before full buckets are dropped
+  static constexpr std::size_t MAX_TRACKED_CLIENTS = 256;
+
+  /// the maximum size of a request content
+  const std::size_t maxRequestSize_;
+  /// the tokens a client gains per second, zero if rates are not limited
+  const double requestRate_;
+  /// the maximum number of tokens of a client
+  const double requestBurst_;
+  /// the maximum number of requests in flight, zero if unlimited
+  const std::size_t maxInFlight_;
+  /// the number of admitted requests whose ticket is not yet destroyed
+  std::atomic<std::size_t> inFlight_{0};
+  /// protects buckets_
+  std::mutex bucketsMutex_;
+  /// token buckets by client
+  std::unordered_map<std::string, Bucket> buckets_;
+  /// number of requests rejected as too large
+  std::atomic<std::size_t> tooLarge_{0};
+  /// number of requests rejected as rate limited
+  std::atomic<std::size_t> rateLimited_{0};
+  /// number of requests rejected as overloaded
+  std::atomic<std::size_t> overloaded_{0};
+
+  /// @brief takes a token from the bucket of a client
+  /// @param client the client sending a request
+  /// @return whether the client had a token left
+  bool takeToken(const std::string& client);
+
+  /// @brief drops the buckets of clients which refilled completely
+  /// @param now the current time
+  void dropFullBuckets(Clock::time_point now);
+};
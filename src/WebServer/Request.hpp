@@ -12,9 +12,10 @@ namespace MESSAGEMODEL
 class Request
 {
 public:
-  /// @brief consturcts a new request based on a given message
-  /// @param message the raw HTTP message content
-  explicit Request(std::string msg);
+  /// @brief consturcts a new request based on a given message. The message is parsed in place, so
+  /// the implementing class has to keep it alive as long as the request.
+  /// @param message the raw null-terminated HTTP message content
+  explicit Request(char* message);
   Request(const Request&) = delete;
   Request(Request&&) = delete;
   Request& operator=(const Request&) = delete;
@@ -32,11 +33,20 @@ public:
   const char* data() const;
 
 
-  /// @brief send a SOAP envelope as response to the requesting client
+  /// @brief detaches this request from the web server thread handling it, so it can be responded to
+  /// after the handler returned. Has to be called by the handler before it returns.
+  /// @return whether the port supports responding later. If not, the handler has to respond
+  /// before it returns.
+  virtual bool defer();
+
+
+  /// @brief send a SOAP envelope as response to the requesting client. May be called from any
+  /// thread, the port hands the response to the thread owning the connection.
   /// @param responseEnvelope the SOAP envelope to send
   void respond(const MESSAGEMODEL::Envelope& responseEnvelope) const;
 
-  /// @brief sends an actual response string to the requesting client
+  /// @brief sends an actual response string to the requesting client. May be called from any
+  /// thread.
   /// @param msg the string to send
   virtual void respond(const std::string& msg) const;
 
@@ -51,6 +61,6 @@ private:
 
   /// contains the parsed envelope of this request
   std::shared_ptr<MESSAGEMODEL::Envelope> envelope_{nullptr};
-  /// the raw message string
-  std::string message_;
+  /// the raw message, owned by the implementing class
+  char* message_;
 };
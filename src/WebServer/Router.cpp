@@ -0,0 +1,24 @@
+#include "Router.hpp"
+#include "services/ServiceInterface.hpp"
+#include <stdexcept>
+
+void Router::addService(std::shared_ptr<ServiceInterface> service)
+{
+  auto path = service->getURI();
+  if (routes_.count(path) != 0)
+  {
+    throw std::runtime_error("A service is already registered at path " + path);
+  }
+  const auto& storedPath = paths_.emplace_back(std::move(path));
+  routes_.emplace(storedPath, std::move(service));
+}
+
+std::shared_ptr<ServiceInterface> Router::route(std::string_view path) const
+{
+  if (const auto queryPos = path.find('?'); queryPos != std::string_view::npos)
+  {
+    path = path.substr(0, queryPos);
+  }
+  const auto routeIt = routes_.find(path);
+  return routeIt != routes_.end() ? routeIt->second : nullptr;
+}
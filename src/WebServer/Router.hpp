@@ -0,0 +1,31 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+class ServiceInterface;
+
+/// @brief Router maps request paths to the services registered at a WebServer. The paths are
+/// computed once when a service is added and looked up by exact match in a hash map. Routes have
+/// to be added before the WebServer is started, lookups are safe to be done concurrently.
+class Router
+{
+public:
+  /// @brief registers a service at the path returned by its getURI()
+  /// @param service the service to add
+  void addService(std::shared_ptr<ServiceInterface> service);
+
+  /// @brief finds the service registered at a given path. A query string is ignored.
+  /// @param path the path of a request
+  /// @return the service registered at the path or nullptr if there is none
+  std::shared_ptr<ServiceInterface> route(std::string_view path) const;
+
+private:
+  /// the registered paths. The route keys refer to them, a deque keeps them at stable addresses
+  std::deque<std::string> paths_;
+  /// services by their path
+  std::unordered_map<std::string_view, std::shared_ptr<ServiceInterface>> routes_;
+};
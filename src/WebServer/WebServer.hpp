@@ -1,9 +1,31 @@
 #pragma once
 
+#include "AdmissionControl.hpp"
+#include <asio.hpp>
+#include <cstddef>
 #include <memory>
 
 class ServiceInterface;
 
+/// @brief WebServerStatistics holds counters describing the connections a WebServer handled
+struct WebServerStatistics
+{
+  /// TLS handshakes negotiating a new session
+  std::size_t fullHandshakes{0};
+  /// TLS handshakes resuming a cached session or a session ticket
+  std::size_t resumedHandshakes{0};
+  /// connections currently open
+  std::size_t openConnections{0};
+  /// open connections waiting for their next request
+  std::size_t idleConnections{0};
+  /// idle connections closed to accept a connection beyond the connection limit
+  std::size_t evictedConnections{0};
+  /// connections closed right after accepting them, as no connection was idle to evict
+  std::size_t rejectedConnections{0};
+  /// requests rejected before handling them
+  AdmissionStatistics rejectedRequests;
+};
+
 /// @brief WebServerInterface defines an interface to a WebServer handling HTTP(s) requests and
 /// disptaching them to the respective registered services
 class WebServerInterface
@@ -21,6 +43,10 @@ public:
   /// @brief adds a service to the handlers
   /// @param service a pointer to the service to add
   virtual void addService(std::shared_ptr<ServiceInterface> service) = 0;
+
+  /// @brief gets the counters of this WebServer
+  /// @return a snapshot of the statistics
+  virtual WebServerStatistics statistics() const = 0;
 };
 
 class NetworkConfig;
@@ -28,5 +54,12 @@ class NetworkConfig;
 class WebServerFactory
 {
 public:
-  static std::unique_ptr<WebServerInterface> produce(const std::shared_ptr<const NetworkConfig>& networkConfig);
+  /// @brief creates the WebServer of the platform
+  /// @param networkConfig the network configuration of the server
+  /// @param ioContext the io context to serve on, shared with other components. The server runs
+  /// threads of its own if none is given. Ports not based on asio ignore it.
+  /// @return the created WebServer
+  static std::unique_ptr<WebServerInterface>
+  produce(const std::shared_ptr<const NetworkConfig>& networkConfig,
+          std::shared_ptr<asio::io_context> ioContext = nullptr);
 };
@@ -28,6 +28,11 @@ namespace BICEPS::MM
   {
   }
 
+  WaveformStream::WaveformStream(const SequenceIdType& sequenceId)
+    : AbstractReport(sequenceId)
+  {
+  }
+
   SetValue::SetValue(const rapidxml::xml_node<>& node)
   {
     this->parse(node);
@@ -87,6 +87,15 @@ namespace BICEPS::MM
     explicit EpisodicMetricReport(const SequenceIdType& sequenceId);
   };
 
+  struct WaveformStream : public AbstractReport
+  {
+    using StateType = std::shared_ptr<const ::BICEPS::PM::RealTimeSampleArrayMetricState>;
+    using StateSequence = std::vector<StateType>;
+    StateSequence State;
+
+    explicit WaveformStream(const SequenceIdType& sequenceId);
+  };
+
   struct OperationHandleRef : public std::string
   {
     using std::string::string;
@@ -132,6 +132,22 @@ namespace BICEPS::PM
     return other->getKind() == DescriptorKind::NUMERIC_METRIC_DESCRIPTOR;
   }
 
+  RealTimeSampleArrayMetricDescriptor::RealTimeSampleArrayMetricDescriptor(
+      const HandleType& handle, const UnitType& unit, const MetricCategoryType& metricCategory,
+      const MetricAvailabilityType& metricAvailability, const ResolutionType& resolution,
+      SamplePeriodType samplePeriod)
+    : AbstractMetricDescriptor(DescriptorKind::REAL_TIME_SAMPLE_ARRAY_METRIC_DESCRIPTOR, handle,
+                               unit, metricCategory, metricAvailability)
+    , Resolution(resolution)
+    , SamplePeriod(std::move(samplePeriod))
+  {
+  }
+
+  bool RealTimeSampleArrayMetricDescriptor::classof(const AbstractDescriptor* other)
+  {
+    return other->getKind() == DescriptorKind::REAL_TIME_SAMPLE_ARRAY_METRIC_DESCRIPTOR;
+  }
+
   ChannelDescriptor::ChannelDescriptor(const HandleType& handle)
     : AbstractDeviceComponentDescriptor(DescriptorKind::CHANNEL_DESCRIPTOR, handle)
   {
@@ -212,6 +228,16 @@ namespace BICEPS::PM
     return other->getKind() == MetricKind::NUMERIC_METRIC;
   }
 
+  SampleArrayValue::SampleArrayValue(const MetricQualityType& metricQuality)
+    : AbstractMetricValue(MetricKind::SAMPLE_ARRAY_METRIC, metricQuality)
+  {
+  }
+
+  bool SampleArrayValue::classof(const AbstractMetricValue* other)
+  {
+    return other->getKind() == MetricKind::SAMPLE_ARRAY_METRIC;
+  }
+
   AbstractState::AbstractState(const StateKind kind, DescriptorHandleType handle)
     : kind_(kind)
     , DescriptorHandle(std::move(handle))
@@ -305,6 +331,16 @@ namespace BICEPS::PM
     return other->getKind() == StateKind::NUMERIC_METRIC_STATE;
   }
 
+  RealTimeSampleArrayMetricState::RealTimeSampleArrayMetricState(DescriptorHandleType handle)
+    : AbstractMetricState(StateKind::REAL_TIME_SAMPLE_ARRAY_METRIC_STATE, std::move(handle))
+  {
+  }
+
+  bool RealTimeSampleArrayMetricState::classof(const AbstractState* other)
+  {
+    return other->getKind() == StateKind::REAL_TIME_SAMPLE_ARRAY_METRIC_STATE;
+  }
+
   Mdib::Mdib(SequenceIdType sequenceIdType)
     : SequenceId(std::move(sequenceIdType))
   {
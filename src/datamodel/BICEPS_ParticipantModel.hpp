@@ -83,6 +83,7 @@ namespace BICEPS::PM
     {
       METRIC_DESCRIPTOR,
       NUMERIC_METRIC_DESCRIPTOR,
+      REAL_TIME_SAMPLE_ARRAY_METRIC_DESCRIPTOR,
       LAST_METRIC_DESCRIPTOR,
 
       OPERATION_DESCRIPTOR,
@@ -352,6 +353,31 @@ namespace BICEPS::PM
     ~NumericMetricDescriptor() override = default;
   };
 
+  struct RealTimeSampleArrayMetricDescriptor : public AbstractMetricDescriptor
+  {
+    using TechnicalRangeType = Range;
+    using TechnicalRangeSequence = std::vector<TechnicalRangeType>;
+    TechnicalRangeSequence TechnicalRange;
+
+    using ResolutionType = int;
+    ResolutionType Resolution;
+
+    using SamplePeriodType = std::string;
+    SamplePeriodType SamplePeriod;
+
+    static bool classof(const AbstractDescriptor* other);
+
+    RealTimeSampleArrayMetricDescriptor(const HandleType&, const UnitType&,
+                                        const MetricCategoryType&, const MetricAvailabilityType&,
+                                        const ResolutionType&, SamplePeriodType);
+    RealTimeSampleArrayMetricDescriptor(const RealTimeSampleArrayMetricDescriptor&) = default;
+    RealTimeSampleArrayMetricDescriptor(RealTimeSampleArrayMetricDescriptor&&) = default;
+    RealTimeSampleArrayMetricDescriptor&
+    operator=(const RealTimeSampleArrayMetricDescriptor&) = default;
+    RealTimeSampleArrayMetricDescriptor& operator=(RealTimeSampleArrayMetricDescriptor&&) = default;
+    ~RealTimeSampleArrayMetricDescriptor() override = default;
+  };
+
   struct ChannelDescriptor : public AbstractDeviceComponentDescriptor
   {
     using MetricType = std::shared_ptr<AbstractMetricDescriptor>;
@@ -463,6 +489,7 @@ namespace BICEPS::PM
 
       METRIC_STATE,
       NUMERIC_METRIC_STATE,
+      REAL_TIME_SAMPLE_ARRAY_METRIC_STATE,
       LAST_METRIC_STATE,
     };
     StateKind getKind() const;
@@ -647,6 +674,7 @@ namespace BICEPS::PM
     enum class MetricKind
     {
       NUMERIC_METRIC,
+      SAMPLE_ARRAY_METRIC,
     };
     MetricKind getKind() const;
 
@@ -696,6 +724,22 @@ namespace BICEPS::PM
     ~NumericMetricValue() override = default;
   };
 
+  struct SampleArrayValue : public AbstractMetricValue
+  {
+    using SamplesType = std::vector<double>;
+    using SamplesOptional = std::optional<SamplesType>;
+    SamplesOptional Samples;
+
+    static bool classof(const AbstractMetricValue* other);
+
+    explicit SampleArrayValue(const MetricQualityType& metricQuality);
+    SampleArrayValue(const SampleArrayValue&) = default;
+    SampleArrayValue(SampleArrayValue&&) = default;
+    SampleArrayValue& operator=(const SampleArrayValue&) = default;
+    SampleArrayValue& operator=(SampleArrayValue&&) = default;
+    ~SampleArrayValue() override = default;
+  };
+
   struct AbstractMetricState : public AbstractState
   {
     using ActivationStateType = ComponentActivation;
@@ -738,6 +782,26 @@ namespace BICEPS::PM
     ~NumericMetricState() override = default;
   };
 
+  struct RealTimeSampleArrayMetricState : public AbstractMetricState
+  {
+    using MetricValueType = SampleArrayValue;
+    using MetricValueOptional = std::optional<MetricValueType>;
+    MetricValueOptional MetricValue;
+
+    using PhysiologicalRangeType = Range;
+    using PhysiologicalRangeSequence = std::vector<PhysiologicalRangeType>;
+    PhysiologicalRangeSequence PhysiologicalRange;
+
+    static bool classof(const AbstractState* other);
+
+    explicit RealTimeSampleArrayMetricState(DescriptorHandleType handle);
+    RealTimeSampleArrayMetricState(const RealTimeSampleArrayMetricState&) = default;
+    RealTimeSampleArrayMetricState(RealTimeSampleArrayMetricState&&) = default;
+    RealTimeSampleArrayMetricState& operator=(const RealTimeSampleArrayMetricState&) = default;
+    RealTimeSampleArrayMetricState& operator=(RealTimeSampleArrayMetricState&&) = default;
+    ~RealTimeSampleArrayMetricState() override = default;
+  };
+
   struct MdState
   {
     using StateType = std::shared_ptr<AbstractState>;
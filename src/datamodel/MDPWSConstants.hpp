@@ -79,6 +79,13 @@ namespace MDPWS
   MDPWSConstant WS_ACTION_PROBE_MATCHES =
       "http://docs.oasis-open.org/ws-dd/ns/discovery/2009/01/ProbeMatches";
 
+  MDPWSConstant WS_DISCOVERY_MATCH_BY_RFC3986 =
+      "http://docs.oasis-open.org/ws-dd/ns/discovery/2009/01/rfc3986";
+  MDPWSConstant WS_DISCOVERY_MATCH_BY_STRCMP0 =
+      "http://docs.oasis-open.org/ws-dd/ns/discovery/2009/01/strcmp0";
+  MDPWSConstant WS_DISCOVERY_MATCH_BY_NONE =
+      "http://docs.oasis-open.org/ws-dd/ns/discovery/2009/01/none";
+
   MDPWSConstant WS_ACTION_SUBSCRIBE = "http://schemas.xmlsoap.org/ws/2004/08/eventing/Subscribe";
   MDPWSConstant WS_ACTION_SUBSCRIBE_RESPONSE =
       "http://schemas.xmlsoap.org/ws/2004/08/eventing/SubscribeResponse";
@@ -89,11 +96,15 @@ namespace MDPWS
       "http://schemas.xmlsoap.org/ws/2004/08/eventing/Unsubscribe";
   MDPWSConstant WS_ACTION_UNSUBSCRIBE_RESPONSE =
       "http://schemas.xmlsoap.org/ws/2004/08/eventing/UnsubscribeResponse";
+  MDPWSConstant WS_ACTION_SUBSCRIPTION_END =
+      "http://schemas.xmlsoap.org/ws/2004/08/eventing/SubscriptionEnd";
   MDPWSConstant WS_ACTION_GETSTATUS = "http://schemas.xmlsoap.org/ws/2004/08/eventing/GetStatus";
   MDPWSConstant WS_ACTION_GETSTATUS_RESPONSE =
       "http://schemas.xmlsoap.org/ws/2004/08/eventing/GetStatusResponse";
 
   MDPWSConstant WS_DISCOVERY_URN = "urn:docs-oasis-open-org:ws-dd:ns:discovery:2009:01";
+  // local name of the type of a discovery proxy in the WS_NS_DISCOVERY namespace
+  MDPWSConstant WS_DISCOVERY_PROXY_TYPE = "DiscoveryProxy";
 
   MDPWSConstant WS_MEX_DIALECT_MODEL = "http://docs.oasis-open.org/ws-dd/ns/dpws/2009/01/ThisModel";
   MDPWSConstant WS_MEX_DIALECT_DEVICE =
@@ -103,9 +114,15 @@ namespace MDPWS
   MDPWSConstant WS_MEX_DIALECT_REL =
       "http://docs.oasis-open.org/ws-dd/ns/dpws/2009/01/Relationship";
   MDPWSConstant WS_MEX_REL_HOST = "http://docs.oasis-open.org/ws-dd/ns/dpws/2009/01/host";
+  MDPWSConstant WS_MEX_DIALECT_STREAM =
+      "http://standards.ieee.org/downloads/11073/11073-20702-2016/StreamDescriptions";
+
+  MDPWSConstant SOAP_OVER_UDP_SCHEME = "soap.udp://";
 
   MDPWSConstant WS_EVENTING_DELIVERYMODE_PUSH =
       "http://schemas.xmlsoap.org/ws/2004/08/eventing/DeliveryModes/Push";
+  MDPWSConstant WS_EVENTING_STATUS_DELIVERY_FAILURE =
+      "http://schemas.xmlsoap.org/ws/2004/08/eventing/DeliveryFailure";
   MDPWSConstant WS_EVENTING_FILTER_ACTION =
       "http://docs.oasis-open.org/ws-dd/ns/dpws/2009/01/Action";
 
@@ -58,7 +58,7 @@ namespace MESSAGEMODEL
       else if (strncmp(entry->name(), "RelatesTo", entry->name_size()) == 0 &&
                strncmp(entry->xmlns(), MDPWS::WS_NS_ADDRESSING, entry->xmlns_size()) == 0)
       {
-        // RelatesTo
+        RelatesTo = std::make_optional<RelatesToType>(WS::ADDRESSING::URIType(*entry));
       }
       else if (strncmp(entry->name(), "ReplyTo", entry->name_size()) == 0 &&
                strncmp(entry->xmlns(), MDPWS::WS_NS_ADDRESSING, entry->xmlns_size()) == 0)
@@ -104,6 +104,26 @@ namespace MESSAGEMODEL
     {
       Resolve = std::make_optional<ResolveType>(*bodyContent);
     }
+    else if (strncmp(bodyContent->name(), "ProbeMatches", bodyContent->name_size()) == 0 &&
+             strncmp(bodyContent->xmlns(), MDPWS::WS_NS_DISCOVERY, bodyContent->xmlns_size()) == 0)
+    {
+      ProbeMatches = std::make_optional<ProbeMatchesType>(*bodyContent);
+    }
+    else if (strncmp(bodyContent->name(), "ResolveMatches", bodyContent->name_size()) == 0 &&
+             strncmp(bodyContent->xmlns(), MDPWS::WS_NS_DISCOVERY, bodyContent->xmlns_size()) == 0)
+    {
+      ResolveMatches = std::make_optional<ResolveMatchesType>(*bodyContent);
+    }
+    else if (strncmp(bodyContent->name(), "Hello", bodyContent->name_size()) == 0 &&
+             strncmp(bodyContent->xmlns(), MDPWS::WS_NS_DISCOVERY, bodyContent->xmlns_size()) == 0)
+    {
+      Hello = std::make_optional<HelloType>(*bodyContent);
+    }
+    else if (strncmp(bodyContent->name(), "Bye", bodyContent->name_size()) == 0 &&
+             strncmp(bodyContent->xmlns(), MDPWS::WS_NS_DISCOVERY, bodyContent->xmlns_size()) == 0)
+    {
+      Bye = std::make_optional<ByeType>(*bodyContent);
+    }
     else if (strncmp(bodyContent->name(), "GetMetadata", bodyContent->name_size()) == 0 &&
              strncmp(bodyContent->xmlns(), MDPWS::WS_NS_METADATA_EXCHANGE,
                      bodyContent->xmlns_size()) == 0)
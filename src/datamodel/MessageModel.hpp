@@ -122,6 +122,10 @@ namespace MESSAGEMODEL
     using RenewResponseOptional = std::optional<RenewResponseType>;
     RenewResponseOptional RenewResponse;
 
+    using SubscriptionEndType = WS::EVENTING::SubscriptionEnd;
+    using SubscriptionEndOptional = std::optional<SubscriptionEndType>;
+    SubscriptionEndOptional SubscriptionEnd;
+
     using UnsubscribeType = WS::EVENTING::Unsubscribe;
     using UnsubscribeOptional = std::optional<UnsubscribeType>;
     UnsubscribeOptional Unsubscribe;
@@ -138,6 +142,10 @@ namespace MESSAGEMODEL
     using EpisodicMetricReportOptional = std::optional<EpisodicMetricReportType>;
     EpisodicMetricReportOptional EpisodicMetricReport;
 
+    using WaveformStreamType = BICEPS::MM::WaveformStream;
+    using WaveformStreamOptional = std::optional<WaveformStreamType>;
+    WaveformStreamOptional WaveformStream;
+
   private:
     void parse(const rapidxml::xml_node<>& node);
   };
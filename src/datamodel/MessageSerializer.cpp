@@ -2,6 +2,39 @@
 #include "Casting.hpp"
 #include "datamodel/MDPWSConstants.hpp"
 #include "rapidxml_print.hpp"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace
+{
+  /// @brief a namespace declared on every serialized envelope
+  struct DeclaredNamespace
+  {
+    /// the name of the declaring attribute
+    const char* attributeName;
+    /// the prefix bound to the namespace
+    const char* prefix;
+    /// the namespace URI
+    const char* uri;
+  };
+
+  /// the namespaces declared on every serialized envelope
+  constexpr std::array<DeclaredNamespace, 12> ENVELOPE_NAMESPACES{{
+      {"xmlns:soap", "soap", MDPWS::WS_NS_SOAP_ENVELOPE},
+      {"xmlns:wsd", "wsd", MDPWS::WS_NS_DISCOVERY},
+      {"xmlns:wsa", "wsa", MDPWS::WS_NS_ADDRESSING},
+      {"xmlns:wse", "wse", MDPWS::WS_NS_EVENTING},
+      {"xmlns:dpws", "dpws", MDPWS::WS_NS_DPWS},
+      {"xmlns:mdpws", "mdpws", MDPWS::NS_MDPWS},
+      {"xmlns:mex", "mex", MDPWS::WS_NS_METADATA_EXCHANGE},
+      {"xmlns:glue", "glue", SDC::NS_GLUE},
+      {"xmlns:mm", "mm", SDC::NS_BICEPS_MESSAGE_MODEL},
+      {"xmlns:pm", "pm", SDC::NS_BICEPS_PARTICIPANT_MODEL},
+      {"xmlns:ext", "ext", SDC::NS_BICEPS_EXTENSION},
+      {"xmlns:xsi", "xsi", MDPWS::WS_NS_WSDL_XML_SCHEMA_INSTANCE},
+  }};
+} // namespace
 
 MessageSerializer::MessageSerializer()
   : xmlDocument_(std::make_unique<rapidxml::xml_document<>>())
@@ -21,6 +54,48 @@ std::string MessageSerializer::str() const
   return out;
 }
 
+std::pair<std::string, std::string> MessageSerializer::strSplitAtHeader() const
+{
+  const auto* envelopeNode = xmlDocument_->first_node("soap:Envelope");
+  const auto* headerNode =
+      envelopeNode != nullptr ? envelopeNode->first_node("soap:Header") : nullptr;
+  if (headerNode == nullptr)
+  {
+    throw std::runtime_error("Cannot split serialized message without soap:Header!");
+  }
+  // print the nodes around the header directly, so the rest of the message is printed once
+  constexpr int flags = rapidxml::print_no_indenting;
+  const auto printSiblings = [](std::string& out, const rapidxml::xml_node<>* first,
+                                const rapidxml::xml_node<>* last) {
+    for (const auto* node = first; node != last; node = node->next_sibling())
+    {
+      rapidxml::internal::print_node(std::back_inserter(out), node, flags, 0);
+    }
+  };
+  std::string prefix;
+  printSiblings(prefix, xmlDocument_->first_node(), envelopeNode);
+  prefix.append("<").append(envelopeNode->name(), envelopeNode->name_size());
+  rapidxml::internal::print_attributes(std::back_inserter(prefix), envelopeNode, flags);
+  prefix.append(">");
+  printSiblings(prefix, envelopeNode->first_node(), headerNode);
+
+  std::string suffix;
+  printSiblings(suffix, headerNode->next_sibling(), nullptr);
+  suffix.append("</").append(envelopeNode->name(), envelopeNode->name_size()).append(">");
+  printSiblings(suffix, envelopeNode->next_sibling(), nullptr);
+  return {std::move(prefix), std::move(suffix)};
+}
+
+std::string MessageSerializer::serializeHeader(const MESSAGEMODEL::Header& header)
+{
+  MessageSerializer serializer;
+  auto* root = serializer.xmlDocument_->allocate_node(rapidxml::node_element, "root");
+  serializer.serialize(root, header);
+  std::string out;
+  rapidxml::print(std::back_inserter(out), *root->first_node(), rapidxml::print_no_indenting);
+  return out;
+}
+
 void MessageSerializer::serialize(const MESSAGEMODEL::Envelope& message)
 {
   serialize(&*xmlDocument_, message);
@@ -31,32 +106,10 @@ void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
 {
   auto* envelope = xmlDocument_->allocate_node(rapidxml::node_element, "soap:Envelope");
 
-  auto* xmlnsSoap = xmlDocument_->allocate_attribute("xmlns:soap", MDPWS::WS_NS_SOAP_ENVELOPE);
-  auto* xmlnsWsd = xmlDocument_->allocate_attribute("xmlns:wsd", MDPWS::WS_NS_DISCOVERY);
-  auto* xmlnsWsa = xmlDocument_->allocate_attribute("xmlns:wsa", MDPWS::WS_NS_ADDRESSING);
-  auto* xmlnsWse = xmlDocument_->allocate_attribute("xmlns:wse", MDPWS::WS_NS_EVENTING);
-  auto* xmlnsDpws = xmlDocument_->allocate_attribute("xmlns:dpws", MDPWS::WS_NS_DPWS);
-  auto* xmlnsMdpws = xmlDocument_->allocate_attribute("xmlns:mdpws", MDPWS::NS_MDPWS);
-  auto* xmlnsMex = xmlDocument_->allocate_attribute("xmlns:mex", MDPWS::WS_NS_METADATA_EXCHANGE);
-  auto* xmlnsGlue = xmlDocument_->allocate_attribute("xmlns:glue", SDC::NS_GLUE);
-  auto* xmlnsMm = xmlDocument_->allocate_attribute("xmlns:mm", SDC::NS_BICEPS_MESSAGE_MODEL);
-  auto* xmlnsPm = xmlDocument_->allocate_attribute("xmlns:pm", SDC::NS_BICEPS_PARTICIPANT_MODEL);
-  auto* xmlnsExt = xmlDocument_->allocate_attribute("xmlns:ext", SDC::NS_BICEPS_EXTENSION);
-  auto* xmlnsXsi =
-      xmlDocument_->allocate_attribute("xmlns:xsi", MDPWS::WS_NS_WSDL_XML_SCHEMA_INSTANCE);
-
-  envelope->append_attribute(xmlnsSoap);
-  envelope->append_attribute(xmlnsWsd);
-  envelope->append_attribute(xmlnsWsa);
-  envelope->append_attribute(xmlnsWse);
-  envelope->append_attribute(xmlnsDpws);
-  envelope->append_attribute(xmlnsMdpws);
-  envelope->append_attribute(xmlnsMex);
-  envelope->append_attribute(xmlnsGlue);
-  envelope->append_attribute(xmlnsMm);
-  envelope->append_attribute(xmlnsPm);
-  envelope->append_attribute(xmlnsExt);
-  envelope->append_attribute(xmlnsXsi);
+  for (const auto& [attributeName, prefix, uri] : ENVELOPE_NAMESPACES)
+  {
+    envelope->append_attribute(xmlDocument_->allocate_attribute(attributeName, uri));
+  }
 
   serialize(envelope, message.Header);
   serialize(envelope, message.Body);
@@ -92,6 +145,18 @@ void MessageSerializer::serialize(rapidxml::xml_node<>* parent, const MESSAGEMOD
   {
     serialize(headerNode, header.RelatesTo.value());
   }
+  if (header.Identifier.has_value())
+  {
+    auto* identifierNode = xmlDocument_->allocate_node(rapidxml::node_element, "wse:Identifier");
+    identifierNode->value(header.Identifier->c_str());
+    if (header.Identifier->IsReferenceParameter.value_or(false))
+    {
+      auto* isReferenceParameterAttr =
+          xmlDocument_->allocate_attribute("wsa:IsReferenceParameter", "true");
+      identifierNode->append_attribute(isReferenceParameterAttr);
+    }
+    headerNode->append_node(identifierNode);
+  }
   parent->append_node(headerNode);
 }
 
@@ -106,10 +171,18 @@ void MessageSerializer::serialize(rapidxml::xml_node<>* parent, const MESSAGEMOD
   {
     serialize(bodyNode, body.Bye.value());
   }
+  else if (body.Probe.has_value())
+  {
+    serialize(bodyNode, body.Probe.value());
+  }
   else if (body.ProbeMatches.has_value())
   {
     serialize(bodyNode, body.ProbeMatches.value());
   }
+  else if (body.Resolve.has_value())
+  {
+    serialize(bodyNode, body.Resolve.value());
+  }
   else if (body.ResolveMatches.has_value())
   {
     serialize(bodyNode, body.ResolveMatches.value());
@@ -130,10 +203,18 @@ void MessageSerializer::serialize(rapidxml::xml_node<>* parent, const MESSAGEMOD
   {
     serialize(bodyNode, body.RenewResponse.value());
   }
+  else if (body.SubscriptionEnd.has_value())
+  {
+    serialize(bodyNode, body.SubscriptionEnd.value());
+  }
   else if (body.EpisodicMetricReport.has_value())
   {
     serialize(bodyNode, body.EpisodicMetricReport.value());
   }
+  else if (body.WaveformStream.has_value())
+  {
+    serialize(bodyNode, body.WaveformStream.value());
+  }
   else if (body.SetValueResponse.has_value())
   {
     serialize(bodyNode, body.SetValueResponse.value());
@@ -144,7 +225,7 @@ void MessageSerializer::serialize(rapidxml::xml_node<>* parent, const MESSAGEMOD
 void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
                                   const WS::ADDRESSING::RelatesToType& relatesTo)
 {
-  auto* relatesToNode = xmlDocument_->allocate_node(rapidxml::node_element, "mdpws:RelatesTo");
+  auto* relatesToNode = xmlDocument_->allocate_node(rapidxml::node_element, "wsa:RelatesTo");
   relatesToNode->value(relatesTo.c_str());
   parent->append_node(relatesToNode);
 }
@@ -223,12 +304,13 @@ void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
   auto* metadataVersion =
       xmlDocument_->allocate_string(std::to_string(hello.MetadataVersion).c_str());
   metadataVersionNode->value(metadataVersion);
+  helloNode->append_node(metadataVersionNode);
   parent->append_node(helloNode);
 }
 
 void MessageSerializer::serialize(rapidxml::xml_node<>* parent, const WS::DISCOVERY::ByeType& bye)
 {
-  auto* byeNode = xmlDocument_->allocate_node(rapidxml::node_element, "wsd:bye");
+  auto* byeNode = xmlDocument_->allocate_node(rapidxml::node_element, "wsd:Bye");
   serialize(byeNode, bye.EndpointReference);
   if (bye.Types.has_value())
   {
@@ -255,10 +337,29 @@ void MessageSerializer::serialize(rapidxml::xml_node<>* parent, const WS::DISCOV
     auto* metadataVersion =
         xmlDocument_->allocate_string(std::to_string(bye.MetadataVersion.value()).c_str());
     metadataVersionNode->value(metadataVersion);
+    byeNode->append_node(metadataVersionNode);
   }
   parent->append_node(byeNode);
 }
 
+void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
+                                  const WS::DISCOVERY::ProbeType& probe)
+{
+  auto* probeNode = xmlDocument_->allocate_node(rapidxml::node_element, "wsd:Probe");
+  if (probe.Types.has_value())
+  {
+    auto* typesNode = xmlDocument_->allocate_node(rapidxml::node_element, "wsd:Types");
+    auto* typesStr = xmlDocument_->allocate_string(toString(probe.Types.value()).c_str());
+    typesNode->value(typesStr);
+    probeNode->append_node(typesNode);
+  }
+  if (probe.Scopes.has_value())
+  {
+    serialize(probeNode, probe.Scopes.value());
+  }
+  parent->append_node(probeNode);
+}
+
 void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
                                   const WS::DISCOVERY::ProbeMatchType& probeMatch)
 {
@@ -302,11 +403,18 @@ void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
   parent->append_node(probeMatchesNode);
 }
 
+void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
+                                  const WS::DISCOVERY::ResolveType& resolve)
+{
+  auto* resolveNode = xmlDocument_->allocate_node(rapidxml::node_element, "wsd:Resolve");
+  serialize(resolveNode, resolve.EndpointReference);
+  parent->append_node(resolveNode);
+}
+
 void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
                                   const WS::DISCOVERY::ResolveMatchType& resolveMatch)
 {
-  auto* resolveMatchNode =
-      xmlDocument_->allocate_node(rapidxml::node_element, "wsd:ResolveMatches");
+  auto* resolveMatchNode = xmlDocument_->allocate_node(rapidxml::node_element, "wsd:ResolveMatch");
   serialize(resolveMatchNode, resolveMatch.EndpointReference);
   if (resolveMatch.Types.has_value())
   {
@@ -376,6 +484,10 @@ void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
   {
     serialize(metadataSectionNode, metadataSection.Relationship.value());
   }
+  else if (metadataSection.StreamDescriptions.has_value())
+  {
+    serialize(metadataSectionNode, metadataSection.StreamDescriptions.value());
+  }
   else if (metadataSection.Location.has_value())
   {
     auto* locationNode = xmlDocument_->allocate_node(rapidxml::node_element, "mex:Location");
@@ -471,6 +583,43 @@ void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
   parent->append_node(hostedNode);
 }
 
+void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
+                                  const MDPWS::StreamDescriptionsType& streamDescriptions)
+{
+  auto* streamDescriptionsNode =
+      xmlDocument_->allocate_node(rapidxml::node_element, "mdpws:StreamDescriptions");
+  auto* targetNamespaceAttr = xmlDocument_->allocate_attribute(
+      "targetNamespace", streamDescriptions.targetNamespace.c_str());
+  streamDescriptionsNode->append_attribute(targetNamespaceAttr);
+  for (const auto& streamType : streamDescriptions.StreamType)
+  {
+    auto* streamTypeNode = xmlDocument_->allocate_node(rapidxml::node_element, "mdpws:StreamType");
+    auto* idAttr = xmlDocument_->allocate_attribute("id", streamType.id.c_str());
+    streamTypeNode->append_attribute(idAttr);
+    auto* streamTypeAttr =
+        xmlDocument_->allocate_attribute("streamType", streamType.streamType.c_str());
+    streamTypeNode->append_attribute(streamTypeAttr);
+    auto* actionUriAttr =
+        xmlDocument_->allocate_attribute("actionUri", streamType.actionUri.c_str());
+    streamTypeNode->append_attribute(actionUriAttr);
+    auto* elementAttr = xmlDocument_->allocate_attribute("element", streamType.element.c_str());
+    streamTypeNode->append_attribute(elementAttr);
+
+    auto* transmissionNode =
+        xmlDocument_->allocate_node(rapidxml::node_element, "mdpws:StreamTransmission");
+    if (streamType.StreamTransmission.StreamAddress.has_value())
+    {
+      auto* addressNode =
+          xmlDocument_->allocate_node(rapidxml::node_element, "mdpws:StreamAddress");
+      addressNode->value(streamType.StreamTransmission.StreamAddress->c_str());
+      transmissionNode->append_node(addressNode);
+    }
+    streamTypeNode->append_node(transmissionNode);
+    streamDescriptionsNode->append_node(streamTypeNode);
+  }
+  parent->append_node(streamDescriptionsNode);
+}
+
 void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
                                   const BICEPS::MM::GetMdibResponse& getMdibResponse)
 {
@@ -743,6 +892,31 @@ void MessageSerializer::serialize(
       metricNode->append_attribute(averagingPeriodAttr);
     }
   }
+  else if (const auto* const sampleArrayDescriptor =
+               dyn_cast<BICEPS::PM::RealTimeSampleArrayMetricDescriptor>(&abstractMetricDescriptor);
+           sampleArrayDescriptor != nullptr)
+  {
+    auto* typeAttr =
+        xmlDocument_->allocate_attribute("xsi:type", "pm:RealTimeSampleArrayMetricDescriptor");
+    metricNode->append_attribute(typeAttr);
+
+    for (const auto& range : sampleArrayDescriptor->TechnicalRange)
+    {
+      auto* technicalRangeNode =
+          xmlDocument_->allocate_node(rapidxml::node_element, "TechnicalRange");
+      serialize(technicalRangeNode, range);
+      metricNode->append_node(technicalRangeNode);
+    }
+
+    auto* resolution =
+        xmlDocument_->allocate_string(std::to_string(sampleArrayDescriptor->Resolution).c_str());
+    auto* resolutionAttr = xmlDocument_->allocate_attribute("Resolution", resolution);
+    metricNode->append_attribute(resolutionAttr);
+
+    auto* samplePeriodAttr = xmlDocument_->allocate_attribute(
+        "SamplePeriod", sampleArrayDescriptor->SamplePeriod.c_str());
+    metricNode->append_attribute(samplePeriodAttr);
+  }
 
   parent->append_node(metricNode);
 }
@@ -822,6 +996,17 @@ void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
     auto* typeAttr = xmlDocument_->allocate_attribute("xsi:type", "pm:NumericMetricState");
     stateNode->append_attribute(typeAttr);
   }
+  if (const auto* sampleArrayState = dyn_cast<BICEPS::PM::RealTimeSampleArrayMetricState>(&state);
+      sampleArrayState != nullptr)
+  {
+    if (sampleArrayState->MetricValue.has_value())
+    {
+      serialize(stateNode, sampleArrayState->MetricValue.value());
+    }
+    auto* typeAttr =
+        xmlDocument_->allocate_attribute("xsi:type", "pm:RealTimeSampleArrayMetricState");
+    stateNode->append_attribute(typeAttr);
+  }
   if (const auto* locationContextState = dyn_cast<BICEPS::PM::LocationContextState>(&state);
       locationContextState != nullptr)
   {
@@ -937,6 +1122,23 @@ void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
       valueNode->append_attribute(valueAttr);
     }
   }
+  else if (const auto* sampleArrayValue = dyn_cast<BICEPS::PM::SampleArrayValue>(&value);
+           sampleArrayValue != nullptr)
+  {
+    if (sampleArrayValue->Samples.has_value())
+    {
+      // whitespace separated list with shortest representation to keep stream datagrams small
+      std::ostringstream samples;
+      for (auto it = sampleArrayValue->Samples->begin(); it != sampleArrayValue->Samples->end();
+           ++it)
+      {
+        samples << (it != sampleArrayValue->Samples->begin() ? " " : "") << *it;
+      }
+      auto* samplesStr = xmlDocument_->allocate_string(samples.str().c_str());
+      auto* samplesAttr = xmlDocument_->allocate_attribute("Samples", samplesStr);
+      valueNode->append_attribute(samplesAttr);
+    }
+  }
 
   parent->append_node(valueNode);
 }
@@ -1001,6 +1203,37 @@ void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
   parent->append_node(renewResponseNode);
 }
 
+void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
+                                  const WS::EVENTING::SubscriptionEnd& subscriptionEnd)
+{
+  auto* subscriptionEndNode =
+      xmlDocument_->allocate_node(rapidxml::node_element, "wse:SubscriptionEnd");
+  auto* subscriptionManagerNode =
+      xmlDocument_->allocate_node(rapidxml::node_element, "wse:SubscriptionManager");
+
+  auto* addressNode = xmlDocument_->allocate_node(rapidxml::node_element, "wsa:Address");
+  addressNode->value(subscriptionEnd.SubscriptionManager.Address.c_str());
+  subscriptionManagerNode->append_node(addressNode);
+  if (subscriptionEnd.SubscriptionManager.ReferenceParameters.has_value())
+  {
+    serialize(subscriptionManagerNode,
+              subscriptionEnd.SubscriptionManager.ReferenceParameters.value());
+  }
+  subscriptionEndNode->append_node(subscriptionManagerNode);
+
+  auto* statusNode = xmlDocument_->allocate_node(rapidxml::node_element, "wse:Status");
+  statusNode->value(subscriptionEnd.Status.c_str());
+  subscriptionEndNode->append_node(statusNode);
+
+  if (subscriptionEnd.Reason.has_value())
+  {
+    auto* reasonNode = xmlDocument_->allocate_node(rapidxml::node_element, "wse:Reason");
+    reasonNode->value(subscriptionEnd.Reason->c_str());
+    subscriptionEndNode->append_node(reasonNode);
+  }
+  parent->append_node(subscriptionEndNode);
+}
+
 void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
                                   const BICEPS::MM::SetValueResponse& setValueResponse)
 {
@@ -1086,6 +1319,29 @@ void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
   parent->append_node(reportNode);
 }
 
+void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
+                                  const BICEPS::MM::WaveformStream& waveformStream)
+{
+  auto* streamNode = xmlDocument_->allocate_node(rapidxml::node_element, "mm:WaveformStream");
+  if (waveformStream.MdibVersion.has_value())
+  {
+    auto* version =
+        xmlDocument_->allocate_string(std::to_string(waveformStream.MdibVersion.value()).c_str());
+    auto* versionAttr = xmlDocument_->allocate_attribute("MdibVersion", version);
+    streamNode->append_attribute(versionAttr);
+  }
+  auto* sequenceIdAttr =
+      xmlDocument_->allocate_attribute("SequenceId", waveformStream.SequenceId.c_str());
+  streamNode->append_attribute(sequenceIdAttr);
+  for (const auto& state : waveformStream.State)
+  {
+    serialize(streamNode, *state);
+    // states of a waveform stream are message model elements
+    streamNode->last_node()->name("mm:State");
+  }
+  parent->append_node(streamNode);
+}
+
 void MessageSerializer::serialize(rapidxml::xml_node<>* parent,
                                   const BICEPS::MM::MetricReportPart& part)
 {
@@ -1179,7 +1435,17 @@ std::string MessageSerializer::toString(const WS::DISCOVERY::QNameListType& qNam
     {
       out += " ";
     }
-    out += std::string(std::string(qname->ns) + ":" + qname->name);
+    const auto* declared = std::find_if(
+        ENVELOPE_NAMESPACES.begin(), ENVELOPE_NAMESPACES.end(),
+        [&](const auto& declaredNamespace) { return qname->ns == declaredNamespace.uri; });
+    if (declared == ENVELOPE_NAMESPACES.end())
+    {
+      throw std::runtime_error("Namespace " + qname->ns + " of QName " + qname->name +
+                               " is not declared on the envelope");
+    }
+    out += declared->prefix;
+    out += ":";
+    out += qname->name;
   }
   return out;
 }
@@ -5,6 +5,7 @@
 #include "SDCConstants.hpp"
 #include <sstream>
 #include <string>
+#include <utility>
 
 class MessageSerializer
 {
@@ -17,6 +18,18 @@ public:
    * @brief get the serialized string
    */
   std::string str() const;
+  /**
+   * @brief get the serialized string split around the soap:Header element. The remaining parts
+   * frame a header serialized separately by serializeHeader(), e.g. per receiver of a message
+   * @return pair of the serialized strings before and after the soap:Header element
+   */
+  std::pair<std::string, std::string> strSplitAtHeader() const;
+  /**
+   * @brief serializes a standalone soap:Header element without xml declaration
+   * @param header the header to serialize
+   * @return the serialized soap:Header element
+   */
+  static std::string serializeHeader(const MESSAGEMODEL::Header& header);
 
   void serialize(const MESSAGEMODEL::Envelope& message);
   void serialize(rapidxml::xml_node<>* parent, const MESSAGEMODEL::Envelope& message);
@@ -28,8 +41,10 @@ public:
   void serialize(rapidxml::xml_node<>* parent, const WS::DISCOVERY::AppSequenceType& appSequence);
   void serialize(rapidxml::xml_node<>* parent, const WS::DISCOVERY::HelloType& hello);
   void serialize(rapidxml::xml_node<>* parent, const WS::DISCOVERY::ByeType& bye);
+  void serialize(rapidxml::xml_node<>* parent, const WS::DISCOVERY::ProbeType& probe);
   void serialize(rapidxml::xml_node<>* parent, const WS::DISCOVERY::ProbeMatchType& probeMatch);
   void serialize(rapidxml::xml_node<>* parent, const WS::DISCOVERY::ProbeMatchesType& probeMatches);
+  void serialize(rapidxml::xml_node<>* parent, const WS::DISCOVERY::ResolveType& resolve);
   void serialize(rapidxml::xml_node<>* parent, const WS::DISCOVERY::ResolveMatchType& resolveMatch);
   void serialize(rapidxml::xml_node<>* parent,
                  const WS::DISCOVERY::ResolveMatchesType& resolveMatches);
@@ -41,6 +56,8 @@ public:
   void serialize(rapidxml::xml_node<>* parent, const WS::DPWS::Relationship& relationship);
   void serialize(rapidxml::xml_node<>* parent, const WS::DPWS::HostServiceType& host);
   void serialize(rapidxml::xml_node<>* parent, const WS::DPWS::HostedServiceType& hosted);
+  void serialize(rapidxml::xml_node<>* parent,
+                 const MDPWS::StreamDescriptionsType& streamDescriptions);
   void serialize(rapidxml::xml_node<>* parent, const BICEPS::MM::GetMdibResponse& getMdibResponse);
   void serialize(rapidxml::xml_node<>* parent, const BICEPS::PM::Mdib& mdib);
   void serialize(rapidxml::xml_node<>* parent, const BICEPS::PM::MdDescription& mdDescription);
@@ -69,10 +86,13 @@ public:
   void serialize(rapidxml::xml_node<>* parent,
                  const WS::ADDRESSING::ReferenceParametersType& referenceParameters);
   void serialize(rapidxml::xml_node<>* parent, const WS::EVENTING::RenewResponse& renewResponse);
+  void serialize(rapidxml::xml_node<>* parent,
+                 const WS::EVENTING::SubscriptionEnd& subscriptionEnd);
   void serialize(rapidxml::xml_node<>* parent,
                  const BICEPS::MM::SetValueResponse& setValueResponse);
   void serialize(rapidxml::xml_node<>* parent, const BICEPS::MM::InvocationInfo& invocationInfo);
   void serialize(rapidxml::xml_node<>* parent, const BICEPS::MM::EpisodicMetricReport& report);
+  void serialize(rapidxml::xml_node<>* parent, const BICEPS::MM::WaveformStream& waveformStream);
   void serialize(rapidxml::xml_node<>* parent, const BICEPS::MM::MetricReportPart&);
   void serialize(rapidxml::xml_node<>* parent, const BICEPS::PM::ScoDescriptor& sco);
   void serialize(rapidxml::xml_node<>* parent,
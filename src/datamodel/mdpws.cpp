@@ -0,0 +1,18 @@
+#include "mdpws.hpp"
+
+namespace MDPWS
+{
+  StreamTypeType::StreamTypeType(IdType id, StreamTypeUriType streamType,
+                                 ActionUriType actionUri, ElementType element)
+    : id(std::move(id))
+    , streamType(std::move(streamType))
+    , actionUri(std::move(actionUri))
+    , element(std::move(element))
+  {
+  }
+
+  StreamDescriptionsType::StreamDescriptionsType(TargetNamespaceType targetNamespace)
+    : targetNamespace(std::move(targetNamespace))
+  {
+  }
+} // namespace MDPWS
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "ws-addressing.hpp"
+#include <string>
+#include <vector>
+
+namespace MDPWS
+{
+  struct StreamTransmissionType
+  {
+    // StreamAddress
+    //
+    using StreamAddressType = WS::ADDRESSING::URIType;
+    using StreamAddressOptional = std::optional<StreamAddressType>;
+    StreamAddressOptional StreamAddress;
+  };
+
+  struct StreamTypeType
+  {
+    // StreamTransmission
+    //
+    using StreamTransmissionType = ::MDPWS::StreamTransmissionType;
+    StreamTransmissionType StreamTransmission;
+
+    // id
+    //
+    using IdType = std::string;
+    IdType id;
+
+    // streamType
+    //
+    using StreamTypeUriType = WS::ADDRESSING::URIType;
+    StreamTypeUriType streamType;
+
+    // actionUri
+    //
+    using ActionUriType = WS::ADDRESSING::URIType;
+    ActionUriType actionUri;
+
+    // element
+    //
+    using ElementType = std::string;
+    ElementType element;
+
+    StreamTypeType(IdType id, StreamTypeUriType streamType, ActionUriType actionUri,
+                   ElementType element);
+  };
+
+  struct StreamDescriptionsType
+  {
+    // StreamType
+    //
+    using StreamTypeType = ::MDPWS::StreamTypeType;
+    using StreamTypeSequence = std::vector<StreamTypeType>;
+    StreamTypeSequence StreamType;
+
+    // targetNamespace
+    //
+    using TargetNamespaceType = WS::ADDRESSING::URIType;
+    TargetNamespaceType targetNamespace;
+
+    explicit StreamDescriptionsType(TargetNamespaceType targetNamespace);
+  };
+} // namespace MDPWS
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "mdpws.hpp"
 #include "ws-addressing.hpp"
 #include "ws-dpws.hpp"
 #include <vector>
@@ -64,6 +65,12 @@ namespace WS::MEX
     using RelationshipOptional = std::optional<RelationshipType>;
     RelationshipOptional Relationship;
 
+    // StreamDescriptions
+    //
+    using StreamDescriptionsType = ::MDPWS::StreamDescriptionsType;
+    using StreamDescriptionsOptional = std::optional<StreamDescriptionsType>;
+    StreamDescriptionsOptional StreamDescriptions;
+
     // Dialect
     //
     using DialectType = WS::ADDRESSING::URIType;
@@ -68,6 +68,18 @@ namespace WS::ADDRESSING
       throw ExpectedElement("Address", MDPWS::WS_NS_ADDRESSING);
     }
     Address = URIType{addressNode->value(), addressNode->value_size()};
+    const auto* referenceParametersNode =
+        node.first_node("ReferenceParameters", MDPWS::WS_NS_ADDRESSING);
+    if (referenceParametersNode != nullptr)
+    {
+      const auto* identifierNode =
+          referenceParametersNode->first_node("Identifier", MDPWS::WS_NS_EVENTING);
+      if (identifierNode != nullptr)
+      {
+        ReferenceParameters =
+            ReferenceParametersType(ReferenceParametersType::IdentifierType(*identifierNode));
+      }
+    }
   }
 
   // RelatesToType
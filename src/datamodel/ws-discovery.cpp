@@ -1,18 +1,118 @@
 #include "ws-discovery.hpp"
 #include "ExpectedElement.hpp"
 #include "MDPWSConstants.hpp"
+#include <cctype>
+#include <charconv>
+#include <cstring>
 #include <iterator>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 
 namespace WS::DISCOVERY
 {
+  namespace
+  {
+    /// @brief splits a whitespace separated XML list
+    /// @param value the list, not necessarily null terminated
+    /// @param size the length of the list
+    /// @param onItem called with the begin and length of every item of the list
+    template <typename Callback>
+    void forEachListItem(const char* value, std::size_t size, Callback&& onItem)
+    {
+      std::size_t begin = 0;
+      while (begin < size)
+      {
+        if (std::isspace(static_cast<unsigned char>(value[begin])) != 0)
+        {
+          ++begin;
+          continue;
+        }
+        auto end = begin;
+        while (end < size && std::isspace(static_cast<unsigned char>(value[end])) == 0)
+        {
+          ++end;
+        }
+        onItem(value + begin, end - begin);
+        begin = end;
+      }
+    }
+
+    /// @brief parses the MetadataVersion of a discovery message
+    /// @param node the MetadataVersion node
+    /// @return the metadata version
+    unsigned int parseMetadataVersion(const rapidxml::xml_node<>& node)
+    {
+      const auto* begin = node.value();
+      const auto* end = begin + node.value_size();
+      unsigned int metadataVersion = 0;
+      const auto [ptr, ec] = std::from_chars(begin, end, metadataVersion);
+      if (ec != std::errc() || ptr != end)
+      {
+        throw std::runtime_error("Invalid MetadataVersion " + std::string(begin, end));
+      }
+      return metadataVersion;
+    }
+
+    /// @brief parses the elements describing a target service common to Hello, Bye, ProbeMatch
+    /// and ResolveMatch. The MetadataVersion is left to the caller as its presence differs.
+    /// @param target the message to parse into
+    /// @param node the node of the message
+    template <typename T>
+    void parseTargetService(T& target, const rapidxml::xml_node<>& node)
+    {
+      const auto* eprNode = node.first_node("EndpointReference", MDPWS::WS_NS_ADDRESSING);
+      if (eprNode == nullptr)
+      {
+        throw ExpectedElement("EndpointReference", MDPWS::WS_NS_ADDRESSING);
+      }
+      target.EndpointReference = typename T::EndpointReferenceType(*eprNode);
+      const auto* typesNode = node.first_node("Types", MDPWS::WS_NS_DISCOVERY);
+      if (typesNode != nullptr)
+      {
+        target.Types = typename T::TypesType(*typesNode);
+      }
+      const auto* scopesNode = node.first_node("Scopes", MDPWS::WS_NS_DISCOVERY);
+      if (scopesNode != nullptr)
+      {
+        target.Scopes = typename T::ScopesType(*scopesNode);
+      }
+      const auto* xAddrsNode = node.first_node("XAddrs", MDPWS::WS_NS_DISCOVERY);
+      if (xAddrsNode != nullptr)
+      {
+        auto& xAddrs = target.XAddrs.emplace();
+        forEachListItem(xAddrsNode->value(), xAddrsNode->value_size(),
+                        [&](const char* item, std::size_t size) {
+                          xAddrs.emplace_back(std::string(item, size));
+                        });
+      }
+    }
+
+    /// @brief gets the mandatory MetadataVersion node of a message
+    /// @param node the node of the message
+    /// @return the MetadataVersion node
+    const rapidxml::xml_node<>& metadataVersionNode(const rapidxml::xml_node<>& node)
+    {
+      const auto* versionNode = node.first_node("MetadataVersion", MDPWS::WS_NS_DISCOVERY);
+      if (versionNode == nullptr)
+      {
+        throw ExpectedElement("MetadataVersion", MDPWS::WS_NS_DISCOVERY);
+      }
+      return *versionNode;
+    }
+  } // namespace
+
   QName::QName(NameSpaceString ns, std::string name)
-    : ns(ns)
+    : ns(std::move(ns))
     , name(std::move(name))
   {
   }
 
+  bool QName::operator==(const QName& other) const
+  {
+    return name == other.name && ns == other.ns;
+  }
+
   QNameListType::QNameListType(const rapidxml::xml_node<>& node)
   {
     this->parse(node);
@@ -20,7 +120,39 @@ namespace WS::DISCOVERY
 
   void QNameListType::parse(const rapidxml::xml_node<>& node)
   {
-    // TODO
+    forEachListItem(node.value(), node.value_size(), [&](const char* item, std::size_t size) {
+      const auto* colon = static_cast<const char*>(std::memchr(item, ':', size));
+      const auto prefixSize = colon == nullptr ? 0 : static_cast<std::size_t>(colon - item);
+      char* xmlns = nullptr;
+      std::size_t xmlnsSize = 0;
+      // the prefix is only read, rapidxml just lacks const correctness here
+      node.xmlns_lookup(xmlns, xmlnsSize, colon == nullptr ? nullptr : const_cast<char*>(item),
+                        prefixSize);
+      if (colon != nullptr && xmlns == nullptr)
+      {
+        throw std::runtime_error("Undeclared prefix of QName " + std::string(item, size));
+      }
+      const auto* localName = colon == nullptr ? item : colon + 1;
+      emplace_back(xmlns == nullptr ? std::string() : std::string(xmlns, xmlnsSize),
+                   std::string(localName, size - static_cast<std::size_t>(localName - item)));
+    });
+  }
+
+  ScopesType::ScopesType(const rapidxml::xml_node<>& node)
+  {
+    this->parse(node);
+  }
+
+  void ScopesType::parse(const rapidxml::xml_node<>& node)
+  {
+    forEachListItem(node.value(), node.value_size(), [&](const char* item, std::size_t size) {
+      emplace_back(std::string(item, size));
+    });
+    const auto* matchByAttr = node.first_attribute("MatchBy");
+    if (matchByAttr != nullptr)
+    {
+      MatchBy = MatchByType(std::string(matchByAttr->value(), matchByAttr->value_size()));
+    }
   }
 
   AppSequenceType::AppSequenceType(const uint64_t& instanceId, const uint64_t& messageNumber)
@@ -34,12 +166,41 @@ namespace WS::DISCOVERY
   {
   }
 
+  ByeType::ByeType(const rapidxml::xml_node<>& node)
+    : EndpointReference(WS::ADDRESSING::URIType(""))
+  {
+    this->parse(node);
+  }
+
+  void ByeType::parse(const rapidxml::xml_node<>& node)
+  {
+    parseTargetService(*this, node);
+    const auto* versionNode = node.first_node("MetadataVersion", MDPWS::WS_NS_DISCOVERY);
+    if (versionNode != nullptr)
+    {
+      MetadataVersion = parseMetadataVersion(*versionNode);
+    }
+  }
+
   HelloType::HelloType(EndpointReferenceType epr, MetadataVersionType metadataVersion)
     : EndpointReference(std::move(epr))
     , MetadataVersion(metadataVersion)
   {
   }
 
+  HelloType::HelloType(const rapidxml::xml_node<>& node)
+    : EndpointReference(WS::ADDRESSING::URIType(""))
+    , MetadataVersion(0)
+  {
+    this->parse(node);
+  }
+
+  void HelloType::parse(const rapidxml::xml_node<>& node)
+  {
+    parseTargetService(*this, node);
+    MetadataVersion = parseMetadataVersion(metadataVersionNode(node));
+  }
+
   ProbeType::ProbeType(const rapidxml::xml_node<>& node)
   {
     this->parse(node);
@@ -47,27 +208,68 @@ namespace WS::DISCOVERY
 
   void ProbeType::parse(const rapidxml::xml_node<>& node)
   {
-    // TODO
+    const auto* typesNode = node.first_node("Types", MDPWS::WS_NS_DISCOVERY);
+    if (typesNode != nullptr)
+    {
+      Types = TypesType(*typesNode);
+    }
+    const auto* scopesNode = node.first_node("Scopes", MDPWS::WS_NS_DISCOVERY);
+    if (scopesNode != nullptr)
+    {
+      Scopes = ScopesType(*scopesNode);
+    }
   }
 
-
   ProbeMatchType::ProbeMatchType(EndpointReferenceType epr, MetadataVersionType metadataVersion)
     : EndpointReference(std::move(epr))
     , MetadataVersion(metadataVersion)
   {
   }
 
+  ProbeMatchType::ProbeMatchType(const rapidxml::xml_node<>& node)
+    : EndpointReference(WS::ADDRESSING::URIType(""))
+    , MetadataVersion(0)
+  {
+    this->parse(node);
+  }
+
+  void ProbeMatchType::parse(const rapidxml::xml_node<>& node)
+  {
+    parseTargetService(*this, node);
+    MetadataVersion = parseMetadataVersion(metadataVersionNode(node));
+  }
+
   ProbeMatchesType::ProbeMatchesType(ProbeMatchSequence x)
     : ProbeMatch(std::move(x))
   {
   }
 
+  ProbeMatchesType::ProbeMatchesType(const rapidxml::xml_node<>& node)
+  {
+    this->parse(node);
+  }
+
+  void ProbeMatchesType::parse(const rapidxml::xml_node<>& node)
+  {
+    for (const auto* matchNode = node.first_node("ProbeMatch", MDPWS::WS_NS_DISCOVERY);
+         matchNode != nullptr;
+         matchNode = matchNode->next_sibling("ProbeMatch", MDPWS::WS_NS_DISCOVERY))
+    {
+      ProbeMatch.emplace_back(*matchNode);
+    }
+  }
+
   ResolveType::ResolveType(const rapidxml::xml_node<>& node)
     : EndpointReference(WS::ADDRESSING::URIType(""))
   {
     this->parse(node);
   }
 
+  ResolveType::ResolveType(EndpointReferenceType epr)
+    : EndpointReference(std::move(epr))
+  {
+  }
+
   void ResolveType::parse(const rapidxml::xml_node<>& node)
   {
     const auto* eprNode = node.first_node("EndpointReference", MDPWS::WS_NS_ADDRESSING);
@@ -84,9 +286,37 @@ namespace WS::DISCOVERY
   {
   }
 
+  ResolveMatchType::ResolveMatchType(const rapidxml::xml_node<>& node)
+    : EndpointReference(WS::ADDRESSING::URIType(""))
+    , MetadataVersion(0)
+  {
+    this->parse(node);
+  }
+
+  void ResolveMatchType::parse(const rapidxml::xml_node<>& node)
+  {
+    parseTargetService(*this, node);
+    MetadataVersion = parseMetadataVersion(metadataVersionNode(node));
+  }
+
   ResolveMatchesType::ResolveMatchesType(ResolveMatchSequence x)
     : ResolveMatch(std::move(x))
   {
   }
 
+  ResolveMatchesType::ResolveMatchesType(const rapidxml::xml_node<>& node)
+  {
+    this->parse(node);
+  }
+
+  void ResolveMatchesType::parse(const rapidxml::xml_node<>& node)
+  {
+    for (const auto* matchNode = node.first_node("ResolveMatch", MDPWS::WS_NS_DISCOVERY);
+         matchNode != nullptr;
+         matchNode = matchNode->next_sibling("ResolveMatch", MDPWS::WS_NS_DISCOVERY))
+    {
+      ResolveMatch.emplace_back(*matchNode);
+    }
+  }
+
 } // namespace WS::DISCOVERY
@@ -8,11 +8,14 @@ namespace WS::DISCOVERY
 {
   struct QName
   {
-    using NameSpaceString = const char*;
+    using NameSpaceString = std::string;
     QName(NameSpaceString ns, std::string name);
 
+    /// the namespace URI of this name. Serializers map it to the prefix they declare.
     NameSpaceString ns;
     std::string name;
+
+    bool operator==(const QName& other) const;
   };
 
   struct QNameListType : public std::vector<QName>
@@ -33,6 +36,12 @@ namespace WS::DISCOVERY
     using MatchByType = WS::ADDRESSING::URIType;
     using MatchByOptional = std::optional<MatchByType>;
     MatchByOptional MatchBy;
+
+    ScopesType() = default;
+    explicit ScopesType(const rapidxml::xml_node<>& node);
+
+  private:
+    void parse(const rapidxml::xml_node<>& node);
   };
 
   struct AppSequenceType
@@ -73,6 +82,10 @@ namespace WS::DISCOVERY
     MetadataVersionOptional MetadataVersion;
 
     explicit ByeType(EndpointReferenceType epr);
+    explicit ByeType(const rapidxml::xml_node<>& node);
+
+  private:
+    void parse(const rapidxml::xml_node<>& node);
   };
 
   struct HelloType
@@ -96,10 +109,15 @@ namespace WS::DISCOVERY
     MetadataVersionType MetadataVersion;
 
     HelloType(EndpointReferenceType epr, MetadataVersionType metadataVersion);
+    explicit HelloType(const rapidxml::xml_node<>& node);
+
+  private:
+    void parse(const rapidxml::xml_node<>& node);
   };
 
   struct ProbeType
   {
+    ProbeType() = default;
     explicit ProbeType(const rapidxml::xml_node<>& node);
 
     using TypesType = ::WS::DISCOVERY::QNameListType;
@@ -135,6 +153,10 @@ namespace WS::DISCOVERY
     MetadataVersionType MetadataVersion;
 
     ProbeMatchType(EndpointReferenceType epr, MetadataVersionType metadataVersion);
+    explicit ProbeMatchType(const rapidxml::xml_node<>& node);
+
+  private:
+    void parse(const rapidxml::xml_node<>& node);
   };
 
   struct ProbeMatchesType
@@ -144,12 +166,17 @@ namespace WS::DISCOVERY
     ProbeMatchSequence ProbeMatch;
 
     explicit ProbeMatchesType(ProbeMatchSequence x);
+    explicit ProbeMatchesType(const rapidxml::xml_node<>& node);
+
+  private:
+    void parse(const rapidxml::xml_node<>& node);
   };
 
   struct ResolveType
   {
   public:
     explicit ResolveType(const rapidxml::xml_node<>& node);
+    explicit ResolveType(::WS::ADDRESSING::EndpointReferenceType epr);
 
     using EndpointReferenceType = ::WS::ADDRESSING::EndpointReferenceType;
     EndpointReferenceType EndpointReference;
@@ -179,6 +206,10 @@ namespace WS::DISCOVERY
     MetadataVersionType MetadataVersion;
 
     ResolveMatchType(EndpointReferenceType epr, MetadataVersionType metadataVersion);
+    explicit ResolveMatchType(const rapidxml::xml_node<>& node);
+
+  private:
+    void parse(const rapidxml::xml_node<>& node);
   };
 
   struct ResolveMatchesType
@@ -189,5 +220,9 @@ namespace WS::DISCOVERY
     ResolveMatchSequence ResolveMatch;
 
     explicit ResolveMatchesType(ResolveMatchSequence x);
+    explicit ResolveMatchesType(const rapidxml::xml_node<>& node);
+
+  private:
+    void parse(const rapidxml::xml_node<>& node);
   };
 } // namespace WS::DISCOVERY
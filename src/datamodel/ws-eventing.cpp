@@ -146,6 +146,14 @@ namespace WS::EVENTING
     }
   }
 
+  // SubscriptionEnd
+  //
+  SubscriptionEnd::SubscriptionEnd(SubscriptionManagerType subscriptionManager, StatusType status)
+    : SubscriptionManager(std::move(subscriptionManager))
+    , Status(std::move(status))
+  {
+  }
+
   // Unsubscribe
   //
   Unsubscribe::Unsubscribe(const rapidxml::xml_node<>& node) {}
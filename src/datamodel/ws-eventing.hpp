@@ -104,6 +104,22 @@ namespace WS::EVENTING
     ExpiresOptional Expires;
   };
 
+  struct SubscriptionEnd
+  {
+  public:
+    using SubscriptionManagerType = WS::ADDRESSING::EndpointReferenceType;
+    SubscriptionManagerType SubscriptionManager;
+
+    using StatusType = std::string;
+    StatusType Status;
+
+    using ReasonType = std::string;
+    using ReasonOptional = std::optional<ReasonType>;
+    ReasonOptional Reason;
+
+    SubscriptionEnd(SubscriptionManagerType subscriptionManager, StatusType status);
+  };
+
   struct Unsubscribe
   {
     explicit Unsubscribe(const rapidxml::xml_node<>& node);
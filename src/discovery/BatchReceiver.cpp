@@ -0,0 +1,170 @@
+#include "BatchReceiver.hpp"
+#include <algorithm>
+#include <cstring>
+
+#ifdef __linux__
+/// the space of the ancillary data of a datagram, holding the drop counter of the socket
+static constexpr std::size_t CONTROL_SIZE = CMSG_SPACE(sizeof(std::uint32_t));
+#endif
+
+BatchReceiver::BatchReceiver(asio::ip::udp::socket& socket, std::size_t batchSize,
+                             std::size_t datagramSize)
+  : socket_(socket)
+  , datagramSize_(datagramSize)
+{
+#ifdef __linux__
+  batchSize = std::max<std::size_t>(batchSize, 1);
+  messages_.resize(batchSize);
+  vectors_.resize(batchSize);
+  senders_.resize(batchSize);
+  controls_.resize(batchSize * CONTROL_SIZE);
+#else
+  // without recvmmsg a single datagram is received per wakeup
+  batchSize = 1;
+#endif
+  buffers_.resize(batchSize * (datagramSize_ + 1));
+}
+
+void BatchReceiver::start(Handler handler)
+{
+  handler_ = std::move(handler);
+#if defined(__linux__) && defined(SO_RXQ_OVFL)
+  // let the kernel report the datagrams dropped for a full receive buffer
+  const int enable = 1;
+  ::setsockopt(socket_.native_handle(), SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable));
+#endif
+  doReceive();
+}
+
+std::size_t BatchReceiver::received() const
+{
+  return received_.load();
+}
+
+std::size_t BatchReceiver::dropped() const
+{
+  return dropped_.load();
+}
+
+void BatchReceiver::whenIdle(std::function<void()> onIdle)
+{
+  if (!receiving_)
+  {
+    onIdle();
+    return;
+  }
+  onIdle_ = std::move(onIdle);
+}
+
+void BatchReceiver::notifyIdle()
+{
+  if (onIdle_)
+  {
+    const auto onIdle = std::move(onIdle_);
+    onIdle_ = nullptr;
+    onIdle();
+  }
+}
+
+#ifdef __linux__
+void BatchReceiver::doReceive()
+{
+  receiving_ = true;
+  socket_.async_wait(asio::ip::udp::socket::wait_read, [this](const std::error_code& ec) {
+    receiving_ = false;
+    if (!socket_.is_open())
+    {
+      notifyIdle();
+      return;
+    }
+    if (!ec)
+    {
+      receiveBatch();
+    }
+    doReceive();
+  });
+}
+
+void BatchReceiver::receiveBatch()
+{
+  const auto slotSize = datagramSize_ + 1;
+  for (std::size_t i = 0; i < messages_.size(); ++i)
+  {
+    vectors_[i].iov_base = &buffers_[i * slotSize];
+    vectors_[i].iov_len = datagramSize_;
+    auto& header = messages_[i].msg_hdr;
+    header = msghdr();
+    header.msg_name = &senders_[i];
+    header.msg_namelen = sizeof(sockaddr_storage);
+    header.msg_iov = &vectors_[i];
+    header.msg_iovlen = 1;
+    header.msg_control = &controls_[i * CONTROL_SIZE];
+    header.msg_controllen = CONTROL_SIZE;
+  }
+  const int count = ::recvmmsg(socket_.native_handle(), messages_.data(),
+                               static_cast<unsigned int>(messages_.size()), MSG_DONTWAIT, nullptr);
+  // a failed call consumes pending socket errors, e.g. ICMP port unreachable of a sent datagram
+  for (int i = 0; i < count; ++i)
+  {
+    auto& header = messages_[i].msg_hdr;
+    for (auto* control = CMSG_FIRSTHDR(&header); control != nullptr;
+         control = CMSG_NXTHDR(&header, control))
+    {
+#ifdef SO_RXQ_OVFL
+      if (control->cmsg_level == SOL_SOCKET && control->cmsg_type == SO_RXQ_OVFL)
+      {
+        // the kernel reports the total number of drops of the socket
+        std::uint32_t kernelDropped = 0;
+        std::memcpy(&kernelDropped, CMSG_DATA(control), sizeof(kernelDropped));
+        dropped_ += kernelDropped - kernelDropped_;
+        kernelDropped_ = kernelDropped;
+      }
+#endif
+    }
+    if ((header.msg_flags & MSG_TRUNC) != 0)
+    {
+      ++dropped_;
+      continue;
+    }
+    auto* datagram = &buffers_[static_cast<std::size_t>(i) * slotSize];
+    const std::size_t size = messages_[i].msg_len;
+    datagram[size] = '\0';
+    asio::ip::udp::endpoint sender;
+    if (header.msg_namelen > sender.capacity())
+    {
+      ++dropped_;
+      continue;
+    }
+    std::memcpy(sender.data(), &senders_[i], header.msg_namelen);
+    sender.resize(header.msg_namelen);
+    ++received_;
+    handler_(datagram, size, sender);
+  }
+}
+#else
+void BatchReceiver::doReceive()
+{
+  receiving_ = true;
+  socket_.async_receive_from(
+      asio::buffer(buffers_.data(), buffers_.size()), sender_,
+      [this](const std::error_code& ec, std::size_t bytesRecvd) {
+        receiving_ = false;
+        if (!socket_.is_open())
+        {
+          notifyIdle();
+          return;
+        }
+        if (!ec && bytesRecvd > datagramSize_)
+        {
+          ++dropped_;
+        }
+        else if (!ec)
+        {
+          buffers_[bytesRecvd] = '\0';
+          ++received_;
+          handler_(buffers_.data(), bytesRecvd, sender_);
+        }
+        doReceive();
+      });
+}
+#endif
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <asio.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
+/// @brief BatchReceiver receives the datagrams of a UDP socket into a ring of fixed size buffers.
+/// On linux all datagrams queued at the socket, up to the size of the ring, are received by a
+/// single recvmmsg call per wakeup, so a burst of datagrams does not overflow the receive buffer
+/// of the socket while they are handled one by one. Other platforms receive one datagram per
+/// wakeup. The receiver is driven by the executor of its socket, all its functions have to be
+/// called on that executor.
+class BatchReceiver
+{
+public:
+  /// called with each received datagram, null terminated after size bytes
+  using Handler =
+      std::function<void(char* datagram, std::size_t size, const asio::ip::udp::endpoint& sender)>;
+
+  /// @brief constructs a receiver
+  /// @param socket the socket to receive on
+  /// @param batchSize the number of buffers in the ring, i.e. the datagrams received at once
+  /// @param datagramSize the maximum size of a datagram, larger datagrams are dropped
+  BatchReceiver(asio::ip::udp::socket& socket, std::size_t batchSize, std::size_t datagramSize);
+  BatchReceiver(const BatchReceiver&) = delete;
+  BatchReceiver(BatchReceiver&&) = delete;
+  BatchReceiver& operator=(const BatchReceiver&) = delete;
+  BatchReceiver& operator=(BatchReceiver&&) = delete;
+  ~BatchReceiver() = default;
+
+  /// @brief starts receiving until the socket is closed
+  /// @param handler called with each received datagram
+  void start(Handler handler);
+
+  /// @brief gets the number of datagrams received
+  /// @return the datagrams passed to the handler
+  std::size_t received() const;
+
+  /// @brief gets the number of datagrams dropped before reaching the handler, because they were
+  /// too large or, on linux, because the receive buffer of the socket was full
+  /// @return the dropped datagrams
+  std::size_t dropped() const;
+
+  /// @brief calls a handler once no receive handler referring to this receiver is pending, so it
+  /// may be destroyed. Has to be called on the executor of the socket after closing it.
+  /// @param onIdle called on the executor of the socket, immediately if no receive is in flight
+  void whenIdle(std::function<void()> onIdle);
+
+private:
+  /// the socket to receive on
+  asio::ip::udp::socket& socket_;
+  /// the maximum size of a datagram
+  const std::size_t datagramSize_;
+  /// the ring of datagram buffers, each one byte larger than datagramSize_ for a null terminator
+  std::vector<char> buffers_;
+  /// called with each received datagram
+  Handler handler_;
+  /// the datagrams passed to the handler
+  std::atomic<std::size_t> received_{0};
+  /// the datagrams dropped before reaching the handler
+  std::atomic<std::size_t> dropped_{0};
+  /// whether a receive is in flight
+  bool receiving_{false};
+  /// called once the receive aborted by closing the socket returned
+  std::function<void()> onIdle_;
+#ifdef __linux__
+  /// the message headers of the ring passed to recvmmsg
+  std::vector<mmsghdr> messages_;
+  /// the scatter elements of the ring, one per buffer
+  std::vector<iovec> vectors_;
+  /// the sender addresses of the ring
+  std::vector<sockaddr_storage> senders_;
+  /// the ancillary data of the ring carrying the drop counter of the socket
+  std::vector<char> controls_;
+  /// the drop counter of the socket last reported by the kernel
+  std::uint32_t kernelDropped_{0};
+
+  /// @brief receives all queued datagrams into the ring and handles them
+  void receiveBatch();
+#else
+  /// sending endpoint of a received datagram
+  asio::ip::udp::endpoint sender_;
+#endif
+
+  /// @brief waits for the next datagrams
+  void doReceive();
+
+  /// @brief calls the handler waiting for the aborted receive, if any
+  void notifyIdle();
+};
@@ -0,0 +1,40 @@
+#include "BufferPool.hpp"
+
+BufferPool::BufferPool(std::size_t capacity, std::size_t bufferSize)
+  : storage_(std::make_shared<Storage>())
+  , bufferSize_(bufferSize)
+{
+  storage_->capacity = capacity;
+  storage_->buffers.reserve(capacity);
+}
+
+BufferPool::Buffer BufferPool::acquire()
+{
+  std::unique_ptr<std::string> buffer;
+  {
+    std::lock_guard<std::mutex> lock(storage_->mutex);
+    if (!storage_->buffers.empty())
+    {
+      buffer = std::move(storage_->buffers.back());
+      storage_->buffers.pop_back();
+    }
+  }
+  if (buffer == nullptr)
+  {
+    buffer = std::make_unique<std::string>();
+    buffer->reserve(bufferSize_);
+  }
+  std::weak_ptr<Storage> weakStorage = storage_;
+  return Buffer(buffer.release(), [weakStorage](std::string* released) {
+    std::unique_ptr<std::string> owned(released);
+    if (const auto storage = weakStorage.lock(); storage != nullptr)
+    {
+      std::lock_guard<std::mutex> lock(storage->mutex);
+      if (storage->buffers.size() < storage->capacity)
+      {
+        owned->clear();
+        storage->buffers.emplace_back(std::move(owned));
+      }
+    }
+  });
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// @brief BufferPool hands out buffers for outgoing messages. Released buffers keep their capacity
+/// and are reused by later messages, up to a small number of buffers kept by the pool.
+class BufferPool
+{
+public:
+  /// a buffer returned to its pool when the last reference is dropped
+  using Buffer = std::shared_ptr<std::string>;
+
+  /// @brief constructs a pool
+  /// @param capacity the maximum number of released buffers kept for reuse
+  /// @param bufferSize the size new buffers reserve
+  BufferPool(std::size_t capacity, std::size_t bufferSize);
+
+  /// @brief takes an empty buffer from the pool or allocates a new one if none is left
+  /// @return the buffer, which may outlive the pool
+  Buffer acquire();
+
+private:
+  /// @brief the released buffers, shared with the buffers handed out
+  struct Storage
+  {
+    /// protects buffers
+    std::mutex mutex;
+    /// the released buffers
+    std::vector<std::unique_ptr<std::string>> buffers;
+    /// the maximum number of released buffers kept
+    std::size_t capacity;
+  };
+
+  /// the released buffers
+  std::shared_ptr<Storage> storage_;
+  /// the size new buffers reserve
+  const std::size_t bufferSize_;
+};
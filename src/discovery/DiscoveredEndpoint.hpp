@@ -0,0 +1,34 @@
+#pragma once
+
+#include "datamodel/ws-discovery.hpp"
+#include <string>
+
+/// @brief DiscoveredEndpoint describes a target service found by WS-Discovery
+struct DiscoveredEndpoint
+{
+  /// the endpoint reference address identifying the target service
+  std::string endpointReference;
+  /// the types of the target service
+  WS::DISCOVERY::QNameListType types;
+  /// the scopes of the target service
+  WS::DISCOVERY::UriListType scopes;
+  /// the transport addresses of the target service, empty if not yet resolved
+  WS::DISCOVERY::UriListType xAddrs;
+  /// the version of the metadata of the target service
+  unsigned int metadataVersion{0};
+};
+
+/// @brief creates a DiscoveredEndpoint from a Hello, ProbeMatch or ResolveMatch
+/// @param message the message describing a target service
+/// @return the described target service
+template <typename T>
+DiscoveredEndpoint toDiscoveredEndpoint(const T& message)
+{
+  DiscoveredEndpoint endpoint;
+  endpoint.endpointReference = message.EndpointReference.Address;
+  endpoint.types = message.Types.value_or(WS::DISCOVERY::QNameListType());
+  endpoint.scopes = message.Scopes.value_or(WS::DISCOVERY::ScopesType());
+  endpoint.xAddrs = message.XAddrs.value_or(WS::DISCOVERY::UriListType());
+  endpoint.metadataVersion = message.MetadataVersion;
+  return endpoint;
+}
@@ -0,0 +1,377 @@
+#include "DiscoveryClient.hpp"
+#include "Log.hpp"
+#include "MicroSDC.hpp"
+#include "datamodel/ExpectedElement.hpp"
+#include "datamodel/MessageSerializer.hpp"
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+static constexpr const char* TAG = "DiscoveryClient";
+/// the number of released message buffers kept for reuse
+static constexpr std::size_t BUFFER_POOL_SIZE = 4;
+/// the discovery messages per second sent in the long run
+static constexpr double SEND_RATE = 50;
+/// the discovery messages sent at once
+static constexpr std::size_t SEND_BURST = 20;
+/// the number of received MessageIDs remembered to drop repeated messages
+static constexpr std::size_t MESSAGE_ID_CACHE_SIZE = 64;
+/// the time a received MessageID is remembered, outlasting all repetitions of a message
+static constexpr std::chrono::seconds MESSAGE_ID_TTL{5};
+/// the maximum number of cached target services
+static constexpr std::size_t MAX_CACHED_ENDPOINTS = 256;
+
+DiscoveryClient::PendingProbe::PendingProbe(asio::io_context& ioContext, ProbeHandler handler)
+  : timer(ioContext)
+  , handler(std::move(handler))
+{
+}
+
+DiscoveryClient::PendingResolve::PendingResolve(asio::io_context& ioContext,
+                                                std::string endpointReference,
+                                                ResolveHandler handler)
+  : timer(ioContext)
+  , endpointReference(std::move(endpointReference))
+  , handler(std::move(handler))
+{
+}
+
+DiscoveryClient::DiscoveryClient(std::chrono::seconds cacheTtl)
+  : multicastSocket_(ioContext_)
+  , unicastSocket_(ioContext_, asio::ip::udp::endpoint(asio::ip::udp::v4(), 0))
+  , multicastEndpoint_(asio::ip::make_address(MDPWS::UDP_MULTICAST_DISCOVERY_IP_V4),
+                       MDPWS::UDP_MULTICAST_DISCOVERY_PORT)
+  , multicastBuffer_(std::make_unique<ReceiveBuffer>())
+  , unicastBuffer_(std::make_unique<ReceiveBuffer>())
+  , bufferPool_(BUFFER_POOL_SIZE, MDPWS::MAX_UDP_ENVELOPE_SIZE)
+  // the client runs on a single thread, the strand only satisfies the scheduler
+  , scheduler_(asio::make_strand(ioContext_), unicastSocket_, SEND_RATE, SEND_BURST)
+  , receivedMessageIds_(MESSAGE_ID_CACHE_SIZE, MESSAGE_ID_TTL)
+  , cacheTtl_(cacheTtl)
+{
+  // share the discovery port with a DiscoveryService of this or another process
+  multicastSocket_.open(asio::ip::udp::v4());
+  multicastSocket_.set_option(asio::ip::udp::socket::reuse_address(true));
+  multicastSocket_.bind(
+      asio::ip::udp::endpoint(asio::ip::udp::v4(), MDPWS::UDP_MULTICAST_DISCOVERY_PORT));
+  multicastSocket_.set_option(asio::ip::multicast::join_group(multicastEndpoint_.address()));
+}
+
+DiscoveryClient::~DiscoveryClient() noexcept
+{
+  stop();
+}
+
+void DiscoveryClient::start()
+{
+  running_.store(true);
+  thread_ = std::thread([this]() {
+    LOG(LogLevel::INFO, "Start listening for discovery messages...");
+    doReceive(multicastSocket_, *multicastBuffer_, multicastSender_);
+    doReceive(unicastSocket_, *unicastBuffer_, unicastSender_);
+    ioContext_.run();
+    LOG(LogLevel::INFO, "Shutting down discovery client thread...");
+  });
+}
+
+void DiscoveryClient::stop()
+{
+  if (!thread_.joinable())
+  {
+    return;
+  }
+  LOG(LogLevel::INFO, "Stopping...");
+  running_.store(false);
+  asio::post(ioContext_, [this]() {
+    scheduler_.cancel();
+    multicastSocket_.close();
+    unicastSocket_.close();
+    ioContext_.stop();
+  });
+  thread_.join();
+}
+
+bool DiscoveryClient::running() const
+{
+  return running_.load();
+}
+
+void DiscoveryClient::probe(WS::DISCOVERY::ProbeType probe, ProbeHandler handler,
+                            std::chrono::milliseconds timeout)
+{
+  asio::post(ioContext_, [this, probe = std::move(probe), handler = std::move(handler),
+                          timeout]() mutable {
+    MESSAGEMODEL::Envelope envelope;
+    envelope.Body.Probe = std::move(probe);
+    const auto messageId = send(envelope, MDPWS::WS_ACTION_PROBE, "Probe");
+    auto pending = std::make_shared<PendingProbe>(ioContext_, std::move(handler));
+    pendingProbes_.emplace(messageId, pending);
+    pending->timer.expires_after(timeout);
+    pending->timer.async_wait([this, messageId](const std::error_code& ec) {
+      if (ec)
+      {
+        return;
+      }
+      const auto it = pendingProbes_.find(messageId);
+      if (it == pendingProbes_.end())
+      {
+        return;
+      }
+      const auto completed = it->second;
+      pendingProbes_.erase(it);
+      completed->handler(std::move(completed->matches));
+    });
+  });
+}
+
+void DiscoveryClient::resolve(std::string endpointReference, ResolveHandler handler,
+                              std::chrono::milliseconds timeout)
+{
+  asio::post(ioContext_, [this, endpointReference = std::move(endpointReference),
+                          handler = std::move(handler), timeout]() mutable {
+    if (auto cached = lookup(endpointReference); cached.has_value() && !cached->xAddrs.empty())
+    {
+      LOG(LogLevel::DEBUG, "Resolved " << endpointReference << " from cache");
+      handler(std::move(cached));
+      return;
+    }
+    MESSAGEMODEL::Envelope envelope;
+    envelope.Body.Resolve = WS::DISCOVERY::ResolveType(
+        WS::ADDRESSING::EndpointReferenceType(WS::ADDRESSING::URIType(endpointReference)));
+    const auto messageId = send(envelope, MDPWS::WS_ACTION_RESOLVE, "Resolve");
+    auto pending = std::make_shared<PendingResolve>(ioContext_, std::move(endpointReference),
+                                                    std::move(handler));
+    pendingResolves_.emplace(messageId, pending);
+    pending->timer.expires_after(timeout);
+    pending->timer.async_wait([this, messageId](const std::error_code& ec) {
+      if (!ec)
+      {
+        completeResolve(messageId, std::nullopt);
+      }
+    });
+  });
+}
+
+std::optional<DiscoveredEndpoint>
+DiscoveryClient::lookup(const std::string& endpointReference) const
+{
+  std::lock_guard<std::mutex> lock(cacheMutex_);
+  const auto it = cache_.find(endpointReference);
+  if (it == cache_.end() || it->second.expiry <= Clock::now())
+  {
+    return std::nullopt;
+  }
+  return it->second.endpoint;
+}
+
+void DiscoveryClient::doReceive(asio::ip::udp::socket& socket, ReceiveBuffer& buffer,
+                                asio::ip::udp::endpoint& sender)
+{
+  if (!running_.load())
+  {
+    return;
+  }
+  socket.async_receive_from(
+      asio::buffer(buffer.data(), buffer.size() - 1), sender,
+      [this, &socket, &buffer, &sender](const std::error_code& error, std::size_t bytesRecvd) {
+        if (!socket.is_open())
+        {
+          return;
+        }
+        // a failed receive, e.g. after ICMP port unreachable of a sent datagram, does not stop
+        // listening on the socket
+        if (error)
+        {
+          LOG(LogLevel::DEBUG, "Receive failed: " << error.message());
+        }
+        else
+        {
+          // null terminate whatever received
+          buffer.at(bytesRecvd) = '\0';
+          handleUDPMessage(buffer, sender);
+        }
+        doReceive(socket, buffer, sender);
+      });
+}
+
+void DiscoveryClient::handleUDPMessage(ReceiveBuffer& buffer,
+                                       const asio::ip::udp::endpoint& sender)
+{
+  rapidxml::xml_document<> doc;
+  try
+  {
+    doc.parse<rapidxml::parse_fastest>(buffer.data());
+  }
+  catch (const rapidxml::parse_error& e)
+  {
+    LOG(LogLevel::ERROR, "ParseError at " << e.where<char>() - buffer.data() << ": " << e.what());
+    return;
+  }
+  const auto* envelopeNode = doc.first_node("Envelope", MDPWS::WS_NS_SOAP_ENVELOPE);
+  if (envelopeNode == nullptr)
+  {
+    return;
+  }
+  // drop repetitions before the message model is built from the body
+  const auto* headerNode = envelopeNode->first_node("Header", MDPWS::WS_NS_SOAP_ENVELOPE);
+  const auto* messageIdNode = headerNode != nullptr
+                                  ? headerNode->first_node("MessageID", MDPWS::WS_NS_ADDRESSING)
+                                  : nullptr;
+  if (messageIdNode != nullptr &&
+      receivedMessageIds_.isDuplicate({messageIdNode->value(), messageIdNode->value_size()}))
+  {
+    return;
+  }
+  std::unique_ptr<MESSAGEMODEL::Envelope> envelope;
+  try
+  {
+    envelope = std::make_unique<MESSAGEMODEL::Envelope>(*envelopeNode);
+  }
+  catch (ExpectedElement& e)
+  {
+    LOG(LogLevel::ERROR, "ExpectedElement " << e.ns() << ":" << e.name() << " not encountered");
+    return;
+  }
+  catch (const std::runtime_error& e)
+  {
+    LOG(LogLevel::ERROR, "Cannot parse received message: " << e.what());
+    return;
+  }
+
+  const auto& body = envelope->Body;
+  const auto relatesTo = envelope->Header.RelatesTo.value_or(
+      WS::ADDRESSING::RelatesToType(WS::ADDRESSING::URIType()));
+  if (body.Hello.has_value())
+  {
+    LOG(LogLevel::DEBUG, "Received Hello of " << body.Hello->EndpointReference.Address << " from "
+                                              << sender.address().to_string());
+    const auto endpoint = toDiscoveredEndpoint(body.Hello.value());
+    store(endpoint);
+    completeResolves(endpoint);
+  }
+  else if (body.Bye.has_value())
+  {
+    LOG(LogLevel::DEBUG, "Received Bye of " << body.Bye->EndpointReference.Address << " from "
+                                            << sender.address().to_string());
+    forget(body.Bye->EndpointReference.Address);
+  }
+  else if (body.ProbeMatches.has_value())
+  {
+    const auto it = pendingProbes_.find(relatesTo);
+    for (const auto& match : body.ProbeMatches->ProbeMatch)
+    {
+      const auto endpoint = toDiscoveredEndpoint(match);
+      store(endpoint);
+      if (it != pendingProbes_.end())
+      {
+        it->second->matches.emplace_back(endpoint);
+      }
+    }
+  }
+  else if (body.ResolveMatches.has_value())
+  {
+    for (const auto& match : body.ResolveMatches->ResolveMatch)
+    {
+      const auto endpoint = toDiscoveredEndpoint(match);
+      store(endpoint);
+      completeResolve(relatesTo, endpoint);
+    }
+  }
+}
+
+std::string DiscoveryClient::send(MESSAGEMODEL::Envelope& envelope, const char* action,
+                                  const char* messageName)
+{
+  auto messageId = MicroSDC::calculateMessageID();
+  envelope.Header.Action = WS::ADDRESSING::URIType(action);
+  envelope.Header.MessageID = WS::ADDRESSING::URIType(messageId);
+  envelope.Header.To = WS::ADDRESSING::URIType(MDPWS::WS_DISCOVERY_URN);
+  MessageSerializer serializer;
+  serializer.serialize(envelope);
+  auto buffer = bufferPool_.acquire();
+  *buffer = serializer.str();
+  LOG(LogLevel::INFO, "Sending " << messageName << "...");
+  scheduler_.schedule(std::move(buffer), multicastEndpoint_, TransmissionScheduler::MULTICAST,
+                      std::chrono::milliseconds(0), messageName);
+  return messageId;
+}
+
+void DiscoveryClient::completeResolve(const std::string& messageId,
+                                      std::optional<DiscoveredEndpoint> match)
+{
+  const auto it = pendingResolves_.find(messageId);
+  if (it == pendingResolves_.end())
+  {
+    return;
+  }
+  const auto completed = it->second;
+  pendingResolves_.erase(it);
+  completed->timer.cancel();
+  completed->handler(std::move(match));
+}
+
+void DiscoveryClient::completeResolves(const DiscoveredEndpoint& endpoint)
+{
+  if (endpoint.xAddrs.empty())
+  {
+    return;
+  }
+  std::vector<std::string> resolved;
+  for (const auto& [messageId, pending] : pendingResolves_)
+  {
+    if (pending->endpointReference == endpoint.endpointReference)
+    {
+      resolved.emplace_back(messageId);
+    }
+  }
+  for (const auto& messageId : resolved)
+  {
+    completeResolve(messageId, endpoint);
+  }
+}
+
+void DiscoveryClient::store(const DiscoveredEndpoint& endpoint)
+{
+  const auto now = Clock::now();
+  std::lock_guard<std::mutex> lock(cacheMutex_);
+  auto it = cache_.find(endpoint.endpointReference);
+  if (it != cache_.end())
+  {
+    const bool valid = it->second.expiry > now;
+    if (valid && it->second.endpoint.metadataVersion > endpoint.metadataVersion)
+    {
+      return;
+    }
+    // a Hello or ProbeMatch without XAddrs of the same metadata keeps the resolved ones
+    const bool keepXAddrs = valid && endpoint.xAddrs.empty() &&
+                            it->second.endpoint.metadataVersion == endpoint.metadataVersion;
+    auto xAddrs = std::move(it->second.endpoint.xAddrs);
+    it->second.endpoint = endpoint;
+    if (keepXAddrs)
+    {
+      it->second.endpoint.xAddrs = std::move(xAddrs);
+    }
+    it->second.expiry = now + cacheTtl_;
+    return;
+  }
+  if (cache_.size() >= MAX_CACHED_ENDPOINTS)
+  {
+    for (auto entry = cache_.begin(); entry != cache_.end();)
+    {
+      entry = entry->second.expiry <= now ? cache_.erase(entry) : std::next(entry);
+    }
+    if (cache_.size() >= MAX_CACHED_ENDPOINTS)
+    {
+      cache_.erase(std::min_element(cache_.begin(), cache_.end(), [](const auto& a, const auto& b) {
+        return a.second.expiry < b.second.expiry;
+      }));
+    }
+  }
+  cache_.emplace(endpoint.endpointReference, CacheEntry{endpoint, now + cacheTtl_});
+}
+
+void DiscoveryClient::forget(const std::string& endpointReference)
+{
+  std::lock_guard<std::mutex> lock(cacheMutex_);
+  cache_.erase(endpointReference);
+}
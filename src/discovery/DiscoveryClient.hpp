@@ -0,0 +1,185 @@
+#pragma once
+
+#include "BufferPool.hpp"
+#include "DiscoveredEndpoint.hpp"
+#include "MessageIdCache.hpp"
+#include "TransmissionScheduler.hpp"
+#include "datamodel/MDPWSConstants.hpp"
+#include "datamodel/MessageModel.hpp"
+#include <array>
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// @brief DiscoveryClient finds other target services by WS-Discovery. It sends Probe and Resolve
+/// messages and collects their matches asynchronously. Every observed Hello, Bye, ProbeMatch and
+/// ResolveMatch updates a cache of the target services, so resolving a known endpoint reference
+/// again takes no network round trip until its cache entry expires.
+class DiscoveryClient
+{
+public:
+  /// called with all matches received until a probe timed out
+  using ProbeHandler = std::function<void(std::vector<DiscoveredEndpoint> matches)>;
+  /// called with the match of a resolve or nothing if it timed out
+  using ResolveHandler = std::function<void(std::optional<DiscoveredEndpoint> match)>;
+
+  /// @brief constructs a DiscoveryClient
+  /// @param cacheTtl the time a discovered target service is cached
+  explicit DiscoveryClient(std::chrono::seconds cacheTtl = std::chrono::seconds(300));
+  DiscoveryClient(const DiscoveryClient&) = delete;
+  DiscoveryClient(DiscoveryClient&&) = delete;
+  DiscoveryClient& operator=(const DiscoveryClient&) = delete;
+  DiscoveryClient& operator=(DiscoveryClient&&) = delete;
+  ~DiscoveryClient() noexcept;
+
+  /// @brief starts listening for discovery messages on a thread of this client
+  void start();
+
+  /// @brief stops the client, pending probes and resolves are not completed
+  void stop();
+
+  /// @brief Returns whether this discovery client is running
+  /// @return whether this client runs
+  bool running() const;
+
+  /// @brief sends a probe to the discovery multicast group
+  /// @param probe the types and scopes to search for
+  /// @param handler called on the thread of this client with all matches once the timeout elapsed
+  /// @param timeout the time to collect matches
+  void probe(WS::DISCOVERY::ProbeType probe, ProbeHandler handler,
+             std::chrono::milliseconds timeout = std::chrono::seconds(MDPWS::MATCH_TIMEOUT));
+
+  /// @brief resolves the transport addresses of a target service. A cached target service with
+  /// known transport addresses is returned without sending a Resolve.
+  /// @param endpointReference the endpoint reference address of the target service
+  /// @param handler called on the thread of this client with the match or nothing on timeout
+  /// @param timeout the time to wait for a match
+  void resolve(std::string endpointReference, ResolveHandler handler,
+               std::chrono::milliseconds timeout = std::chrono::seconds(MDPWS::MATCH_TIMEOUT));
+
+  /// @brief looks up a target service in the cache
+  /// @param endpointReference the endpoint reference address of the target service
+  /// @return the cached target service or nothing if unknown or expired
+  std::optional<DiscoveredEndpoint> lookup(const std::string& endpointReference) const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+  using ReceiveBuffer = std::array<char, MDPWS::MAX_ENVELOPE_SIZE + 1>;
+
+  /// @brief a cached target service
+  struct CacheEntry
+  {
+    /// the target service
+    DiscoveredEndpoint endpoint;
+    /// the time this entry expires
+    Clock::time_point expiry;
+  };
+
+  /// @brief a probe waiting for matches
+  struct PendingProbe
+  {
+    explicit PendingProbe(asio::io_context& ioContext, ProbeHandler handler);
+    /// expires when the probe is completed
+    asio::steady_timer timer;
+    /// called with the matches on completion
+    ProbeHandler handler;
+    /// the matches received so far
+    std::vector<DiscoveredEndpoint> matches;
+  };
+
+  /// @brief a resolve waiting for its match
+  struct PendingResolve
+  {
+    PendingResolve(asio::io_context& ioContext, std::string endpointReference,
+                   ResolveHandler handler);
+    /// expires when the resolve times out
+    asio::steady_timer timer;
+    /// the endpoint reference address to resolve
+    std::string endpointReference;
+    /// called with the match on completion
+    ResolveHandler handler;
+  };
+
+  /// whether this client runs
+  std::atomic_bool running_{false};
+  /// thread of this client
+  std::thread thread_;
+  /// asio IO context for this client
+  asio::io_context ioContext_;
+  /// receives Hello and Bye messages sent to the discovery multicast group
+  asio::ip::udp::socket multicastSocket_;
+  /// sends Probe and Resolve messages and receives their matches
+  asio::ip::udp::socket unicastSocket_;
+  /// multicast endpoint 239.255.255.250:3702
+  asio::ip::udp::endpoint multicastEndpoint_;
+  /// buffer for receiving on multicastSocket_
+  std::unique_ptr<ReceiveBuffer> multicastBuffer_;
+  /// buffer for receiving on unicastSocket_
+  std::unique_ptr<ReceiveBuffer> unicastBuffer_;
+  /// sending endpoint of a packet received on multicastSocket_
+  asio::ip::udp::endpoint multicastSender_;
+  /// sending endpoint of a packet received on unicastSocket_
+  asio::ip::udp::endpoint unicastSender_;
+  /// buffers of outgoing messages
+  BufferPool bufferPool_;
+  /// delays, repeats and rate limits the messages sent on unicastSocket_
+  TransmissionScheduler scheduler_;
+  /// MessageIDs of recently received messages to drop their repetitions
+  MessageIdCache receivedMessageIds_;
+  /// probes waiting for matches by their MessageID
+  std::unordered_map<std::string, std::shared_ptr<PendingProbe>> pendingProbes_;
+  /// resolves waiting for their match by their MessageID
+  std::unordered_map<std::string, std::shared_ptr<PendingResolve>> pendingResolves_;
+
+  /// the time a discovered target service is cached
+  const std::chrono::seconds cacheTtl_;
+  /// protects cache_
+  mutable std::mutex cacheMutex_;
+  /// cached target services by their endpoint reference address
+  std::unordered_map<std::string, CacheEntry> cache_;
+
+  /// @brief registers for receiving the next packet on a socket
+  /// @param socket the socket to receive on
+  /// @param buffer the buffer to receive into
+  /// @param sender the endpoint to store the sender of the packet in
+  void doReceive(asio::ip::udp::socket& socket, ReceiveBuffer& buffer,
+                 asio::ip::udp::endpoint& sender);
+
+  /// @brief handles a received discovery message
+  /// @param buffer the null terminated message
+  /// @param sender the sender of the message
+  void handleUDPMessage(ReceiveBuffer& buffer, const asio::ip::udp::endpoint& sender);
+
+  /// @brief sends a Probe or Resolve message to the multicast group
+  /// @param envelope the message with its body set
+  /// @param action the action of the message
+  /// @param messageName the name of the message for logging
+  /// @return the MessageID of the sent message
+  std::string send(MESSAGEMODEL::Envelope& envelope, const char* action, const char* messageName);
+
+  /// @brief completes a pending resolve
+  /// @param messageId the MessageID of the resolve
+  /// @param match the match of the resolve or nothing on timeout
+  void completeResolve(const std::string& messageId, std::optional<DiscoveredEndpoint> match);
+
+  /// @brief completes pending resolves of a target service announced without being asked for
+  /// @param endpoint the announced target service
+  void completeResolves(const DiscoveredEndpoint& endpoint);
+
+  /// @brief stores a target service in the cache unless a newer metadata version is cached. The
+  /// cached XAddrs are kept if the target service is stored without XAddrs at the same version.
+  /// @param endpoint the discovered target service
+  void store(const DiscoveredEndpoint& endpoint);
+
+  /// @brief removes a target service from the cache
+  /// @param endpointReference the endpoint reference address of the target service
+  void forget(const std::string& endpointReference);
+};
@@ -0,0 +1,95 @@
+#include "DiscoveryMessageTemplate.hpp"
+#include "datamodel/MessageSerializer.hpp"
+#include <string>
+
+namespace
+{
+  constexpr std::string_view HEADER_END = "</soap:Header>";
+
+  /// @brief appends a value escaped like the serializer escapes text and attribute values
+  /// @param out the string to append to
+  /// @param value the value to escape
+  void appendEscaped(std::string& out, std::string_view value)
+  {
+    for (const auto c : value)
+    {
+      switch (c)
+      {
+        case '&':
+          out += "&amp;";
+          break;
+        case '<':
+          out += "&lt;";
+          break;
+        case '>':
+          out += "&gt;";
+          break;
+        case '"':
+          out += "&quot;";
+          break;
+        default:
+          out += c;
+      }
+    }
+  }
+
+  /// @brief appends an element with a text value
+  /// @param out the string to append to
+  /// @param name the qualified name of the element
+  /// @param value the value of the element
+  void appendElement(std::string& out, std::string_view name, std::string_view value)
+  {
+    out += '<';
+    out += name;
+    out += '>';
+    appendEscaped(out, value);
+    out += "</";
+    out += name;
+    out += '>';
+  }
+} // namespace
+
+DiscoveryMessageTemplate::DiscoveryMessageTemplate(const MESSAGEMODEL::Envelope& envelope)
+{
+  MESSAGEMODEL::Envelope::HeaderType header;
+  header.Action = envelope.Header.Action;
+  MESSAGEMODEL::Envelope message;
+  message.Header = header;
+  message.Body = envelope.Body;
+  MessageSerializer serializer;
+  serializer.serialize(message);
+  auto [prefix, suffix] = serializer.strSplitAtHeader();
+  auto serializedHeader = MessageSerializer::serializeHeader(header);
+  serializedHeader.resize(serializedHeader.size() - HEADER_END.size());
+  head_ = std::move(prefix) + serializedHeader;
+  tail_ = std::string(HEADER_END) + suffix;
+}
+
+void DiscoveryMessageTemplate::render(std::string& out, const Slots& slots) const
+{
+  out.clear();
+  out += head_;
+  appendElement(out, "wsa:MessageID", slots.messageId);
+  if (!slots.to.empty())
+  {
+    appendElement(out, "wsa:To", slots.to);
+  }
+  if (slots.appSequence != nullptr)
+  {
+    out += "<wsd:AppSequence InstanceId=\"";
+    out += std::to_string(slots.appSequence->InstanceId);
+    if (slots.appSequence->SequenceId.has_value())
+    {
+      out += "\" SequenceId=\"";
+      appendEscaped(out, slots.appSequence->SequenceId.value());
+    }
+    out += "\" MessageNumber=\"";
+    out += std::to_string(slots.appSequence->MessageNumber);
+    out += "\"/>";
+  }
+  if (!slots.relatesTo.empty())
+  {
+    appendElement(out, "wsa:RelatesTo", slots.relatesTo);
+  }
+  out += tail_;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "datamodel/MessageModel.hpp"
+#include <string>
+#include <string_view>
+
+/// @brief DiscoveryMessageTemplate holds a WS-Discovery message serialized once. Rendering it only
+/// writes the header fields changing with every message into fixed slots between the pre-rendered
+/// parts, the body is never serialized again.
+class DiscoveryMessageTemplate
+{
+public:
+  /// @brief the header fields written into every rendered message
+  struct Slots
+  {
+    /// the id of the message
+    std::string_view messageId;
+    /// the destination of the message, omitted if empty
+    std::string_view to;
+    /// the id of the request this message replies to, omitted if empty
+    std::string_view relatesTo;
+    /// the application sequence of the message, omitted if nullptr
+    const WS::DISCOVERY::AppSequenceType* appSequence{nullptr};
+  };
+
+  /// @brief serializes the template from a given message
+  /// @param envelope the message with its Action and body set. The slot fields of its header are
+  /// ignored.
+  explicit DiscoveryMessageTemplate(const MESSAGEMODEL::Envelope& envelope);
+
+  /// @brief renders the message with the given slot values
+  /// @param[out] out the buffer to render into, its content is replaced
+  /// @param slots the header fields of this message
+  void render(std::string& out, const Slots& slots) const;
+
+private:
+  /// the serialized message up to the end of the wsa:Action element
+  std::string head_;
+  /// the serialized message from the closing soap:Header tag on
+  std::string tail_;
+};
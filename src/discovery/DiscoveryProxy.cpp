@@ -0,0 +1,351 @@
+#include "DiscoveryProxy.hpp"
+#include "Log.hpp"
+#include "MicroSDC.hpp"
+#include "datamodel/ExpectedElement.hpp"
+#include "datamodel/MessageSerializer.hpp"
+#include <utility>
+
+static constexpr const char* TAG = "DiscoveryProxy";
+/// the number of released message buffers kept for reuse
+static constexpr std::size_t BUFFER_POOL_SIZE = 4;
+/// the discovery messages per second sent in the long run
+static constexpr double SEND_RATE = 50;
+/// the discovery messages sent at once
+static constexpr std::size_t SEND_BURST = 20;
+/// the number of received MessageIDs remembered to drop repeated messages
+static constexpr std::size_t MESSAGE_ID_CACHE_SIZE = 64;
+/// the time a received MessageID is remembered, outlasting all repetitions of a message
+static constexpr std::chrono::seconds MESSAGE_ID_TTL{5};
+/// the metadata version of this proxy
+static constexpr unsigned int METADATA_VERSION = 1;
+
+namespace
+{
+  /// @brief fills the description of a registered target service into a match
+  /// @param service the registered target service
+  /// @param match the ProbeMatch or ResolveMatch to fill
+  template <typename T>
+  void describeService(const DiscoveredEndpoint& service, T& match)
+  {
+    if (!service.types.empty())
+    {
+      match.Types = service.types;
+    }
+    if (!service.scopes.empty())
+    {
+      match.Scopes = WS::DISCOVERY::ScopesType();
+      match.Scopes->assign(service.scopes.begin(), service.scopes.end());
+    }
+    if (!service.xAddrs.empty())
+    {
+      match.XAddrs = service.xAddrs;
+    }
+  }
+} // namespace
+
+DiscoveryProxy::DiscoveryProxy(const asio::ip::address_v4& address, std::uint16_t port)
+  : socket_(ioContext_, asio::ip::udp::endpoint(address, port))
+  , multicastEndpoint_(asio::ip::make_address(MDPWS::UDP_MULTICAST_DISCOVERY_IP_V4),
+                       MDPWS::UDP_MULTICAST_DISCOVERY_PORT)
+  , receiveBuffer_(std::make_unique<ReceiveBuffer>())
+  , bufferPool_(BUFFER_POOL_SIZE, MDPWS::MAX_UDP_ENVELOPE_SIZE)
+  // the proxy runs on a single thread, the strand only satisfies the scheduler
+  , scheduler_(asio::make_strand(ioContext_), socket_, SEND_RATE, SEND_BURST)
+  , receivedMessageIds_(MESSAGE_ID_CACHE_SIZE, MESSAGE_ID_TTL)
+  , endpointReference_(MicroSDC::calculateMessageID())
+{
+  if (address.is_unspecified())
+  {
+    throw std::runtime_error("DiscoveryProxy needs the address it is reached at!");
+  }
+  // announce on the interface of the address the proxy is reached at
+  socket_.set_option(asio::ip::multicast::outbound_interface(address));
+  xAddress_ = std::string(MDPWS::SOAP_OVER_UDP_SCHEME) + address.to_string() + ":" +
+              std::to_string(socket_.local_endpoint().port());
+  types_.emplace_back(MDPWS::WS_NS_DISCOVERY, MDPWS::WS_DISCOVERY_PROXY_TYPE);
+  probeMatcher_.setTypes(types_);
+}
+
+DiscoveryProxy::~DiscoveryProxy() noexcept
+{
+  stop();
+}
+
+void DiscoveryProxy::start()
+{
+  running_.store(true);
+  thread_ = std::thread([this]() {
+    messagingContext_.resetInstanceId();
+    MESSAGEMODEL::Envelope envelope;
+    envelope.Header.Action = WS::ADDRESSING::URIType(MDPWS::WS_ACTION_HELLO);
+    auto& hello = envelope.Body.Hello = WS::DISCOVERY::HelloType(
+        WS::ADDRESSING::EndpointReferenceType(WS::ADDRESSING::URIType(endpointReference_)),
+        METADATA_VERSION);
+    describe(hello.value());
+    send(envelope, MDPWS::WS_DISCOVERY_URN, {}, multicastEndpoint_,
+         TransmissionScheduler::MULTICAST, "Hello");
+    LOG(LogLevel::INFO, "Serving at " << xAddress_ << "...");
+    doReceive();
+    ioContext_.run();
+    LOG(LogLevel::INFO, "Shutting down discovery proxy thread...");
+  });
+}
+
+void DiscoveryProxy::stop()
+{
+  if (!thread_.joinable())
+  {
+    return;
+  }
+  LOG(LogLevel::INFO, "Stopping...");
+  // pending answers are dropped, the thread stops once the Bye and its repetitions were sent
+  asio::post(ioContext_, [this]() {
+    scheduler_.cancel();
+    MESSAGEMODEL::Envelope envelope;
+    envelope.Header.Action = WS::ADDRESSING::URIType(MDPWS::WS_ACTION_BYE);
+    auto& bye = envelope.Body.Bye = WS::DISCOVERY::ByeType(
+        WS::ADDRESSING::EndpointReferenceType(WS::ADDRESSING::URIType(endpointReference_)));
+    describe(bye.value());
+    send(envelope, MDPWS::WS_DISCOVERY_URN, {}, multicastEndpoint_,
+         TransmissionScheduler::MULTICAST, "Bye", [this]() {
+           running_.store(false);
+           socket_.close();
+           ioContext_.stop();
+         });
+  });
+  thread_.join();
+}
+
+bool DiscoveryProxy::running() const
+{
+  return running_.load();
+}
+
+asio::ip::udp::endpoint DiscoveryProxy::endpoint() const
+{
+  return socket_.local_endpoint();
+}
+
+const std::string& DiscoveryProxy::getEndpointReference() const
+{
+  return endpointReference_;
+}
+
+std::vector<DiscoveredEndpoint> DiscoveryProxy::registeredServices() const
+{
+  std::lock_guard<std::mutex> lock(registryMutex_);
+  std::vector<DiscoveredEndpoint> services;
+  services.reserve(registry_.size());
+  for (const auto& [endpointReference, service] : registry_)
+  {
+    services.emplace_back(service);
+  }
+  return services;
+}
+
+void DiscoveryProxy::doReceive()
+{
+  if (!running_.load())
+  {
+    return;
+  }
+  socket_.async_receive_from(asio::buffer(receiveBuffer_->data(), receiveBuffer_->size() - 1),
+                             senderEndpoint_,
+                             [this](const std::error_code& error, std::size_t bytesRecvd) {
+                               if (!socket_.is_open())
+                               {
+                                 return;
+                               }
+                               // a failed receive does not stop serving the clients
+                               if (error)
+                               {
+                                 LOG(LogLevel::DEBUG, "Receive failed: " << error.message());
+                               }
+                               else
+                               {
+                                 // null terminate whatever received
+                                 receiveBuffer_->at(bytesRecvd) = '\0';
+                                 handleUDPMessage(bytesRecvd);
+                               }
+                               doReceive();
+                             });
+}
+
+void DiscoveryProxy::handleUDPMessage(std::size_t bytesRecvd)
+{
+  const auto senderAddress = senderEndpoint_.address().to_string();
+  LOG(LogLevel::DEBUG, "Received " << bytesRecvd << " bytes from " << senderAddress << "\n"
+                                   << receiveBuffer_->data());
+  rapidxml::xml_document<> doc;
+  try
+  {
+    doc.parse<rapidxml::parse_fastest>(receiveBuffer_->data());
+  }
+  catch (const rapidxml::parse_error& e)
+  {
+    LOG(LogLevel::ERROR, "ParseError at " << e.where<char>() - receiveBuffer_->data() << ": "
+                                          << e.what());
+    return;
+  }
+  const auto* envelopeNode = doc.first_node("Envelope", MDPWS::WS_NS_SOAP_ENVELOPE);
+  if (envelopeNode == nullptr)
+  {
+    return;
+  }
+  // drop repetitions before the message model is built from the body
+  const auto* headerNode = envelopeNode->first_node("Header", MDPWS::WS_NS_SOAP_ENVELOPE);
+  const auto* messageIdNode = headerNode != nullptr
+                                  ? headerNode->first_node("MessageID", MDPWS::WS_NS_ADDRESSING)
+                                  : nullptr;
+  if (messageIdNode != nullptr &&
+      receivedMessageIds_.isDuplicate({messageIdNode->value(), messageIdNode->value_size()}))
+  {
+    return;
+  }
+  std::unique_ptr<MESSAGEMODEL::Envelope> envelope;
+  try
+  {
+    envelope = std::make_unique<MESSAGEMODEL::Envelope>(*envelopeNode);
+  }
+  catch (ExpectedElement& e)
+  {
+    LOG(LogLevel::ERROR, "ExpectedElement " << e.ns() << ":" << e.name() << " not encountered");
+    return;
+  }
+  catch (const std::runtime_error& e)
+  {
+    LOG(LogLevel::ERROR, "Cannot parse received message: " << e.what());
+    return;
+  }
+
+  const auto& body = envelope->Body;
+  if (body.Hello.has_value())
+  {
+    LOG(LogLevel::INFO, "Registering " << body.Hello->EndpointReference.Address << " from "
+                                       << senderAddress);
+    auto service = toDiscoveredEndpoint(body.Hello.value());
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    registry_.insert_or_assign(service.endpointReference, std::move(service));
+  }
+  else if (body.Bye.has_value())
+  {
+    LOG(LogLevel::INFO, "Unregistering " << body.Bye->EndpointReference.Address << " from "
+                                         << senderAddress);
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    registry_.erase(body.Bye->EndpointReference.Address);
+  }
+  else if (body.Probe.has_value())
+  {
+    handleProbe(*envelope);
+  }
+  else if (body.Resolve.has_value())
+  {
+    handleResolve(*envelope);
+  }
+}
+
+void DiscoveryProxy::handleProbe(const MESSAGEMODEL::Envelope& envelope)
+{
+  const auto& probe = envelope.Body.Probe.value();
+  MESSAGEMODEL::Envelope answer;
+  answer.Header.Action = WS::ADDRESSING::URIType(MDPWS::WS_ACTION_PROBE_MATCHES);
+  auto& probeMatches = answer.Body.ProbeMatches = WS::DISCOVERY::ProbeMatchesType({});
+  if (probeMatcher_.matches(probe))
+  {
+    auto& match = probeMatches->ProbeMatch.emplace_back(
+        WS::ADDRESSING::EndpointReferenceType(WS::ADDRESSING::URIType(endpointReference_)),
+        METADATA_VERSION);
+    describe(match);
+  }
+  {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    for (const auto& [endpointReference, service] : registry_)
+    {
+      ProbeMatcher matcher;
+      matcher.setTypes(service.types);
+      matcher.setScopes(service.scopes);
+      if (!matcher.matches(probe))
+      {
+        continue;
+      }
+      auto& match = probeMatches->ProbeMatch.emplace_back(
+          WS::ADDRESSING::EndpointReferenceType(WS::ADDRESSING::URIType(endpointReference)),
+          service.metadataVersion);
+      describeService(service, match);
+    }
+  }
+  // a directed probe is answered even without matches
+  LOG(LogLevel::INFO, "Sending " << probeMatches->ProbeMatch.size() << " ProbeMatch(es)");
+  send(answer, replyTo(envelope), envelope.Header.MessageID.value_or(WS::ADDRESSING::URIType()),
+       senderEndpoint_, TransmissionScheduler::UNICAST, "ProbeMatches");
+}
+
+void DiscoveryProxy::handleResolve(const MESSAGEMODEL::Envelope& envelope)
+{
+  const auto& endpointReference = envelope.Body.Resolve->EndpointReference.Address;
+  MESSAGEMODEL::Envelope answer;
+  answer.Header.Action = WS::ADDRESSING::URIType(MDPWS::WS_ACTION_RESOLVE_MATCHES);
+  auto& resolveMatches = answer.Body.ResolveMatches = WS::DISCOVERY::ResolveMatchesType({});
+  if (endpointReference == endpointReference_)
+  {
+    auto& match = resolveMatches->ResolveMatch.emplace_back(
+        WS::ADDRESSING::EndpointReferenceType(WS::ADDRESSING::URIType(endpointReference_)),
+        METADATA_VERSION);
+    describe(match);
+  }
+  else
+  {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    const auto it = registry_.find(endpointReference);
+    if (it == registry_.end())
+    {
+      return;
+    }
+    const auto& service = it->second;
+    auto& match = resolveMatches->ResolveMatch.emplace_back(
+        WS::ADDRESSING::EndpointReferenceType(WS::ADDRESSING::URIType(endpointReference)),
+        service.metadataVersion);
+    describeService(service, match);
+  }
+  LOG(LogLevel::INFO, "Sending ResolveMatch of " << endpointReference);
+  send(answer, replyTo(envelope), envelope.Header.MessageID.value_or(WS::ADDRESSING::URIType()),
+       senderEndpoint_, TransmissionScheduler::UNICAST, "ResolveMatches");
+}
+
+void DiscoveryProxy::send(MESSAGEMODEL::Envelope& envelope, std::string to,
+                          const std::string& relatesTo, const asio::ip::udp::endpoint& endpoint,
+                          const TransmissionScheduler::Repetition& repetition,
+                          const char* messageName, std::function<void()> onSent)
+{
+  envelope.Header.MessageID = WS::ADDRESSING::URIType(MicroSDC::calculateMessageID());
+  envelope.Header.To = WS::ADDRESSING::URIType(std::move(to));
+  if (!relatesTo.empty())
+  {
+    envelope.Header.RelatesTo = WS::ADDRESSING::RelatesToType(WS::ADDRESSING::URIType(relatesTo));
+  }
+  envelope.Header.AppSequence = WS::DISCOVERY::AppSequenceType(
+      messagingContext_.getInstanceId(), messagingContext_.getNextMessageCounter());
+  MessageSerializer serializer;
+  serializer.serialize(envelope);
+  auto buffer = bufferPool_.acquire();
+  *buffer = serializer.str();
+  scheduler_.schedule(std::move(buffer), endpoint, repetition, std::chrono::milliseconds(0),
+                      messageName, std::move(onSent));
+}
+
+template <typename T>
+void DiscoveryProxy::describe(T& message) const
+{
+  message.Types = types_;
+  message.XAddrs = WS::DISCOVERY::UriListType();
+  message.XAddrs->emplace_back(xAddress_);
+}
+
+std::string DiscoveryProxy::replyTo(const MESSAGEMODEL::Envelope& request)
+{
+  if (request.Header.ReplyTo.has_value())
+  {
+    return request.Header.ReplyTo->Address;
+  }
+  return MDPWS::WS_ADDRESSING_ANONYMOUS;
+}
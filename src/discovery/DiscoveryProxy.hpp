@@ -0,0 +1,138 @@
+#pragma once
+
+#include "BufferPool.hpp"
+#include "DiscoveredEndpoint.hpp"
+#include "MessageIdCache.hpp"
+#include "MessagingContext.hpp"
+#include "ProbeMatcher.hpp"
+#include "TransmissionScheduler.hpp"
+#include "datamodel/MDPWSConstants.hpp"
+#include "datamodel/MessageModel.hpp"
+#include <array>
+#include <asio.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// @brief DiscoveryProxy is a minimal in-process WS-Discovery proxy. Target services in managed
+/// mode register by unicast Hello and leave by unicast Bye, directed Probe and Resolve messages are
+/// answered from the registered services. On start it announces itself to the discovery multicast
+/// group, so target services on the network switch to managed mode. It does not listen to the
+/// multicast group, it is meant as a local stand-in for a discovery proxy, e.g. in tests.
+class DiscoveryProxy
+{
+public:
+  /// @brief constructs a DiscoveryProxy
+  /// @param address the ipv4 address to receive on, also selecting the interface the proxy is
+  /// announced on
+  /// @param port the udp port to receive on, zero to pick a free port
+  explicit DiscoveryProxy(const asio::ip::address_v4& address, std::uint16_t port = 0);
+  DiscoveryProxy(const DiscoveryProxy&) = delete;
+  DiscoveryProxy(DiscoveryProxy&&) = delete;
+  DiscoveryProxy& operator=(const DiscoveryProxy&) = delete;
+  DiscoveryProxy& operator=(DiscoveryProxy&&) = delete;
+  ~DiscoveryProxy() noexcept;
+
+  /// @brief announces the proxy and serves requests on a thread of this proxy
+  void start();
+
+  /// @brief says Bye to the multicast group and stops the proxy
+  void stop();
+
+  /// @brief Returns whether this proxy is running
+  /// @return whether this proxy runs
+  bool running() const;
+
+  /// @brief gets the endpoint this proxy receives on
+  /// @return the SOAP-over-UDP endpoint of this proxy
+  asio::ip::udp::endpoint endpoint() const;
+
+  /// @brief gets the endpoint reference address identifying this proxy
+  /// @return the endpoint reference address
+  const std::string& getEndpointReference() const;
+
+  /// @brief gets the target services registered with this proxy
+  /// @return the registered target services
+  std::vector<DiscoveredEndpoint> registeredServices() const;
+
+private:
+  using ReceiveBuffer = std::array<char, MDPWS::MAX_ENVELOPE_SIZE + 1>;
+
+  /// whether this proxy runs
+  std::atomic_bool running_{false};
+  /// thread of this proxy
+  std::thread thread_;
+  /// asio IO context for this proxy
+  asio::io_context ioContext_;
+  /// receives requests and sends answers and announcements
+  asio::ip::udp::socket socket_;
+  /// multicast endpoint 239.255.255.250:3702
+  asio::ip::udp::endpoint multicastEndpoint_;
+  /// buffer for receiving udp data
+  std::unique_ptr<ReceiveBuffer> receiveBuffer_;
+  /// sending endpoint of a received packet
+  asio::ip::udp::endpoint senderEndpoint_;
+  /// buffers of outgoing messages
+  BufferPool bufferPool_;
+  /// delays, repeats and rate limits the messages sent on socket_
+  TransmissionScheduler scheduler_;
+  /// MessageIDs of recently received messages to drop their repetitions
+  MessageIdCache receivedMessageIds_;
+  /// messaging context of this proxy
+  MessagingContext messagingContext_;
+  /// endpoint reference address of this proxy
+  const std::string endpointReference_;
+  /// the SOAP-over-UDP transport address of this proxy
+  std::string xAddress_;
+  /// the types of this proxy
+  WS::DISCOVERY::QNameListType types_;
+  /// matches probes against the discovery proxy type
+  ProbeMatcher probeMatcher_;
+
+  /// protects registry_
+  mutable std::mutex registryMutex_;
+  /// registered target services by their endpoint reference address
+  std::unordered_map<std::string, DiscoveredEndpoint> registry_;
+
+  /// @brief registers for receiving the next packet
+  void doReceive();
+
+  /// @brief handles a received discovery message
+  /// @param bytesRecvd the size of the message
+  void handleUDPMessage(std::size_t bytesRecvd);
+
+  /// @brief answers a directed Probe with all matching target services and this proxy
+  /// @param envelope the received probe
+  void handleProbe(const MESSAGEMODEL::Envelope& envelope);
+
+  /// @brief answers a directed Resolve of a registered target service or this proxy
+  /// @param envelope the received resolve
+  void handleResolve(const MESSAGEMODEL::Envelope& envelope);
+
+  /// @brief sends a message
+  /// @param envelope the message with its action and body set
+  /// @param to the destination of the message
+  /// @param relatesTo the MessageID of the request answered, empty if none
+  /// @param endpoint the receiver of the message
+  /// @param repetition how often to repeat the message
+  /// @param messageName the name of the message for logging
+  /// @param onSent called after the last repetition was sent
+  void send(MESSAGEMODEL::Envelope& envelope, std::string to, const std::string& relatesTo,
+            const asio::ip::udp::endpoint& endpoint,
+            const TransmissionScheduler::Repetition& repetition, const char* messageName,
+            std::function<void()> onSent = {});
+
+  /// @brief fills the description of this proxy into a Hello, Bye or match
+  /// @param message the message describing this proxy
+  template <typename T>
+  void describe(T& message) const;
+
+  /// @brief gets the destination of a reply to a given request
+  /// @param request the request to reply to
+  /// @return the ReplyTo address of the request or the anonymous address if not given
+  static std::string replyTo(const MESSAGEMODEL::Envelope& request);
+};
@@ -4,28 +4,257 @@
 #include "datamodel/ExpectedElement.hpp"
 #include "datamodel/MessageModel.hpp"
 #include "datamodel/MessageSerializer.hpp"
+#include <algorithm>
 #include <array>
+#include <cassert>
+#include <charconv>
+#include <chrono>
+#include <future>
 #include <memory>
 #include <utility>
 
 static constexpr const char* TAG = "DPWS";
+/// the number of released message buffers kept for reuse
+static constexpr std::size_t BUFFER_POOL_SIZE = 4;
+/// the discovery messages per second sent in the long run
+static constexpr double SEND_RATE = 50;
+/// the discovery messages sent at once, e.g. repetitions of answers to a burst of probes
+static constexpr std::size_t SEND_BURST = 20;
+/// the number of received MessageIDs remembered to drop repeated messages
+static constexpr std::size_t MESSAGE_ID_CACHE_SIZE = 64;
+/// the time a received MessageID is remembered, outlasting all repetitions of a message
+static constexpr std::chrono::seconds MESSAGE_ID_TTL{5};
+/// the number of datagrams received at once, e.g. a burst of probes
+static constexpr std::size_t RECEIVE_BATCH_SIZE = 8;
+/// the time between checks whether the discovery proxy of managed mode still answers
+static constexpr std::chrono::seconds PROXY_CHECK_INTERVAL{30};
 
-DiscoveryService::DiscoveryService(WS::ADDRESSING::EndpointReferenceType::AddressType epr,
-                                   WS::DISCOVERY::QNameListType types,
-                                   WS::DISCOVERY::UriListType xAddresses,
-                                   WS::DISCOVERY::HelloType::MetadataVersionType metadataVersion)
-  : socket_(ioContext_,
-            asio::ip::udp::endpoint(asio::ip::udp::v4(), MDPWS::UDP_MULTICAST_DISCOVERY_PORT))
-  , multicastEndpoint_(addressFromString(MDPWS::UDP_MULTICAST_DISCOVERY_IP_V4),
-                       MDPWS::UDP_MULTICAST_DISCOVERY_PORT)
-  , receiveBuffer_(std::make_unique<std::array<char, MDPWS::MAX_ENVELOPE_SIZE + 1>>())
-  , endpointReference_(std::move(epr))
-  , types_(std::move(types))
-  , xAddresses_(std::move(xAddresses))
-  , metadataVersion_(metadataVersion)
+namespace
 {
-  socket_.set_option(asio::ip::udp::socket::reuse_address(true));
-  socket_.set_option(asio::ip::multicast::join_group(multicastEndpoint_.address()));
+  /// @brief gets the SOAP-over-UDP transport address of an endpoint
+  /// @param endpoint the endpoint
+  /// @return the transport address, e.g. soap.udp://192.168.0.1:3702
+  std::string toSoapOverUdpAddress(const asio::ip::udp::endpoint& endpoint)
+  {
+    std::string address = MDPWS::SOAP_OVER_UDP_SCHEME;
+    if (endpoint.address().is_v6())
+    {
+      auto host = endpoint.address().to_v6();
+      host.scope_id(0);
+      address += "[" + host.to_string() + "]";
+    }
+    else
+    {
+      address += endpoint.address().to_string();
+    }
+    return address + ":" + std::to_string(endpoint.port());
+  }
+
+  /// @brief parses a SOAP-over-UDP transport address with a literal ip address
+  /// @param xAddr the transport address, e.g. soap.udp://[fe80::1]:3702
+  /// @return the endpoint of the address or nothing if it is no SOAP-over-UDP address
+  std::optional<asio::ip::udp::endpoint> parseSoapOverUdpAddress(std::string_view xAddr)
+  {
+    const std::string_view scheme = MDPWS::SOAP_OVER_UDP_SCHEME;
+    if (xAddr.substr(0, scheme.size()) != scheme)
+    {
+      return std::nullopt;
+    }
+    auto authority = xAddr.substr(scheme.size());
+    authority = authority.substr(0, std::min(authority.find('/'), authority.size()));
+    std::string_view host = authority;
+    std::string_view port;
+    if (!authority.empty() && authority.front() == '[')
+    {
+      const auto bracket = authority.find(']');
+      if (bracket == std::string_view::npos)
+      {
+        return std::nullopt;
+      }
+      host = authority.substr(1, bracket - 1);
+      port = authority.substr(bracket + 1);
+    }
+    else if (const auto colon = authority.find(':'); colon != std::string_view::npos)
+    {
+      host = authority.substr(0, colon);
+      port = authority.substr(colon);
+    }
+    std::uint16_t portNumber = MDPWS::UDP_MULTICAST_DISCOVERY_PORT;
+    if (!port.empty())
+    {
+      if (port.front() != ':')
+      {
+        return std::nullopt;
+      }
+      port.remove_prefix(1);
+      const auto [end, ec] = std::from_chars(port.data(), port.data() + port.size(), portNumber);
+      if (ec != std::errc() || end != port.data() + port.size())
+      {
+        return std::nullopt;
+      }
+    }
+    try
+    {
+      return asio::ip::udp::endpoint(asio::ip::make_address(std::string(host)), portNumber);
+    }
+    catch (const std::exception&)
+    {
+      return std::nullopt;
+    }
+  }
+
+  /// @brief returns whether a Hello or Bye announces a discovery proxy
+  /// @param message the announcement
+  /// @return whether the types of the message contain the discovery proxy type
+  template <typename T>
+  bool isDiscoveryProxy(const T& message)
+  {
+    if (!message.Types.has_value())
+    {
+      return false;
+    }
+    const WS::DISCOVERY::QName proxyType(MDPWS::WS_NS_DISCOVERY, MDPWS::WS_DISCOVERY_PROXY_TYPE);
+    return std::find(message.Types->begin(), message.Types->end(), proxyType) !=
+           message.Types->end();
+  }
+} // namespace
+
+DiscoveryService::InterfaceContext::InterfaceContext(
+    const TransmissionScheduler::Executor& executor, const asio::ip::address& address,
+    std::size_t index, std::size_t targetCount)
+  : address(address)
+  , index(index)
+  , socket(executor)
+  , receiver(socket, RECEIVE_BATCH_SIZE, MDPWS::MAX_UDP_ENVELOPE_SIZE)
+  // every target service gets the budget a device announcing itself alone would have
+  , scheduler(executor, socket, SEND_RATE * static_cast<double>(targetCount),
+              SEND_BURST * targetCount)
+  , receivedMessageIds(MESSAGE_ID_CACHE_SIZE, MESSAGE_ID_TTL)
+{
+}
+
+DiscoveryService::TargetContext::TargetContext(Target config)
+  : config(std::move(config))
+  , templates(this->config.xAddresses.size())
+{
+  probeMatcher.setTypes(this->config.types);
+  probeMatcher.setScopes(scopes);
+}
+
+DiscoveryService::DiscoveryService(std::vector<asio::ip::address> interfaces,
+                                   std::vector<Target> targets,
+                                   std::shared_ptr<asio::io_context> ioContext)
+  : ownsIOContext_(ioContext == nullptr)
+  , ioContext_(ownsIOContext_ ? std::make_shared<asio::io_context>() : std::move(ioContext))
+  , strand_(asio::make_strand(*ioContext_))
+  , bufferPool_(BUFFER_POOL_SIZE, MDPWS::MAX_UDP_ENVELOPE_SIZE)
+  , proxyTimer_(strand_)
+{
+  if (interfaces.empty())
+  {
+    throw std::runtime_error("DiscoveryService needs at least one network interface!");
+  }
+  if (targets.empty())
+  {
+    throw std::runtime_error("DiscoveryService needs at least one target service!");
+  }
+  for (auto& target : targets)
+  {
+    if (target.xAddresses.size() != interfaces.size())
+    {
+      throw std::runtime_error("Target service " + target.endpointReference +
+                               " does not have addresses for every network interface!");
+    }
+    targets_.emplace_back(std::make_unique<TargetContext>(std::move(target)));
+  }
+  for (const auto& address : interfaces)
+  {
+    const auto& context = interfaces_.emplace_back(std::make_unique<InterfaceContext>(
+        strand_, address, interfaces_.size(), targets_.size()));
+    openSocket(*context);
+  }
+  const bool dualStack = std::any_of(interfaces_.begin(), interfaces_.end(),
+                                     [](const auto& c) { return c->address.is_v6(); });
+  // the proxy socket is no interface of its own, messages to the proxy describe proxyInterface_
+  proxyContext_ = std::make_unique<InterfaceContext>(
+      strand_,
+      dualStack ? asio::ip::address(asio::ip::address_v6::any())
+                : asio::ip::address(asio::ip::address_v4::any()),
+      interfaces_.size(), targets_.size());
+  openProxySocket(*proxyContext_, dualStack);
+}
+
+void DiscoveryService::openSocket(InterfaceContext& context)
+{
+  const auto& address = context.address;
+  auto& socket = context.socket;
+  const asio::ip::udp::endpoint any(address.is_v4() ? asio::ip::udp::v4() : asio::ip::udp::v6(),
+                                    MDPWS::UDP_MULTICAST_DISCOVERY_PORT);
+  if (address.is_v4())
+  {
+    const auto group = asio::ip::make_address_v4(MDPWS::UDP_MULTICAST_DISCOVERY_IP_V4);
+    context.multicastEndpoint = asio::ip::udp::endpoint(group, any.port());
+    // share the discovery port with the sockets of the other interfaces and a DiscoveryClient
+    socket.open(any.protocol());
+    socket.set_option(asio::ip::udp::socket::reuse_address(true));
+    socket.bind(any);
+    if (address.is_unspecified())
+    {
+      socket.set_option(asio::ip::multicast::join_group(group));
+    }
+    else
+    {
+      socket.set_option(asio::ip::multicast::join_group(group, address.to_v4()));
+      socket.set_option(asio::ip::multicast::outbound_interface(address.to_v4()));
+    }
+#ifdef IP_MULTICAST_ALL
+    // only receive the groups joined on this socket instead of those joined by any socket, so a
+    // message is handled by the socket of the interface it arrived on
+    const int multicastAll = 0;
+    ::setsockopt(socket.native_handle(), IPPROTO_IP, IP_MULTICAST_ALL, &multicastAll,
+                 sizeof(multicastAll));
+#endif
+  }
+  else
+  {
+    const auto scopeId = address.to_v6().scope_id();
+    if (scopeId == 0)
+    {
+      throw std::runtime_error("IPv6 discovery address " + address.to_string() +
+                               " does not name its interface!");
+    }
+    auto group = asio::ip::make_address_v6(MDPWS::UDP_MULTICAST_DISCOVERY_IP_V6);
+    group.scope_id(scopeId);
+    context.multicastEndpoint = asio::ip::udp::endpoint(group, any.port());
+    socket.open(any.protocol());
+    socket.set_option(asio::ip::v6_only(true));
+    socket.set_option(asio::ip::udp::socket::reuse_address(true));
+    socket.bind(any);
+    socket.set_option(asio::ip::multicast::join_group(group, scopeId));
+    socket.set_option(asio::ip::multicast::outbound_interface(static_cast<unsigned int>(scopeId)));
+#ifdef IPV6_MULTICAST_ALL
+    const int multicastAll = 0;
+    ::setsockopt(socket.native_handle(), IPPROTO_IPV6, IPV6_MULTICAST_ALL, &multicastAll,
+                 sizeof(multicastAll));
+#endif
+  }
+  LOG(LogLevel::INFO, "Joined discovery multicast group "
+                          << context.multicastEndpoint.address().to_string() << " on "
+                          << address.to_string());
+}
+
+void DiscoveryService::openProxySocket(InterfaceContext& context, bool dualStack)
+{
+  if (dualStack)
+  {
+    // ipv4 discovery proxies are reached by their ipv4 mapped address
+    context.socket.open(asio::ip::udp::v6());
+    context.socket.set_option(asio::ip::v6_only(false));
+    context.socket.bind(asio::ip::udp::endpoint(asio::ip::udp::v6(), 0));
+    return;
+  }
+  context.socket.open(asio::ip::udp::v4());
+  context.socket.bind(asio::ip::udp::endpoint(asio::ip::udp::v4(), 0));
 }
 
 DiscoveryService::~DiscoveryService() noexcept
@@ -35,24 +264,94 @@ DiscoveryService::~DiscoveryService() noexcept
 
 void DiscoveryService::stop()
 {
+  if (!started_)
+  {
+    return;
+  }
+  assert(!ioContext_->get_executor().running_in_this_thread() &&
+         "DiscoveryService::stop must not be called on a thread running its io context");
   LOG(LogLevel::INFO, "Stopping...");
-  sendBye();
-  running_.store(false);
-  socket_.close();
-  ioContext_.stop();
-  thread_.join();
+  // pending answers are dropped, the service stops once the Bye and its repetitions were sent
+  // and the handlers of the operations aborted by closing the sockets returned
+  std::promise<void> stopped;
+  asio::post(strand_, [this, &stopped]() {
+    for (const auto& context : interfaces_)
+    {
+      context->scheduler.cancel();
+    }
+    proxyContext_->scheduler.cancel();
+    proxyTimer_.cancel();
+    sendBye([this, &stopped]() {
+      running_.store(false);
+      for (const auto& context : interfaces_)
+      {
+        context->socket.close();
+      }
+      proxyContext_->socket.close();
+      // waits in a handler of its own, this one runs within the scheduler sending the Bye
+      asio::post(strand_, [this, &stopped]() {
+        awaitAbortedOperations([&stopped]() { stopped.set_value(); });
+      });
+    });
+  });
+  stopped.get_future().wait();
+  if (ownsIOContext_)
+  {
+    ioContext_->stop();
+    thread_.join();
+    LOG(LogLevel::INFO, "Shut down discovery service thread");
+  }
+  started_ = false;
+}
+
+void DiscoveryService::awaitAbortedOperations(std::function<void()> onIdle)
+{
+  // the receiver and the scheduler of every socket report once
+  const auto pending = std::make_shared<std::size_t>(2 * (interfaces_.size() + 1));
+  const auto idle = [pending, onIdle = std::move(onIdle)]() {
+    if (--*pending == 0)
+    {
+      onIdle();
+    }
+  };
+  for (const auto& context : interfaces_)
+  {
+    context->receiver.whenIdle(idle);
+    context->scheduler.whenIdle(idle);
+  }
+  proxyContext_->receiver.whenIdle(idle);
+  proxyContext_->scheduler.whenIdle(idle);
 }
 
 void DiscoveryService::start()
 {
-  thread_ = std::thread([&]() {
+  started_ = true;
+  asio::post(strand_, [this]() {
     running_.store(true);
-    sendHello();
+    for (const auto& target : targets_)
+    {
+      target->messagingContext.resetInstanceId();
+    }
     LOG(LogLevel::INFO, "Start listening for discovery messages...");
-    doReceive();
-    ioContext_.run();
-    LOG(LogLevel::INFO, "Shutting down discovery service thread...");
+    for (const auto& context : interfaces_)
+    {
+      doReceive(*context);
+    }
+    doReceive(*proxyContext_);
+    if (proxyEndpoint_.has_value())
+    {
+      // this device is announced once the configured proxy answered or timed out
+      probeDiscoveryProxy();
+    }
+    else
+    {
+      sendHello();
+    }
   });
+  if (ownsIOContext_)
+  {
+    thread_ = std::thread([this]() { ioContext_->run(); });
+  }
 }
 
 bool DiscoveryService::running() const
@@ -60,68 +359,100 @@ bool DiscoveryService::running() const
   return running_.load();
 }
 
-void DiscoveryService::setLocation(const BICEPS::PM::LocationDetailType& locationDetail)
+bool DiscoveryService::managed() const
 {
-  std::string ctxt = "sdc.ctxt.loc:/sdc.ctxt.loc.detail/?";
-  ctxt += "fac=" + locationDetail.Facility.value_or("");
-  ctxt += "&bldng=" + locationDetail.Building.value_or("");
-  ctxt += "&poc=" + locationDetail.PoC.value_or("");
-  ctxt += "&flr=" + locationDetail.Floor.value_or("");
-  ctxt += "&rm=" + locationDetail.Room.value_or("");
-  ctxt += "&bed=" + locationDetail.Bed.value_or("");
-  scopes_.emplace_back(WS::ADDRESSING::URIType(ctxt));
+  return managed_.load();
 }
 
-void DiscoveryService::doReceive()
+DiscoveryStatistics DiscoveryService::statistics() const
 {
-  if (running_.load())
+  DiscoveryStatistics statistics;
+  for (const auto& context : interfaces_)
   {
-    socket_.async_receive_from(
-        asio::buffer(receiveBuffer_->data(), receiveBuffer_->size()), senderEndpoint_,
-        [this](const std::error_code& error, std::size_t bytesRecvd) {
-          LOG(LogLevel::DEBUG, "Received " << bytesRecvd << " bytes, ec: " << error.message());
-          // null terminate whatever received
-          receiveBuffer_->at(bytesRecvd) = '\0';
-          if (!error)
-          {
-            handleUDPMessage(bytesRecvd);
-          }
-          doReceive();
-        });
+    statistics.received += context->receiver.received();
+    statistics.dropped += context->receiver.dropped();
   }
+  statistics.received += proxyContext_->receiver.received();
+  statistics.dropped += proxyContext_->receiver.dropped() + droppedMessages_.load();
+  statistics.answered = answeredMessages_.load();
+  return statistics;
 }
 
-asio::ip::address_v4 DiscoveryService::addressFromString(const char* addressString)
+void DiscoveryService::setDiscoveryProxy(const asio::ip::udp::endpoint& proxy)
 {
-  asio::ip::address_v4::bytes_type addressBytes;
-  if (inet_pton(AF_INET, addressString, &addressBytes) <= 0)
+  if (!started_)
   {
-    throw std::runtime_error("Cannot create ip address from string!");
+    proxyConfigured_ = true;
+    selectDiscoveryProxy(proxy, toSoapOverUdpAddress(proxy), nullptr);
+    return;
   }
-  return asio::ip::address_v4(addressBytes);
+  asio::post(strand_, [this, proxy]() {
+    proxyConfigured_ = true;
+    selectDiscoveryProxy(proxy, toSoapOverUdpAddress(proxy), nullptr);
+    probeDiscoveryProxy();
+  });
 }
 
-void DiscoveryService::handleUDPMessage(std::size_t bytesRecvd)
+void DiscoveryService::setLocation(TargetId target,
+                                   const BICEPS::PM::LocationDetailType& locationDetail)
 {
-  const auto senderAddress = senderEndpoint_.address().to_string();
-  LOG(LogLevel::DEBUG, "Received " << bytesRecvd << " bytes from " << senderAddress << "\n"
-                                   << receiveBuffer_->data());
+  std::string ctxt = "sdc.ctxt.loc:/sdc.ctxt.loc.detail/?";
+  ctxt += "fac=" + locationDetail.Facility.value_or("");
+  ctxt += "&bldng=" + locationDetail.Building.value_or("");
+  ctxt += "&poc=" + locationDetail.PoC.value_or("");
+  ctxt += "&flr=" + locationDetail.Floor.value_or("");
+  ctxt += "&rm=" + locationDetail.Room.value_or("");
+  ctxt += "&bed=" + locationDetail.Bed.value_or("");
+  auto& context = *targets_.at(target);
+  std::lock_guard<std::mutex> lock(descriptionMutex_);
+  context.scopes.emplace_back(WS::ADDRESSING::URIType(ctxt));
+  context.probeMatcher.setScopes(context.scopes);
+  invalidateTemplates(context);
+}
+
+void DiscoveryService::doReceive(InterfaceContext& context)
+{
+  context.receiver.start([this, &context](char* message, std::size_t size,
+                                          const asio::ip::udp::endpoint& sender) {
+    handleUDPMessage(context, message, size, sender);
+  });
+}
+
+void DiscoveryService::handleUDPMessage(InterfaceContext& context, char* message,
+                                        std::size_t size, const asio::ip::udp::endpoint& sender)
+{
+  const auto senderAddress = sender.address().to_string();
+  LOG(LogLevel::DEBUG, "Received " << size << " bytes from " << senderAddress << "\n" << message);
 
   rapidxml::xml_document<> doc;
   try
   {
-    doc.parse<rapidxml::parse_fastest>(receiveBuffer_->data());
+    doc.parse<rapidxml::parse_fastest>(message);
   }
   catch (const rapidxml::parse_error& e)
   {
-    LOG(LogLevel::ERROR, "ParseError at " << *e.where<char>() << " ("
-                                          << e.where<char>() - receiveBuffer_->data()
+    LOG(LogLevel::ERROR, "ParseError at " << *e.where<char>() << " (" << e.where<char>() - message
                                           << "): " << e.what());
+    ++droppedMessages_;
+    return;
   }
   auto* envelopeNode = doc.first_node("Envelope", MDPWS::WS_NS_SOAP_ENVELOPE);
   if (envelopeNode == nullptr)
   {
     LOG(LogLevel::ERROR, "Cannot find soap envelope node in received message!");
+    ++droppedMessages_;
+    return;
+  }
+  // drop repetitions before the message model is built from the body
+  const auto* headerNode = envelopeNode->first_node("Header", MDPWS::WS_NS_SOAP_ENVELOPE);
+  const auto* messageIdNode = headerNode != nullptr
+                                  ? headerNode->first_node("MessageID", MDPWS::WS_NS_ADDRESSING)
+                                  : nullptr;
+  if (messageIdNode != nullptr && context.receivedMessageIds.isDuplicate(
+                                      {messageIdNode->value(), messageIdNode->value_size()}))
+  {
+    LOG(LogLevel::DEBUG, "Dropping repeated message from " << senderAddress);
+    ++droppedMessages_;
     return;
   }
   std::unique_ptr<MESSAGEMODEL::Envelope> envelope;
@@ -133,32 +464,52 @@ void DiscoveryService::handleUDPMessage(std::size_t bytesRecvd)
   catch (ExpectedElement& e)
   {
     LOG(LogLevel::ERROR, "ExpectedElement " << e.ns() << ":" << e.name() << " not encountered");
+    ++droppedMessages_;
+    return;
+  }
+  catch (const std::runtime_error& e)
+  {
+    LOG(LogLevel::ERROR, "Cannot parse received message: " << e.what());
+    ++droppedMessages_;
     return;
   }
 
-  if (envelope->Body.Probe.has_value())
+  if (&context == proxyContext_.get() &&
+      (envelope->Body.Probe.has_value() || envelope->Body.Resolve.has_value()))
+  {
+    // only the discovery proxy sends to its socket, it does not search for devices through it
+    LOG(LogLevel::DEBUG, "Ignoring request on the discovery proxy socket from " << senderAddress);
+  }
+  else if (envelope->Body.Probe.has_value())
   {
     LOG(LogLevel::INFO, "Received Probe from " << senderAddress);
-    handleProbe(*envelope);
+    handleProbe(context, *envelope, sender);
   }
   else if (envelope->Body.Bye.has_value())
   {
     LOG(LogLevel::INFO, "Received WS-Discovery Bye message from " << senderAddress);
+    handleDiscoveryProxyAnnouncement(context, *envelope);
   }
   else if (envelope->Body.Hello.has_value())
   {
     LOG(LogLevel::INFO, "Received WS-Discovery Hello message from " << senderAddress);
+    handleDiscoveryProxyAnnouncement(context, *envelope);
   }
   else if (envelope->Body.ProbeMatches.has_value())
   {
     LOG(LogLevel::INFO, "Received WS-Discovery ProbeMatches message from " << senderAddress);
+    if (!proxyProbeId_.empty() && envelope->Header.RelatesTo.has_value() &&
+        envelope->Header.RelatesTo.value() == proxyProbeId_)
+    {
+      discoveryProxyAnswered(*envelope);
+    }
   }
   else if (envelope->Body.Resolve.has_value())
   {
     LOG(LogLevel::INFO, "Received WS-Discovery Resolve message from "
                             << senderAddress << " asking for EndpointReference "
                             << envelope->Body.Resolve->EndpointReference.Address);
-    handleResolve(*envelope);
+    handleResolve(context, *envelope, sender);
   }
   else if (envelope->Body.ResolveMatches.has_value())
   {
@@ -173,213 +524,433 @@ void DiscoveryService::handleUDPMessage(std::size_t bytesRecvd)
 
 void DiscoveryService::sendHello()
 {
-  messagingContext_.resetInstanceId();
-  // Construct Hello Message
-  auto message = std::make_unique<MESSAGEMODEL::Envelope>();
-  buildHelloMessage(*message);
-  MESSAGEMODEL::Envelope::HeaderType::AppSequenceType appSequence(
-      messagingContext_.getInstanceId(), messagingContext_.getNextMessageCounter());
-  message->Header.AppSequence = appSequence;
-  // Serialize and send
-  MessageSerializer serializer;
-  serializer.serialize(*message);
-  auto msg = std::make_shared<std::string>(serializer.str());
   LOG(LogLevel::INFO, "Sending hello message...");
-  socket_.async_send_to(
-      asio::buffer(*msg), multicastEndpoint_,
-      [msg](const std::error_code& ec, const std::size_t bytesTransferred) {
-        if (ec)
-        {
-          LOG(LogLevel::ERROR,
-              "Error while sending Hello: ec " << ec.value() << ": " << ec.message());
-          return;
-        }
-        LOG(LogLevel::DEBUG, "Sent hello msg (" << bytesTransferred << " bytes): \n" << *msg);
-      });
+  announced_ = true;
+  announce(&MessageTemplates::hello, &DiscoveryService::buildHelloMessage,
+           std::chrono::milliseconds(MDPWS::APP_MAX_DELAY), "Hello", {});
 }
 
-void DiscoveryService::buildHelloMessage(MESSAGEMODEL::Envelope& envelope)
+void DiscoveryService::buildHelloMessage(const TargetContext& target,
+                                         const InterfaceContext& context,
+                                         MESSAGEMODEL::Envelope& envelope)
 {
   envelope.Header.Action = WS::ADDRESSING::URIType(MDPWS::WS_ACTION_HELLO);
-  envelope.Header.To = WS::ADDRESSING::URIType(MDPWS::WS_DISCOVERY_URN);
-  envelope.Header.MessageID = WS::ADDRESSING::URIType{MicroSDC::calculateMessageID()};
   auto& hello = envelope.Body.Hello = WS::DISCOVERY::HelloType(
-      WS::ADDRESSING::EndpointReferenceType(endpointReference_), metadataVersion_);
-  if (!scopes_.empty())
+      WS::ADDRESSING::EndpointReferenceType(target.config.endpointReference),
+      target.config.metadataVersion);
+  if (!target.scopes.empty())
   {
-    hello->Scopes = scopes_;
+    hello->Scopes = target.scopes;
   }
-  if (!types_.empty())
+  if (!target.config.types.empty())
   {
-    hello->Types = types_;
+    hello->Types = target.config.types;
   }
-  if (!xAddresses_.empty())
+  if (const auto& xAddresses = target.config.xAddresses[context.index]; !xAddresses.empty())
   {
-    hello->XAddrs = xAddresses_;
+    hello->XAddrs = xAddresses;
   }
 }
 
-void DiscoveryService::sendBye()
+void DiscoveryService::sendBye(std::function<void()> onSent)
 {
-  // Construct Bye Message
-  auto message = std::make_unique<MESSAGEMODEL::Envelope>();
-  buildByeMessage(*message);
-  MESSAGEMODEL::Envelope::HeaderType::AppSequenceType appSequence(
-      messagingContext_.getInstanceId(), messagingContext_.getNextMessageCounter());
-  message->Header.AppSequence = appSequence;
-  // Serialize and send
-  MessageSerializer serializer;
-  serializer.serialize(*message);
-  auto msg = std::make_shared<std::string>(serializer.str());
   LOG(LogLevel::INFO, "Sending bye message...");
-  socket_.async_send_to(asio::buffer(*msg), multicastEndpoint_,
-                        [msg](const std::error_code& ec, const std::size_t bytesTransferred) {
-                          if (ec)
-                          {
-                            LOG(LogLevel::ERROR, "Error while sending Bye: ec "
-                                                     << ec.value() << ": " << ec.message());
-                            return;
-                          }
-                          LOG(LogLevel::DEBUG, "Sent bye msg (" << bytesTransferred << " bytes): \n"
-                                                                << *msg);
-                        });
+  announce(&MessageTemplates::bye, &DiscoveryService::buildByeMessage,
+           std::chrono::milliseconds(0), "Bye", std::move(onSent));
+}
+
+void DiscoveryService::announce(TemplateMember messageTemplate, BuildFunction build,
+                                std::chrono::milliseconds maxInitialDelay,
+                                const char* messageName, std::function<void()> onSent)
+{
+  const auto renderFor = [&](TargetContext& target, InterfaceContext& context,
+                             std::string_view to) {
+    const WS::DISCOVERY::AppSequenceType appSequence(
+        target.messagingContext.getInstanceId(), target.messagingContext.getNextMessageCounter());
+    const auto messageId = MicroSDC::calculateMessageID();
+    DiscoveryMessageTemplate::Slots slots;
+    slots.messageId = messageId;
+    slots.to = to;
+    slots.appSequence = &appSequence;
+    return render(target, context, messageTemplate, build, slots);
+  };
+  // onSent is called once the messages of all targets were sent on the last interface
+  const auto transmissions = managed_.load() ? targets_.size()
+                                             : targets_.size() * interfaces_.size();
+  auto pending = std::make_shared<std::size_t>(transmissions);
+  const auto onDone = [pending, onSent = std::move(onSent)]() {
+    if (--*pending == 0 && onSent)
+    {
+      onSent();
+    }
+  };
+  for (const auto& target : targets_)
+  {
+    if (managed_.load())
+    {
+      // the proxy is told the addresses of the interface it is reached on
+      proxyContext_->scheduler.schedule(renderFor(*target, *proxyInterface_, proxyAddress_),
+                                        proxyEndpoint_.value(), TransmissionScheduler::UNICAST,
+                                        maxInitialDelay, messageName, onDone);
+      continue;
+    }
+    for (const auto& context : interfaces_)
+    {
+      context->scheduler.schedule(renderFor(*target, *context, MDPWS::WS_DISCOVERY_URN),
+                                  context->multicastEndpoint, TransmissionScheduler::MULTICAST,
+                                  maxInitialDelay, messageName, onDone);
+    }
+  }
 }
 
-void DiscoveryService::buildByeMessage(MESSAGEMODEL::Envelope& envelope)
+void DiscoveryService::buildByeMessage(const TargetContext& target,
+                                       const InterfaceContext& context,
+                                       MESSAGEMODEL::Envelope& envelope)
 {
   envelope.Header.Action = WS::ADDRESSING::URIType(MDPWS::WS_ACTION_BYE);
-  envelope.Header.To = WS::ADDRESSING::URIType(MDPWS::WS_DISCOVERY_URN);
-  envelope.Header.MessageID = WS::ADDRESSING::URIType{MicroSDC::calculateMessageID()};
-  auto& bye = envelope.Body.Bye =
-      WS::DISCOVERY::ByeType(WS::ADDRESSING::EndpointReferenceType(endpointReference_));
-  if (!scopes_.empty())
+  auto& bye = envelope.Body.Bye = WS::DISCOVERY::ByeType(
+      WS::ADDRESSING::EndpointReferenceType(target.config.endpointReference));
+  if (!target.scopes.empty())
   {
-    bye->Scopes = scopes_;
+    bye->Scopes = target.scopes;
   }
-  if (!types_.empty())
+  if (!target.config.types.empty())
   {
-    bye->Types = types_;
+    bye->Types = target.config.types;
   }
-  if (!xAddresses_.empty())
+  if (const auto& xAddresses = target.config.xAddresses[context.index]; !xAddresses.empty())
   {
-    bye->XAddrs = xAddresses_;
+    bye->XAddrs = xAddresses;
   }
 }
 
-void DiscoveryService::handleProbe(const MESSAGEMODEL::Envelope& envelope)
+void DiscoveryService::handleProbe(InterfaceContext& context,
+                                   const MESSAGEMODEL::Envelope& envelope,
+                                   const asio::ip::udp::endpoint& sender)
 {
-  auto responseMessage = std::make_unique<MESSAGEMODEL::Envelope>();
-  buildProbeMatchMessage(*responseMessage, envelope);
-  MessageSerializer serializer;
-  serializer.serialize(*responseMessage);
-  LOG(LogLevel::INFO, "Sending ProbeMatch");
-  auto msg = std::make_shared<std::string>(serializer.str());
-  socket_.async_send_to(
-      asio::buffer(*msg), senderEndpoint_,
-      [msg](const std::error_code& ec, const std::size_t bytesTransferred) {
-        if (ec)
-        {
-          LOG(LogLevel::ERROR,
-              "Error while sending ProbeMatch: ec " << ec.value() << ": " << ec.message());
-          return;
-        }
-        LOG(LogLevel::DEBUG, "Sent ProbeMatch msg (" << bytesTransferred << " bytes): \n" << *msg);
-      });
+  for (const auto& target : targets_)
+  {
+    {
+      std::lock_guard<std::mutex> lock(descriptionMutex_);
+      if (!target->probeMatcher.matches(envelope.Body.Probe.value()))
+      {
+        LOG(LogLevel::DEBUG, "Ignoring Probe not matching " << target->config.endpointReference);
+        continue;
+      }
+    }
+    answer(*target, context, envelope, sender, &MessageTemplates::probeMatches,
+           &DiscoveryService::buildProbeMatchMessage, "ProbeMatch");
+  }
 }
 
-void DiscoveryService::handleResolve(const MESSAGEMODEL::Envelope& envelope)
+void DiscoveryService::fillDirectedProbeMatches(TargetId target,
+                                                const WS::DISCOVERY::ProbeType& probe,
+                                                MESSAGEMODEL::Envelope& envelope)
 {
-  if (envelope.Body.Resolve->EndpointReference.Address != endpointReference_)
+  auto& context = *targets_.at(target);
+  auto& probeMatches = envelope.Body.ProbeMatches = WS::DISCOVERY::ProbeMatchesType({});
+  envelope.Header.Action = WS::ADDRESSING::URIType(MDPWS::WS_ACTION_PROBE_MATCHES);
+  envelope.Header.AppSequence = WS::DISCOVERY::AppSequenceType(
+      context.messagingContext.getInstanceId(), context.messagingContext.getNextMessageCounter());
+  std::lock_guard<std::mutex> lock(descriptionMutex_);
+  if (!context.probeMatcher.matches(probe))
   {
+    LOG(LogLevel::DEBUG, "Answering directed Probe not matching this device without match");
     return;
   }
-  auto responseMessage = std::make_unique<MESSAGEMODEL::Envelope>();
-  buildResolveMatchMessage(*responseMessage, envelope);
-  MessageSerializer serializer;
-  serializer.serialize(*responseMessage);
-  LOG(LogLevel::INFO, "Sending ResolveMatch");
-  auto msg = std::make_shared<std::string>(serializer.str());
-  socket_.async_send_to(asio::buffer(*msg), senderEndpoint_,
-                        [msg](const std::error_code& ec, const std::size_t bytesTransferred) {
-                          if (ec)
-                          {
-                            LOG(LogLevel::ERROR, "Error while sending ResolveMatch: ec "
-                                                     << ec.value() << ": " << ec.message());
-                            return;
-                          }
-                          LOG(LogLevel::DEBUG, "Sent ResolveMatch msg (" << bytesTransferred
-                                                                         << " bytes): \n"
-                                                                         << *msg);
-                        });
-}
-
-void DiscoveryService::buildProbeMatchMessage(MESSAGEMODEL::Envelope& envelope,
-                                              const MESSAGEMODEL::Envelope& request)
-{
-  auto& probeMatches = envelope.Body.ProbeMatches = WS::DISCOVERY::ProbeMatchesType({});
-  // TODO: check for match
   auto& match = probeMatches->ProbeMatch.emplace_back(
-      WS::ADDRESSING::EndpointReferenceType(endpointReference_), metadataVersion_);
-  if (!scopes_.empty())
+      WS::ADDRESSING::EndpointReferenceType(context.config.endpointReference),
+      context.config.metadataVersion);
+  if (!context.scopes.empty())
   {
-    match.Scopes = scopes_;
+    match.Scopes = context.scopes;
   }
-  if (!types_.empty())
+  if (!context.config.types.empty())
   {
-    match.Types = types_;
+    match.Types = context.config.types;
   }
-  if (!xAddresses_.empty())
+  WS::DISCOVERY::UriListType xAddresses;
+  for (const auto& interfaceAddresses : context.config.xAddresses)
   {
-    match.XAddrs = xAddresses_;
+    for (const auto& xAddress : interfaceAddresses)
+    {
+      if (std::find(xAddresses.begin(), xAddresses.end(), xAddress) == xAddresses.end())
+      {
+        xAddresses.emplace_back(xAddress);
+      }
+    }
   }
-
-  envelope.Header.Action = WS::ADDRESSING::URIType(MDPWS::WS_ACTION_PROBE_MATCHES);
-  if (request.Header.ReplyTo.has_value())
+  if (!xAddresses.empty())
   {
-    envelope.Header.To = request.Header.ReplyTo->Address;
+    match.XAddrs = std::move(xAddresses);
   }
-  else
+  ++answeredMessages_;
+}
+
+void DiscoveryService::handleResolve(InterfaceContext& context,
+                                     const MESSAGEMODEL::Envelope& envelope,
+                                     const asio::ip::udp::endpoint& sender)
+{
+  const auto& endpointReference = envelope.Body.Resolve->EndpointReference.Address;
+  for (const auto& target : targets_)
   {
-    envelope.Header.To = WS::ADDRESSING::URIType(MDPWS::WS_ADDRESSING_ANONYMOUS);
+    if (target->config.endpointReference == endpointReference)
+    {
+      answer(*target, context, envelope, sender, &MessageTemplates::resolveMatches,
+             &DiscoveryService::buildResolveMatchMessage, "ResolveMatch");
+      return;
+    }
   }
+}
+
+void DiscoveryService::answer(TargetContext& target, InterfaceContext& context,
+                              const MESSAGEMODEL::Envelope& request,
+                              const asio::ip::udp::endpoint& sender,
+                              TemplateMember messageTemplate, BuildFunction build,
+                              const char* messageName)
+{
+  const WS::DISCOVERY::AppSequenceType appSequence(
+      target.messagingContext.getInstanceId(), target.messagingContext.getNextMessageCounter());
+  const auto messageId = MicroSDC::calculateMessageID();
+  DiscoveryMessageTemplate::Slots slots;
+  slots.messageId = messageId;
+  slots.to = replyTo(request);
   if (request.Header.MessageID.has_value())
   {
-    envelope.Header.RelatesTo = WS::ADDRESSING::RelatesToType(request.Header.MessageID.value());
+    slots.relatesTo = request.Header.MessageID.value();
+  }
+  slots.appSequence = &appSequence;
+  LOG(LogLevel::INFO, "Sending " << messageName << " of " << target.config.endpointReference);
+  ++answeredMessages_;
+  context.scheduler.schedule(render(target, context, messageTemplate, build, slots), sender,
+                             TransmissionScheduler::UNICAST,
+                             std::chrono::milliseconds(MDPWS::APP_MAX_DELAY), messageName);
+}
+
+void DiscoveryService::buildProbeMatchMessage(const TargetContext& target,
+                                              const InterfaceContext& context,
+                                              MESSAGEMODEL::Envelope& envelope)
+{
+  auto& probeMatches = envelope.Body.ProbeMatches = WS::DISCOVERY::ProbeMatchesType({});
+  auto& match = probeMatches->ProbeMatch.emplace_back(
+      WS::ADDRESSING::EndpointReferenceType(target.config.endpointReference),
+      target.config.metadataVersion);
+  if (!target.scopes.empty())
+  {
+    match.Scopes = target.scopes;
+  }
+  if (!target.config.types.empty())
+  {
+    match.Types = target.config.types;
   }
-  envelope.Header.MessageID = WS::ADDRESSING::URIType{MicroSDC::calculateMessageID()};
+  if (const auto& xAddresses = target.config.xAddresses[context.index]; !xAddresses.empty())
+  {
+    match.XAddrs = xAddresses;
+  }
+
+  envelope.Header.Action = WS::ADDRESSING::URIType(MDPWS::WS_ACTION_PROBE_MATCHES);
 }
 
-void DiscoveryService::buildResolveMatchMessage(MESSAGEMODEL::Envelope& envelope,
-                                                const MESSAGEMODEL::Envelope& request)
+void DiscoveryService::buildResolveMatchMessage(const TargetContext& target,
+                                                const InterfaceContext& context,
+                                                MESSAGEMODEL::Envelope& envelope)
 {
   auto& resolveMatches = envelope.Body.ResolveMatches = WS::DISCOVERY::ResolveMatchesType({});
   auto& match = resolveMatches->ResolveMatch.emplace_back(
-      WS::ADDRESSING::EndpointReferenceType(endpointReference_), metadataVersion_);
-  if (!scopes_.empty())
+      WS::ADDRESSING::EndpointReferenceType(target.config.endpointReference),
+      target.config.metadataVersion);
+  if (!target.scopes.empty())
   {
-    match.Scopes = scopes_;
+    match.Scopes = target.scopes;
   }
-  if (!types_.empty())
+  if (!target.config.types.empty())
   {
-    match.Types = types_;
+    match.Types = target.config.types;
   }
-  if (!xAddresses_.empty())
+  if (const auto& xAddresses = target.config.xAddresses[context.index]; !xAddresses.empty())
   {
-    match.XAddrs = xAddresses_;
+    match.XAddrs = xAddresses;
   }
 
   envelope.Header.Action = WS::ADDRESSING::URIType(MDPWS::WS_ACTION_RESOLVE_MATCHES);
-  if (request.Header.ReplyTo.has_value())
+}
+
+void DiscoveryService::selectDiscoveryProxy(asio::ip::udp::endpoint endpoint,
+                                            std::string address, InterfaceContext* context)
+{
+  if (context == nullptr || context == proxyContext_.get())
   {
-    envelope.Header.To = request.Header.ReplyTo->Address;
+    const auto sameFamily =
+        std::find_if(interfaces_.begin(), interfaces_.end(), [&endpoint](const auto& c) {
+          return c->address.is_v6() == endpoint.address().is_v6();
+        });
+    context = sameFamily != interfaces_.end() ? sameFamily->get() : interfaces_.front().get();
+  }
+  if (endpoint.address().is_v6() && context->address.is_v6())
+  {
+    // a link local address of the proxy is only valid on the interface it was announced on
+    auto address6 = endpoint.address().to_v6();
+    if (address6.is_link_local() && address6.scope_id() == 0)
+    {
+      address6.scope_id(context->address.to_v6().scope_id());
+      endpoint.address(address6);
+    }
+  }
+  if (endpoint.address().is_v4() && proxyContext_->address.is_v6())
+  {
+    endpoint.address(asio::ip::make_address_v6(asio::ip::v4_mapped, endpoint.address().to_v4()));
+  }
+  proxyEndpoint_ = endpoint;
+  proxyAddress_ = std::move(address);
+  proxyInterface_ = context;
+  LOG(LogLevel::INFO, "Using discovery proxy " << proxyAddress_ << " at "
+                                               << endpoint.address().to_string() << ":"
+                                               << endpoint.port());
+}
+
+void DiscoveryService::probeDiscoveryProxy()
+{
+  proxyProbeId_ = MicroSDC::calculateMessageID();
+  MESSAGEMODEL::Envelope envelope;
+  envelope.Header.Action = WS::ADDRESSING::URIType(MDPWS::WS_ACTION_PROBE);
+  envelope.Header.MessageID = WS::ADDRESSING::URIType(proxyProbeId_);
+  envelope.Header.To = WS::ADDRESSING::URIType(proxyAddress_);
+  auto& probe = envelope.Body.Probe = WS::DISCOVERY::ProbeType();
+  probe->Types = WS::DISCOVERY::QNameListType();
+  probe->Types->emplace_back(MDPWS::WS_NS_DISCOVERY, MDPWS::WS_DISCOVERY_PROXY_TYPE);
+  MessageSerializer serializer;
+  serializer.serialize(envelope);
+  auto buffer = bufferPool_.acquire();
+  *buffer = serializer.str();
+  proxyContext_->scheduler.schedule(std::move(buffer), proxyEndpoint_.value(),
+                                    TransmissionScheduler::UNICAST, std::chrono::milliseconds(0),
+                                    "Probe");
+  proxyTimer_.expires_after(std::chrono::seconds(MDPWS::DP_MAX_TIMEOUT));
+  proxyTimer_.async_wait([this](const std::error_code& ec) {
+    if (!ec)
+    {
+      discoveryProxyLost();
+    }
+  });
+}
+
+void DiscoveryService::discoveryProxyAnswered(const MESSAGEMODEL::Envelope& envelope)
+{
+  proxyProbeId_.clear();
+  for (const auto& match : envelope.Body.ProbeMatches->ProbeMatch)
+  {
+    if (isDiscoveryProxy(match))
+    {
+      proxyAddress_ = match.EndpointReference.Address;
+      break;
+    }
+  }
+  scheduleDiscoveryProxyCheck();
+  if (!managed_.exchange(true))
+  {
+    LOG(LogLevel::INFO, "Entering managed mode with discovery proxy " << proxyAddress_);
+    sendHello();
+  }
+}
+
+void DiscoveryService::scheduleDiscoveryProxyCheck()
+{
+  proxyTimer_.expires_after(PROXY_CHECK_INTERVAL);
+  proxyTimer_.async_wait([this](const std::error_code& ec) {
+    if (!ec)
+    {
+      probeDiscoveryProxy();
+    }
+  });
+}
+
+void DiscoveryService::discoveryProxyLost()
+{
+  LOG(LogLevel::WARNING, "Lost discovery proxy " << proxyAddress_);
+  proxyProbeId_.clear();
+  if (proxyConfigured_)
+  {
+    scheduleDiscoveryProxyCheck();
   }
   else
   {
-    envelope.Header.To = WS::ADDRESSING::URIType(MDPWS::WS_ADDRESSING_ANONYMOUS);
+    proxyTimer_.cancel();
+    proxyEndpoint_.reset();
+    proxyAddress_.clear();
+    proxyInterface_ = nullptr;
   }
-  if (request.Header.MessageID.has_value())
+  if (managed_.exchange(false) || !announced_)
+  {
+    LOG(LogLevel::INFO, "Announcing by multicast");
+    sendHello();
+  }
+}
+
+void DiscoveryService::handleDiscoveryProxyAnnouncement(InterfaceContext& context,
+                                                        const MESSAGEMODEL::Envelope& envelope)
+{
+  if (envelope.Body.Bye.has_value())
+  {
+    if (proxyEndpoint_.has_value() && envelope.Body.Bye->EndpointReference.Address == proxyAddress_)
+    {
+      discoveryProxyLost();
+    }
+    return;
+  }
+  const auto& hello = envelope.Body.Hello.value();
+  if (!isDiscoveryProxy(hello) ||
+      (proxyConfigured_ && hello.EndpointReference.Address != proxyAddress_))
+  {
+    return;
+  }
+  for (const auto& xAddr : hello.XAddrs.value_or(WS::DISCOVERY::UriListType()))
+  {
+    if (const auto endpoint = parseSoapOverUdpAddress(xAddr); endpoint.has_value())
+    {
+      // the Hello shows the proxy answers, announce this device to it right away
+      selectDiscoveryProxy(endpoint.value(), hello.EndpointReference.Address, &context);
+      proxyProbeId_.clear();
+      scheduleDiscoveryProxyCheck();
+      managed_.store(true);
+      sendHello();
+      return;
+    }
+  }
+  LOG(LogLevel::WARNING, "Ignoring discovery proxy " << hello.EndpointReference.Address
+                                                     << " without SOAP-over-UDP address");
+}
+
+void DiscoveryService::invalidateTemplates(TargetContext& target)
+{
+  for (auto& templates : target.templates)
+  {
+    templates = MessageTemplates();
+  }
+}
+
+BufferPool::Buffer DiscoveryService::render(TargetContext& target,
+                                            const InterfaceContext& context,
+                                            TemplateMember messageTemplate, BuildFunction build,
+                                            const DiscoveryMessageTemplate::Slots& slots)
+{
+  auto buffer = bufferPool_.acquire();
+  std::lock_guard<std::mutex> lock(descriptionMutex_);
+  auto& cached = target.templates[context.index].*messageTemplate;
+  if (!cached.has_value())
+  {
+    MESSAGEMODEL::Envelope envelope;
+    (this->*build)(target, context, envelope);
+    cached.emplace(envelope);
+  }
+  cached->render(*buffer, slots);
+  return buffer;
+}
+
+std::string_view DiscoveryService::replyTo(const MESSAGEMODEL::Envelope& request)
+{
+  if (request.Header.ReplyTo.has_value())
   {
-    envelope.Header.RelatesTo = WS::ADDRESSING::RelatesToType(request.Header.MessageID.value());
+    return request.Header.ReplyTo->Address;
   }
-  envelope.Header.MessageID = WS::ADDRESSING::URIType{MicroSDC::calculateMessageID()};
+  return MDPWS::WS_ADDRESSING_ANONYMOUS;
 }
@@ -1,22 +1,74 @@
 #pragma once
 
+#include "BatchReceiver.hpp"
+#include "BufferPool.hpp"
+#include "DiscoveryMessageTemplate.hpp"
+#include "MessageIdCache.hpp"
 #include "MessagingContext.hpp"
+#include "ProbeMatcher.hpp"
+#include "TransmissionScheduler.hpp"
 #include "datamodel/MDPWSConstants.hpp"
 #include "datamodel/MessageModel.hpp"
 #include <array>
 #include <asio.hpp>
 #include <atomic>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string_view>
 #include <thread>
+#include <vector>
+
+/// @brief DiscoveryStatistics holds the counters of a DiscoveryService
+struct DiscoveryStatistics
+{
+  /// datagrams received on all interfaces
+  std::size_t received{0};
+  /// datagrams dropped for being too large, malformed or repeated, or by the kernel for a full
+  /// receive buffer
+  std::size_t dropped{0};
+  /// probes and resolves answered
+  std::size_t answered{0};
+};
 
 /// @brief DiscoveryService manages all discovery related communication like sending hello messages
-/// for discovery and replying to probes/resolves.
+/// for discovery and replying to probes/resolves. All network interfaces are served on a single
+/// strand, run by a thread of this service or by an io context shared with other components. Each
+/// interface has its own socket joining the discovery multicast group of its address
+/// family, so answers leave on the interface their request arrived on.
+/// A single DiscoveryService announces and answers for any number of target services, e.g. the
+/// devices of a MicroSDCHost, each with its own endpoint reference, scopes and AppSequence.
+/// In managed mode, i.e. while a discovery proxy answers, Hello and Bye are sent to the proxy by
+/// unicast instead of to the multicast group.
 class DiscoveryService
 {
 public:
+  /// identifies a target service by its position in the targets passed to the constructor
+  using TargetId = std::size_t;
+
+  /// @brief a target service, i.e. a device, announced on all interfaces
+  struct Target
+  {
+    /// the endpoint reference of the device
+    WS::ADDRESSING::EndpointReferenceType::AddressType endpointReference;
+    /// the types of the device
+    WS::DISCOVERY::QNameListType types;
+    /// addresses of the services exposed by the device, one list per interface in the order of
+    /// the interfaces
+    std::vector<WS::DISCOVERY::UriListType> xAddresses;
+    /// the version of the metadata of the device
+    WS::DISCOVERY::HelloType::MetadataVersionType metadataVersion{1};
+  };
+
   /// @brief Constructs DiscoveryService
-  DiscoveryService(WS::ADDRESSING::EndpointReferenceType::AddressType epr,
-                   WS::DISCOVERY::QNameListType types, WS::DISCOVERY::UriListType xAddresses,
-                   WS::DISCOVERY::HelloType::MetadataVersionType metadataVersion = 1);
+  /// @param interfaces the addresses of the network interfaces to announce the targets on. An
+  /// unspecified ipv4 address selects the default interface, an ipv6 address has to carry the
+  /// index of its interface as scope id.
+  /// @param targets the target services to announce and answer for
+  /// @param ioContext the io context to run on, shared with other components. A thread running an
+  /// io context of its own is started if none is given.
+  DiscoveryService(std::vector<asio::ip::address> interfaces, std::vector<Target> targets,
+                   std::shared_ptr<asio::io_context> ioContext = nullptr);
   DiscoveryService(const DiscoveryService&) = delete;
   DiscoveryService(DiscoveryService&&) = delete;
   DiscoveryService& operator=(const DiscoveryService&) = delete;
@@ -28,7 +80,9 @@ public:
   void start();
 
 
-  /// @brief stop the discovery service
+  /// @brief stop the discovery service after sending a Bye. Waits for the Bye and for the handlers
+  /// of the aborted receives and sends, so it must not be called on a thread running the io
+  /// context, e.g. in a handler or on a thread of the ExecutionContext.
   void stop();
 
 
@@ -36,82 +90,293 @@ public:
   /// @return whether this host runs
   bool running() const;
 
-  /// @brief sets a new location of this instance
+  /// @brief sets a new location of a target service
+  /// @param target the target service located
   /// @param locationDetail the location state information
-  void setLocation(const BICEPS::PM::LocationDetailType& locationDetail);
+  void setLocation(TargetId target, const BICEPS::PM::LocationDetailType& locationDetail);
+
+  /// @brief sets the discovery proxy to announce this device to instead of detecting one by its
+  /// multicast Hello. The proxy is probed periodically, this service operates in managed mode
+  /// while it answers within DP_MAX_TIMEOUT and falls back to multicast otherwise.
+  /// @param proxy the SOAP-over-UDP endpoint of the discovery proxy
+  void setDiscoveryProxy(const asio::ip::udp::endpoint& proxy);
+
+  /// @brief Returns whether this discovery service announces itself to a discovery proxy
+  /// @return whether this service operates in managed mode
+  bool managed() const;
+
+  /// @brief gets the counters of the received and answered discovery messages
+  /// @return a snapshot of the discovery statistics
+  DiscoveryStatistics statistics() const;
+
+  /// @brief answers a directed probe received over HTTP. Other than a probe received over UDP, a
+  /// directed probe not matching this device is answered with empty ProbeMatches. The match lists
+  /// the transport addresses of all interfaces, as the request may have arrived on any of them.
+  /// @param target the target service the probe was sent to
+  /// @param probe the received probe
+  /// @param[out] envelope the response to fill with the ProbeMatches body and its AppSequence
+  void fillDirectedProbeMatches(TargetId target, const WS::DISCOVERY::ProbeType& probe,
+                                MESSAGEMODEL::Envelope& envelope);
 
 private:
+  /// @brief the sockets of a network interface
+  struct InterfaceContext
+  {
+    /// @brief constructs the context of an interface
+    /// @param executor the strand of the socket
+    /// @param address the address of this device on the interface
+    /// @param index the position of the interface in interfaces_
+    /// @param targetCount the number of target services sharing the send rate of the interface
+    InterfaceContext(const TransmissionScheduler::Executor& executor,
+                     const asio::ip::address& address, std::size_t index, std::size_t targetCount);
+    /// the address of this device on the interface
+    const asio::ip::address address;
+    /// the position of the interface in interfaces_, selecting the transport addresses of targets
+    const std::size_t index;
+    /// sending and receiving socket for discovery messages on this interface
+    asio::ip::udp::socket socket;
+    /// multicast endpoint 239.255.255.250:3702 or [FF02::C]:3702 on this interface
+    asio::ip::udp::endpoint multicastEndpoint;
+    /// receives the datagrams of socket in batches
+    BatchReceiver receiver;
+    /// delays, repeats and rate limits the messages sent on socket
+    TransmissionScheduler scheduler;
+    /// MessageIDs of messages recently received on this interface to drop their repetitions
+    MessageIdCache receivedMessageIds;
+  };
+
+  /// @brief the pre-rendered messages of a target service on a single interface, rebuilt on first
+  /// use after invalidateTemplates()
+  struct MessageTemplates
+  {
+    /// pre-rendered Hello message
+    std::optional<DiscoveryMessageTemplate> hello;
+    /// pre-rendered Bye message
+    std::optional<DiscoveryMessageTemplate> bye;
+    /// pre-rendered ProbeMatches message
+    std::optional<DiscoveryMessageTemplate> probeMatches;
+    /// pre-rendered ResolveMatches message
+    std::optional<DiscoveryMessageTemplate> resolveMatches;
+  };
+
+  /// @brief the description and messages of a target service
+  struct TargetContext
+  {
+    /// @brief constructs the context of a target service
+    /// @param config the configuration of the target service
+    explicit TargetContext(Target config);
+    /// the configuration of this target service
+    const Target config;
+    /// scopes of this target service
+    WS::DISCOVERY::ScopesType scopes;
+    /// matches probes against the types and scopes
+    ProbeMatcher probeMatcher;
+    /// the AppSequence of the messages of this target service
+    MessagingContext messagingContext;
+    /// the message templates, one per interface in the order of the interfaces
+    std::vector<MessageTemplates> templates;
+  };
+
+  /// pointer to a function constructing a message of a target for an interface into an envelope
+  using BuildFunction = void (DiscoveryService::*)(const TargetContext&, const InterfaceContext&,
+                                                   MESSAGEMODEL::Envelope&);
+  /// pointer to the template of a message
+  using TemplateMember = std::optional<DiscoveryMessageTemplate> MessageTemplates::*;
+
   /// whether this discovery service runs
   std::atomic_bool running_{false};
-  /// thread of this host
+  /// whether the io context was created by this service and is run by thread_
+  const bool ownsIOContext_;
+  /// the io context running this service
+  const std::shared_ptr<asio::io_context> ioContext_;
+  /// serializes the handlers of this service, so a shared io context may be run by several threads
+  const TransmissionScheduler::Executor strand_;
+  /// thread running the io context if it is owned by this service
   std::thread thread_;
-  /// asio IO context for discovery service
-  asio::io_context ioContext_;
-  /// sending and receiving socket for discovery messages
-  asio::ip::udp::socket socket_;
-  /// multicast endpoint 239.255.255.250:3702
-  asio::ip::udp::endpoint multicastEndpoint_;
-  /// buffer for receving udp data
-  std::unique_ptr<std::array<char, MDPWS::MAX_ENVELOPE_SIZE + 1>> receiveBuffer_;
-  /// sending endpoint of a received packet
-  asio::ip::udp::endpoint senderEndpoint_;
-
-  /// messaging context of this discovery host
-  MessagingContext messagingContext_;
-  /// endpoint reference of this host
-  const WS::ADDRESSING::EndpointReferenceType::AddressType endpointReference_;
-  /// scopes provided by this instance of MicroSDC
-  WS::DISCOVERY::ScopesType scopes_;
-  /// types represented by the services implementing this device
-  WS::DISCOVERY::QNameListType types_;
-  /// addresses of the services exposed by this device
-  WS::DISCOVERY::UriListType xAddresses_;
-  /// the version of the metadata
-  const WS::DISCOVERY::HelloType::MetadataVersionType metadataVersion_;
-
-
-  /// @brief creates an endpoint v4 address from string
-  /// @return the ipv4 address
-  static asio::ip::address_v4 addressFromString(const char* addressString);
+  /// whether this service was started and not stopped since
+  bool started_{false};
+  /// the network interfaces discovery messages are exchanged on
+  std::vector<std::unique_ptr<InterfaceContext>> interfaces_;
+  /// the target services announced and answered for
+  std::vector<std::unique_ptr<TargetContext>> targets_;
+  /// buffers of outgoing messages
+  BufferPool bufferPool_;
+
+  /// protects the scopes, probe matchers and message templates of all targets
+  std::mutex descriptionMutex_;
+  /// received datagrams dropped for being malformed or repeated
+  std::atomic<std::size_t> droppedMessages_{0};
+  /// probes and resolves answered
+  std::atomic<std::size_t> answeredMessages_{0};
+
+  /// whether a Hello was sent since this service started
+  bool announced_{false};
+  /// whether Hello and Bye are sent to the discovery proxy instead of the multicast group
+  std::atomic_bool managed_{false};
+  /// sends to and receives from the discovery proxy on an ephemeral port, so its answers are not
+  /// taken by another socket sharing the discovery port
+  std::unique_ptr<InterfaceContext> proxyContext_;
+  /// whether the discovery proxy was configured instead of detected
+  bool proxyConfigured_{false};
+  /// the SOAP-over-UDP endpoint of the discovery proxy, if any
+  std::optional<asio::ip::udp::endpoint> proxyEndpoint_;
+  /// the endpoint reference address of the discovery proxy or its transport address if unknown
+  std::string proxyAddress_;
+  /// the interface whose addresses are announced to the discovery proxy
+  InterfaceContext* proxyInterface_{nullptr};
+  /// the MessageID of the Probe checking whether the discovery proxy answers
+  std::string proxyProbeId_;
+  /// expires when the discovery proxy has to be probed again or its answer timed out
+  asio::steady_timer proxyTimer_;
+
+
+  /// @brief calls a handler once the handlers of the receives and sends aborted by closing the
+  /// sockets returned, as they refer to this service. Runs on the strand.
+  /// @param onIdle called on the strand once no handler refers to this service anymore
+  void awaitAbortedOperations(std::function<void()> onIdle);
+
+  /// @brief opens the socket of an interface and joins the discovery multicast group on it
+  /// @param context the interface to open the socket of
+  static void openSocket(InterfaceContext& context);
 
   /// @brief handle incoming udp message packet by determine its type.
-  void handleUDPMessage(std::size_t bytesRecvd);
+  /// @param context the interface the message was received on
+  /// @param message the null terminated message
+  /// @param size the size of the message
+  /// @param sender the sender of the message
+  void handleUDPMessage(InterfaceContext& context, char* message, std::size_t size,
+                        const asio::ip::udp::endpoint& sender);
+
+  /// @brief drops the message templates of a target after its scopes changed. descriptionMutex_
+  /// has to be held.
+  /// @param target the target service whose description changed
+  static void invalidateTemplates(TargetContext& target);
+
+  /// @brief renders a message from its template into a pooled buffer, building the template first
+  /// if it was invalidated
+  /// @param target the target service the message describes
+  /// @param context the interface the message is sent on
+  /// @param messageTemplate the template of the message
+  /// @param build the function constructing the message the template is built from
+  /// @param slots the header fields of this message
+  /// @return the buffer holding the rendered message
+  BufferPool::Buffer render(TargetContext& target, const InterfaceContext& context,
+                            TemplateMember messageTemplate, BuildFunction build,
+                            const DiscoveryMessageTemplate::Slots& slots);
+
+  /// @brief opens the socket sending to the discovery proxy on an ephemeral port
+  /// @param context the context of the socket
+  /// @param dualStack whether to reach ipv4 and ipv6 discovery proxies
+  static void openProxySocket(InterfaceContext& context, bool dualStack);
+
+  /// @brief selects the discovery proxy managed mode uses
+  /// @param endpoint the SOAP-over-UDP endpoint of the proxy
+  /// @param address the endpoint reference address of the proxy or its transport address
+  /// @param context the interface the proxy was detected on, if any
+  void selectDiscoveryProxy(asio::ip::udp::endpoint endpoint, std::string address,
+                            InterfaceContext* context);
+
+  /// @brief sends a directed Probe for the discovery proxy type to the discovery proxy and waits
+  /// DP_MAX_TIMEOUT for its answer
+  void probeDiscoveryProxy();
 
-  /// @brief handle a WS-Discovery message of type PROBE
-  /// @param doc a pointer to the parsed xml document message
-  void handleProbe(const MESSAGEMODEL::Envelope& envelope);
+  /// @brief handles the answer of the discovery proxy, entering managed mode if not yet done
+  /// @param envelope the ProbeMatches answering the directed Probe
+  void discoveryProxyAnswered(const MESSAGEMODEL::Envelope& envelope);
+
+  /// @brief waits before checking again whether the discovery proxy answers
+  void scheduleDiscoveryProxyCheck();
+
+  /// @brief handles a discovery proxy that did not answer or said Bye by leaving managed mode
+  void discoveryProxyLost();
+
+  /// @brief handles a Hello or Bye of a discovery proxy
+  /// @param context the interface the message was received on
+  /// @param envelope the received message
+  void handleDiscoveryProxyAnnouncement(InterfaceContext& context,
+                                        const MESSAGEMODEL::Envelope& envelope);
+
+  /// @brief gets the destination of a reply to a given request
+  /// @param request the request to reply to
+  /// @return the ReplyTo address of the request or the anonymous address if not given
+  static std::string_view replyTo(const MESSAGEMODEL::Envelope& request);
+
+  /// @brief handle a WS-Discovery message of type PROBE. Each target matching the types and scopes
+  /// of the probe answers with its own ProbeMatches, the others do not answer.
+  /// @param context the interface the probe was received on
+  /// @param envelope the received probe
+  /// @param sender the sender of the probe
+  void handleProbe(InterfaceContext& context, const MESSAGEMODEL::Envelope& envelope,
+                   const asio::ip::udp::endpoint& sender);
 
   /// @brief handle a WS-Discovery message of type RESOLVE
-  /// @param doc a pointer to the parsed xml document message
-  void handleResolve(const MESSAGEMODEL::Envelope& envelope);
+  /// @param context the interface the resolve was received on
+  /// @param envelope the received resolve
+  /// @param sender the sender of the resolve
+  void handleResolve(InterfaceContext& context, const MESSAGEMODEL::Envelope& envelope,
+                     const asio::ip::udp::endpoint& sender);
+
+  /// @brief sends a match answering a probe or resolve of a target service
+  /// @param target the target service answering
+  /// @param context the interface the request was received on
+  /// @param request the received probe or resolve
+  /// @param sender the sender of the request
+  /// @param messageTemplate the template of the match
+  /// @param build the function constructing the match the template is built from
+  /// @param messageName the name of the match for logging
+  void answer(TargetContext& target, InterfaceContext& context,
+              const MESSAGEMODEL::Envelope& request, const asio::ip::udp::endpoint& sender,
+              TemplateMember messageTemplate, BuildFunction build, const char* messageName);
 
-  /// @brief registers for socket receive at any discovery multicast address and the configured
-  /// address of this device
-  void doReceive();
+  /// @brief starts receiving at the discovery multicast address of an interface
+  /// @param context the interface to receive on
+  void doReceive(InterfaceContext& context);
 
-  /// @breif sends a hello message to the multicast endpoint
+  /// @breif sends a hello message of every target to the discovery proxy in managed mode or to
+  /// the multicast endpoint of every interface otherwise
   void sendHello();
 
   /// @brief constructs a hello message into a given envelope
+  /// @param target the target service announced
+  /// @param context the interface the message is sent on
   /// @param[out] envelope the envelope to fill the hello message into
-  void buildHelloMessage(MESSAGEMODEL::Envelope& envelope);
+  void buildHelloMessage(const TargetContext& target, const InterfaceContext& context,
+                         MESSAGEMODEL::Envelope& envelope);
+
+  /// @brief sends a bye message of every target to the discovery proxy in managed mode or to the
+  /// multicast endpoint of every interface otherwise
+  /// @param onSent called after the last repetition of the message was sent on all interfaces
+  void sendBye(std::function<void()> onSent);
 
-  /// @breif sends a bye message to the multicast endpoint
-  void sendBye();
+  /// @brief sends a Hello or Bye of every target to the discovery proxy in managed mode or to the
+  /// multicast endpoint of every interface otherwise
+  /// @param messageTemplate the template of the message
+  /// @param build the function constructing the message the template is built from
+  /// @param maxInitialDelay the upper bound of the random delay before the first transmission
+  /// @param messageName the name of the message for logging
+  /// @param onSent called after the last repetition of the message was sent on all interfaces
+  void announce(TemplateMember messageTemplate, BuildFunction build,
+                std::chrono::milliseconds maxInitialDelay, const char* messageName,
+                std::function<void()> onSent);
 
   /// @brief constructs a bye message into a given envelope
+  /// @param target the target service saying bye
+  /// @param context the interface the message is sent on
   /// @param[out] envelope the envelope to fill the bye message into
-  void buildByeMessage(MESSAGEMODEL::Envelope& envelope);
+  void buildByeMessage(const TargetContext& target, const InterfaceContext& context,
+                       MESSAGEMODEL::Envelope& envelope);
 
   /// @brief constructs a probe match into a given envelope
+  /// @param target the target service matching
+  /// @param context the interface the message is sent on
   /// @param[out] envelope the envelope to fill the probe match into
-  /// @param request the probe request to construct the response from
-  void buildProbeMatchMessage(MESSAGEMODEL::Envelope& envelope,
-                              const MESSAGEMODEL::Envelope& request);
+  void buildProbeMatchMessage(const TargetContext& target, const InterfaceContext& context,
+                              MESSAGEMODEL::Envelope& envelope);
 
   /// @brief constructs a resolve match into a given envelope
+  /// @param target the target service resolved
+  /// @param context the interface the message is sent on
   /// @param[out] envelope the envelope to fill the resolve match into
-  /// @param request the resolve request to construct the response from
-  void buildResolveMatchMessage(MESSAGEMODEL::Envelope& envelope,
-                                const MESSAGEMODEL::Envelope& request);
+  void buildResolveMatchMessage(const TargetContext& target, const InterfaceContext& context,
+                                MESSAGEMODEL::Envelope& envelope);
 };
@@ -0,0 +1,25 @@
+#include "MessageIdCache.hpp"
+#include <algorithm>
+#include <functional>
+
+MessageIdCache::MessageIdCache(std::size_t capacity, std::chrono::milliseconds ttl)
+  : ttl_(ttl)
+  , entries_(std::max<std::size_t>(capacity, 1))
+{
+}
+
+bool MessageIdCache::isDuplicate(std::string_view messageId)
+{
+  const auto now = Clock::now();
+  const auto hash = std::hash<std::string_view>{}(messageId);
+  const auto duplicate =
+      std::any_of(entries_.begin(), entries_.end(),
+                  [&](const Entry& entry) { return entry.hash == hash && entry.expiry > now; });
+  if (duplicate)
+  {
+    return true;
+  }
+  entries_[next_] = Entry{hash, now + ttl_};
+  next_ = (next_ + 1) % entries_.size();
+  return false;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+/// @brief MessageIdCache remembers the hashes of recently received MessageIDs in a fixed size ring
+/// to detect repetitions of UDP messages. The oldest entry is overwritten once the ring is full and
+/// entries expire after a given time.
+class MessageIdCache
+{
+public:
+  /// @brief constructs an empty cache
+  /// @param capacity the number of MessageIDs remembered
+  /// @param ttl the time a MessageID is remembered
+  MessageIdCache(std::size_t capacity, std::chrono::milliseconds ttl);
+
+  /// @brief checks whether a MessageID was received before and remembers it otherwise
+  /// @param messageId the MessageID of a received message
+  /// @return whether the message is a duplicate of a message received within the ttl
+  bool isDuplicate(std::string_view messageId);
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  /// @brief a remembered MessageID
+  struct Entry
+  {
+    /// the hash of the MessageID
+    std::size_t hash{0};
+    /// the time the MessageID expires
+    Clock::time_point expiry;
+  };
+
+  /// the time a MessageID is remembered
+  const std::chrono::milliseconds ttl_;
+  /// the remembered MessageIDs
+  std::vector<Entry> entries_;
+  /// the position in entries_ written next
+  std::size_t next_{0};
+};
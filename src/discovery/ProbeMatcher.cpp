@@ -0,0 +1,170 @@
+#include "ProbeMatcher.hpp"
+#include "datamodel/MDPWSConstants.hpp"
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+  /// @brief gets the value of a hexadecimal digit
+  /// @param c the digit
+  /// @return the value of the digit or -1 if it is no hexadecimal digit
+  int hexValue(char c)
+  {
+    if (c >= '0' && c <= '9')
+    {
+      return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+      return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+      return c - 'A' + 10;
+    }
+    return -1;
+  }
+
+  /// @brief unescapes percent encoded octets
+  /// @param begin the first character to unescape
+  /// @param end past the last character to unescape
+  /// @return the unescaped string
+  std::string unescape(std::string::const_iterator begin, std::string::const_iterator end)
+  {
+    std::string out;
+    out.reserve(static_cast<std::size_t>(end - begin));
+    for (auto it = begin; it != end; ++it)
+    {
+      if (*it == '%' && end - it > 2)
+      {
+        const auto high = hexValue(*(it + 1));
+        const auto low = hexValue(*(it + 2));
+        if (high >= 0 && low >= 0)
+        {
+          out += static_cast<char>(high * 16 + low);
+          it += 2;
+          continue;
+        }
+      }
+      out += *it;
+    }
+    return out;
+  }
+} // namespace
+
+void ProbeMatcher::setTypes(const WS::DISCOVERY::QNameListType& types)
+{
+  types_.clear();
+  for (const auto& type : types)
+  {
+    types_.insert(typeKey(type));
+  }
+}
+
+void ProbeMatcher::setScopes(const WS::DISCOVERY::UriListType& scopes)
+{
+  scopes_.clear();
+  normalizedScopes_.clear();
+  for (const auto& scope : scopes)
+  {
+    scopes_.insert(scope);
+    if (auto normalized = normalize(scope); normalized.has_value())
+    {
+      normalizedScopes_.emplace_back(std::move(normalized.value()));
+    }
+  }
+  hasScopes_ = !scopes.empty();
+}
+
+bool ProbeMatcher::matches(const WS::DISCOVERY::ProbeType& probe) const
+{
+  if (probe.Types.has_value())
+  {
+    for (const auto& type : probe.Types.value())
+    {
+      if (types_.count(typeKey(type)) == 0)
+      {
+        return false;
+      }
+    }
+  }
+  if (!probe.Scopes.has_value())
+  {
+    return true;
+  }
+  const auto& scopes = probe.Scopes.value();
+  const auto& matchBy = scopes.MatchBy.value_or(
+      WS::DISCOVERY::ScopesType::MatchByType(MDPWS::WS_DISCOVERY_MATCH_BY_RFC3986));
+  if (matchBy == MDPWS::WS_DISCOVERY_MATCH_BY_NONE)
+  {
+    return !hasScopes_ && scopes.empty();
+  }
+  return std::all_of(scopes.begin(), scopes.end(),
+                     [&](const auto& scope) { return matchesScope(scope, matchBy); });
+}
+
+bool ProbeMatcher::matchesScope(const std::string& scope, const std::string& matchBy) const
+{
+  if (matchBy == MDPWS::WS_DISCOVERY_MATCH_BY_STRCMP0)
+  {
+    return scopes_.count(scope) != 0;
+  }
+  if (matchBy != MDPWS::WS_DISCOVERY_MATCH_BY_RFC3986)
+  {
+    // unknown matching rules never match
+    return false;
+  }
+  const auto probeScope = normalize(scope);
+  if (!probeScope.has_value())
+  {
+    return false;
+  }
+  return std::any_of(
+      normalizedScopes_.begin(), normalizedScopes_.end(), [&](const NormalizedUri& ownScope) {
+        return probeScope->schemeAndAuthority == ownScope.schemeAndAuthority &&
+               probeScope->segments.size() <= ownScope.segments.size() &&
+               std::equal(probeScope->segments.begin(), probeScope->segments.end(),
+                          ownScope.segments.begin());
+      });
+}
+
+std::string ProbeMatcher::typeKey(const WS::DISCOVERY::QName& qname)
+{
+  return "{" + qname.ns + "}" + qname.name;
+}
+
+std::optional<ProbeMatcher::NormalizedUri> ProbeMatcher::normalize(const std::string& uri)
+{
+  const auto schemeEnd = uri.find(':');
+  if (schemeEnd == std::string::npos || schemeEnd == 0)
+  {
+    return std::nullopt;
+  }
+  // query and fragment are excluded from comparison
+  const auto end = std::min(uri.find_first_of("?#"), uri.size());
+  NormalizedUri normalized;
+  auto pathBegin = schemeEnd + 1;
+  if (uri.compare(pathBegin, 2, "//") == 0)
+  {
+    pathBegin = std::min(uri.find('/', pathBegin + 2), end);
+  }
+  normalized.schemeAndAuthority = unescape(uri.begin(), uri.begin() + pathBegin);
+  std::transform(normalized.schemeAndAuthority.begin(), normalized.schemeAndAuthority.end(),
+                 normalized.schemeAndAuthority.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  while (pathBegin < end)
+  {
+    const auto segmentEnd = std::min(uri.find('/', pathBegin), end);
+    if (segmentEnd > pathBegin)
+    {
+      auto segment = unescape(uri.begin() + pathBegin, uri.begin() + segmentEnd);
+      if (segment == "." || segment == "..")
+      {
+        return std::nullopt;
+      }
+      normalized.segments.emplace_back(std::move(segment));
+    }
+    pathBegin = segmentEnd + 1;
+  }
+  return normalized;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "datamodel/ws-discovery.hpp"
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/// @brief ProbeMatcher decides whether a WS-Discovery Probe matches the types and scopes of this
+/// target service. The own types and scopes are normalized once when they change, so matching a
+/// probe only normalizes the few types and scopes of the probe itself.
+class ProbeMatcher
+{
+public:
+  /// @brief sets the types of this target service
+  /// @param types the types to match probes against
+  void setTypes(const WS::DISCOVERY::QNameListType& types);
+
+  /// @brief sets the scopes of this target service
+  /// @param scopes the scopes to match probes against
+  void setScopes(const WS::DISCOVERY::UriListType& scopes);
+
+  /// @brief checks whether a probe matches this target service. A probe matches if every of its
+  /// types is a type of this target service and every of its scopes matches a scope of this target
+  /// service by the rule given in the MatchBy attribute.
+  /// @param probe the received probe
+  /// @return whether to answer the probe with a ProbeMatch
+  bool matches(const WS::DISCOVERY::ProbeType& probe) const;
+
+private:
+  /// @brief a URI split into the components compared by the RFC 3986 matching rule
+  struct NormalizedUri
+  {
+    /// the lowercased scheme and authority
+    std::string schemeAndAuthority;
+    /// the unescaped path segments without empty segments
+    std::vector<std::string> segments;
+  };
+
+  /// the types of this target service in "{namespace}name" notation
+  std::unordered_set<std::string> types_;
+  /// the scopes of this target service as given
+  std::unordered_set<std::string> scopes_;
+  /// the scopes of this target service comparable by the RFC 3986 rule
+  std::vector<NormalizedUri> normalizedScopes_;
+  /// whether this target service has any scope
+  bool hasScopes_{false};
+
+  /// @brief checks whether a scope of a probe matches a scope of this target service
+  /// @param scope the scope of the probe
+  /// @param matchBy the matching rule of the probe
+  /// @return whether any scope of this target service matches
+  bool matchesScope(const std::string& scope, const std::string& matchBy) const;
+
+  /// @brief builds the key of a type in types_
+  /// @param qname the type
+  /// @return the type in "{namespace}name" notation
+  static std::string typeKey(const WS::DISCOVERY::QName& qname);
+
+  /// @brief normalizes a URI for the RFC 3986 matching rule
+  /// @param uri the URI to normalize
+  /// @return the normalized URI or nothing if the URI has no scheme or contains a "." or ".."
+  /// segment, which never matches
+  static std::optional<NormalizedUri> normalize(const std::string& uri);
+};
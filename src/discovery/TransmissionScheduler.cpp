@@ -0,0 +1,243 @@
+#include "TransmissionScheduler.hpp"
+#include "Log.hpp"
+#include "datamodel/MDPWSConstants.hpp"
+#include <algorithm>
+
+static constexpr const char* TAG = "TransmissionScheduler";
+
+const TransmissionScheduler::Repetition TransmissionScheduler::MULTICAST{
+    MDPWS::UDP_MULTICAST_UDP_REPEAT, std::chrono::milliseconds(MDPWS::UDP_MULTICAST_MIN_DELAY),
+    std::chrono::milliseconds(MDPWS::UDP_MULTICAST_MAX_DELAY),
+    std::chrono::milliseconds(MDPWS::UDP_MULTICAST_UPPER_DELAY)};
+
+const TransmissionScheduler::Repetition TransmissionScheduler::UNICAST{
+    MDPWS::UDP_UNICAST_UDP_REPEAT, std::chrono::milliseconds(MDPWS::UDP_UNICAST_MIN_DELAY),
+    std::chrono::milliseconds(MDPWS::UDP_UNICAST_MAX_DELAY),
+    std::chrono::milliseconds(MDPWS::UDP_UNICAST_UPPER_DELAY)};
+
+TransmissionScheduler::Transmission::Transmission(const Executor& executor,
+                                                  BufferPool::Buffer message,
+                                                  const asio::ip::udp::endpoint& endpoint,
+                                                  const char* messageName,
+                                                  std::function<void()> onDone)
+  : timer(executor)
+  , message(std::move(message))
+  , endpoint(endpoint)
+  , messageName(messageName)
+  , onDone(std::move(onDone))
+{
+}
+
+TransmissionScheduler::TransmissionScheduler(const Executor& executor,
+                                             asio::ip::udp::socket& socket, double rate,
+                                             std::size_t burst)
+  : executor_(executor)
+  , socket_(socket)
+  , rate_(rate)
+  , burst_(static_cast<double>(std::max<std::size_t>(burst, 1)))
+  , tokens_(burst_)
+  , lastRefill_(Clock::now())
+  , random_(std::random_device{}())
+{
+}
+
+void TransmissionScheduler::schedule(BufferPool::Buffer message,
+                                     const asio::ip::udp::endpoint& endpoint,
+                                     const Repetition& repetition,
+                                     std::chrono::milliseconds maxInitialDelay,
+                                     const char* messageName, std::function<void()> onDone)
+{
+  auto transmission = std::make_shared<Transmission>(executor_, std::move(message), endpoint,
+                                                     messageName, std::move(onDone));
+  transmission->remaining = repetition.repeat;
+  transmission->delay = randomDelay(repetition.minDelay, repetition.maxDelay);
+  transmission->upperDelay = repetition.upperDelay;
+  pending_.emplace_back(transmission);
+  wait(transmission, randomDelay(std::chrono::milliseconds(0), maxInitialDelay));
+}
+
+void TransmissionScheduler::cancel()
+{
+  for (const auto& transmission : pending_)
+  {
+    transmission->cancelled = true;
+    transmission->timer.cancel();
+  }
+  pending_.clear();
+  outgoing_.clear();
+}
+
+void TransmissionScheduler::whenIdle(std::function<void()> onIdle)
+{
+  onIdle_ = std::move(onIdle);
+  notifyIdle();
+}
+
+void TransmissionScheduler::notifyIdle()
+{
+  if (onIdle_ && sending_ == 0 && !flushPosted_)
+  {
+    const auto onIdle = std::move(onIdle_);
+    onIdle_ = nullptr;
+    onIdle();
+  }
+}
+
+void TransmissionScheduler::wait(const std::shared_ptr<Transmission>& transmission,
+                                 Clock::duration delay)
+{
+  if (delay <= Clock::duration::zero())
+  {
+    transmit(transmission);
+    return;
+  }
+  transmission->timer.expires_after(delay);
+  transmission->timer.async_wait([this, transmission](const std::error_code& ec) {
+    if (ec || transmission->cancelled)
+    {
+      return;
+    }
+    transmit(transmission);
+  });
+}
+
+void TransmissionScheduler::transmit(const std::shared_ptr<Transmission>& transmission)
+{
+  if (const auto tokenDelay = takeToken(); tokenDelay > Clock::duration::zero())
+  {
+    wait(transmission, tokenDelay);
+    return;
+  }
+  outgoing_.emplace_back(transmission);
+  if (!flushPosted_)
+  {
+    // messages becoming due in this turn of the executor are sent together
+    flushPosted_ = true;
+    asio::post(executor_, [this]() { flush(); });
+  }
+}
+
+void TransmissionScheduler::flush()
+{
+  flushPosted_ = false;
+  auto batch = std::move(outgoing_);
+  outgoing_.clear();
+  batch.erase(std::remove_if(batch.begin(), batch.end(),
+                             [](const auto& transmission) { return transmission->cancelled; }),
+              batch.end());
+  std::size_t sentCount = 0;
+#ifdef __linux__
+  messages_.resize(batch.size());
+  vectors_.resize(batch.size());
+  for (std::size_t i = 0; i < batch.size(); ++i)
+  {
+    auto& message = *batch[i]->message;
+    vectors_[i].iov_base = message.data();
+    vectors_[i].iov_len = message.size();
+    auto& header = messages_[i].msg_hdr;
+    header = msghdr();
+    header.msg_name = batch[i]->endpoint.data();
+    header.msg_namelen = static_cast<socklen_t>(batch[i]->endpoint.size());
+    header.msg_iov = &vectors_[i];
+    header.msg_iovlen = 1;
+  }
+  if (batch.size() > 1)
+  {
+    const int count = ::sendmmsg(socket_.native_handle(), messages_.data(),
+                                 static_cast<unsigned int>(batch.size()), MSG_DONTWAIT);
+    sentCount = count > 0 ? static_cast<std::size_t>(count) : 0;
+  }
+  for (std::size_t i = 0; i < sentCount; ++i)
+  {
+    sent(batch[i], std::error_code(), messages_[i].msg_len);
+  }
+#endif
+  // single messages and those sendmmsg did not take, e.g. for a full send buffer, report their
+  // errors and wait for the socket on their own
+  for (std::size_t i = sentCount; i < batch.size(); ++i)
+  {
+    send(batch[i]);
+  }
+  notifyIdle();
+}
+
+void TransmissionScheduler::send(const std::shared_ptr<Transmission>& transmission)
+{
+  ++sending_;
+  socket_.async_send_to(
+      asio::buffer(*transmission->message), transmission->endpoint,
+      [this, transmission](const std::error_code& ec, const std::size_t bytesTransferred) {
+        --sending_;
+        sent(transmission, ec, bytesTransferred);
+        notifyIdle();
+      });
+}
+
+void TransmissionScheduler::sent(const std::shared_ptr<Transmission>& transmission,
+                                 const std::error_code& ec, std::size_t bytesTransferred)
+{
+  if (ec)
+  {
+    LOG(LogLevel::ERROR, "Error while sending " << transmission->messageName << ": ec "
+                                                << ec.value() << ": " << ec.message());
+  }
+  else
+  {
+    LOG(LogLevel::DEBUG, "Sent " << transmission->messageName << " msg (" << bytesTransferred
+                                 << " bytes): \n"
+                                 << *transmission->message);
+  }
+  if (transmission->cancelled)
+  {
+    return;
+  }
+  next(transmission);
+}
+
+void TransmissionScheduler::next(const std::shared_ptr<Transmission>& transmission)
+{
+  if (transmission->remaining > 0)
+  {
+    --transmission->remaining;
+    const auto delay = transmission->delay;
+    transmission->delay = std::min(2 * transmission->delay, transmission->upperDelay);
+    wait(transmission, delay);
+    return;
+  }
+  pending_.remove(transmission);
+  if (transmission->onDone)
+  {
+    transmission->onDone();
+  }
+}
+
+TransmissionScheduler::Clock::duration TransmissionScheduler::takeToken()
+{
+  if (rate_ <= 0)
+  {
+    return Clock::duration::zero();
+  }
+  const auto now = Clock::now();
+  const std::chrono::duration<double> elapsed = now - lastRefill_;
+  tokens_ = std::min(burst_, tokens_ + elapsed.count() * rate_);
+  lastRefill_ = now;
+  if (tokens_ >= 1.0)
+  {
+    tokens_ -= 1.0;
+    return Clock::duration::zero();
+  }
+  return std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>((1.0 - tokens_) / rate_));
+}
+
+std::chrono::milliseconds TransmissionScheduler::randomDelay(std::chrono::milliseconds min,
+                                                              std::chrono::milliseconds max)
+{
+  if (max <= min)
+  {
+    return min;
+  }
+  std::uniform_int_distribution<std::chrono::milliseconds::rep> distribution(min.count(),
+                                                                             max.count());
+  return std::chrono::milliseconds(distribution(random_));
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "BufferPool.hpp"
+#include <asio.hpp>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <memory>
+#include <random>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
+/// @brief TransmissionScheduler sends the messages of a UDP socket as SOAP-over-UDP requires. The
+/// first transmission of a message can be delayed by a random time, so that devices answering the
+/// same multicast request do not send at the same moment. Afterwards the message is repeated with
+/// a randomized and doubling delay. All transmissions are limited by a token bucket.
+/// Transmissions becoming due at the same time are sent by a single sendmmsg call on linux.
+/// The scheduler is driven by timers on the strand of its socket, all its functions have to be
+/// called on that strand.
+class TransmissionScheduler
+{
+public:
+  /// @brief the repetition parameters of a transmission
+  struct Repetition
+  {
+    /// number of repetitions after the first transmission
+    unsigned int repeat;
+    /// the lower bound of the initial delay between repetitions
+    std::chrono::milliseconds minDelay;
+    /// the upper bound of the initial delay between repetitions
+    std::chrono::milliseconds maxDelay;
+    /// the upper bound the doubling delay between repetitions is capped to
+    std::chrono::milliseconds upperDelay;
+  };
+
+  /// repetitions of a message sent to a multicast group
+  static const Repetition MULTICAST;
+  /// repetitions of a message sent to a single receiver
+  static const Repetition UNICAST;
+
+  /// the strand the socket and the timers of a scheduler run their handlers on
+  using Executor = asio::strand<asio::io_context::executor_type>;
+
+  /// @brief constructs a scheduler
+  /// @param executor the strand of the socket
+  /// @param socket the socket to send with
+  /// @param rate the transmissions per second allowed in the long run, zero if unlimited
+  /// @param burst the number of transmissions allowed at once
+  TransmissionScheduler(const Executor& executor, asio::ip::udp::socket& socket, double rate,
+                        std::size_t burst);
+  TransmissionScheduler(const TransmissionScheduler&) = delete;
+  TransmissionScheduler(TransmissionScheduler&&) = delete;
+  TransmissionScheduler& operator=(const TransmissionScheduler&) = delete;
+  TransmissionScheduler& operator=(TransmissionScheduler&&) = delete;
+  ~TransmissionScheduler() = default;
+
+  /// @brief schedules a message for transmission
+  /// @param message the message to send
+  /// @param endpoint the receiver of the message
+  /// @param repetition how often to repeat the message
+  /// @param maxInitialDelay the upper bound of the random delay before the first transmission
+  /// @param messageName the name of the message for logging
+  /// @param onDone called after the last repetition was sent
+  void schedule(BufferPool::Buffer message, const asio::ip::udp::endpoint& endpoint,
+                const Repetition& repetition, std::chrono::milliseconds maxInitialDelay,
+                const char* messageName, std::function<void()> onDone = {});
+
+  /// @brief cancels all scheduled transmissions without calling their completion handlers
+  void cancel();
+
+  /// @brief calls a handler once no send or flush handler referring to this scheduler is pending,
+  /// so it may be destroyed. Has to be called after cancel() and closing the socket.
+  /// @param onIdle called on the strand, immediately if nothing is in flight
+  void whenIdle(std::function<void()> onIdle);
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  /// @brief a scheduled message
+  struct Transmission
+  {
+    Transmission(const Executor& executor, BufferPool::Buffer message,
+                 const asio::ip::udp::endpoint& endpoint, const char* messageName,
+                 std::function<void()> onDone);
+
+    /// waits for the next transmission
+    asio::steady_timer timer;
+    /// the message to send
+    BufferPool::Buffer message;
+    /// the receiver of the message
+    asio::ip::udp::endpoint endpoint;
+    /// the name of the message for logging
+    const char* messageName;
+    /// called after the last repetition was sent
+    std::function<void()> onDone;
+    /// repetitions left after the pending transmission
+    unsigned int remaining{0};
+    /// the delay before the next repetition
+    std::chrono::milliseconds delay{0};
+    /// the upper bound of the delay between repetitions
+    std::chrono::milliseconds upperDelay{0};
+    /// whether the transmission was cancelled
+    bool cancelled{false};
+  };
+
+  /// the strand of the socket
+  Executor executor_;
+  /// the socket to send with
+  asio::ip::udp::socket& socket_;
+  /// the tokens gained per second
+  const double rate_;
+  /// the maximum number of tokens
+  const double burst_;
+  /// the tokens available
+  double tokens_;
+  /// the time the tokens were last refilled
+  Clock::time_point lastRefill_;
+  /// the scheduled transmissions
+  std::list<std::shared_ptr<Transmission>> pending_;
+  /// the transmissions due to be sent by the next flush()
+  std::vector<std::shared_ptr<Transmission>> outgoing_;
+  /// whether a flush() was posted to the executor
+  bool flushPosted_{false};
+  /// the number of sends in flight
+  std::size_t sending_{0};
+  /// called once the last send or flush in flight returned
+  std::function<void()> onIdle_;
+#ifdef __linux__
+  /// the message headers of a batch passed to sendmmsg
+  std::vector<mmsghdr> messages_;
+  /// the gather elements of a batch, one per message
+  std::vector<iovec> vectors_;
+#endif
+  /// generates the random delays
+  std::mt19937 random_;
+
+  /// @brief calls the handler waiting for the scheduler to become idle, if nothing is in flight
+  /// anymore
+  void notifyIdle();
+
+  /// @brief waits for the next transmission of a message
+  /// @param transmission the scheduled message
+  /// @param delay the time to wait
+  void wait(const std::shared_ptr<Transmission>& transmission, Clock::duration delay);
+
+  /// @brief queues a message for the next flush() if a token is available and waits for a token
+  /// otherwise
+  /// @param transmission the scheduled message
+  void transmit(const std::shared_ptr<Transmission>& transmission);
+
+  /// @brief sends all queued messages at once
+  void flush();
+
+  /// @brief sends a single message, waiting until the socket is writable
+  /// @param transmission the scheduled message
+  void send(const std::shared_ptr<Transmission>& transmission);
+
+  /// @brief logs a sent message and continues with its next repetition
+  /// @param transmission the scheduled message
+  /// @param ec the result of sending
+  /// @param bytesTransferred the bytes sent
+  void sent(const std::shared_ptr<Transmission>& transmission, const std::error_code& ec,
+            std::size_t bytesTransferred);
+
+  /// @brief continues with the next repetition of a sent message or finishes it
+  /// @param transmission the scheduled message
+  void next(const std::shared_ptr<Transmission>& transmission);
+
+  /// @brief takes a token from the bucket
+  /// @return the time to wait until a token is available, zero if a token was taken
+  Clock::duration takeToken();
+
+  /// @brief gets a random delay
+  /// @param min the lower bound of the delay
+  /// @param max the upper bound of the delay
+  /// @return a delay uniformly distributed between min and max
+  std::chrono::milliseconds randomDelay(std::chrono::milliseconds min,
+                                        std::chrono::milliseconds max);
+};
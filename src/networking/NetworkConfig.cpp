@@ -1,4 +1,5 @@
 #include "NetworkConfig.hpp"
+#include <algorithm>
 
 NetworkConfig::NetworkConfig(bool useTLS, std::string ipAddress, std::uint16_t port)
   : useTLS_(useTLS)
@@ -21,3 +22,145 @@ std::uint16_t NetworkConfig::port() const
 {
   return port_;
 }
+
+void NetworkConfig::setThreadCount(std::size_t threadCount)
+{
+  threadCount_ = std::max<std::size_t>(threadCount, 1);
+}
+
+std::size_t NetworkConfig::threadCount() const
+{
+  return threadCount_;
+}
+
+void NetworkConfig::setReusePort(bool reusePort)
+{
+  reusePort_ = reusePort;
+}
+
+bool NetworkConfig::reusePort() const
+{
+  return reusePort_;
+}
+
+void NetworkConfig::setTLSSessionCache(std::size_t cacheSize, std::chrono::seconds lifetime)
+{
+  tlsSessionCacheSize_ = cacheSize;
+  tlsSessionLifetime_ = lifetime;
+}
+
+std::size_t NetworkConfig::tlsSessionCacheSize() const
+{
+  return tlsSessionCacheSize_;
+}
+
+std::chrono::seconds NetworkConfig::tlsSessionLifetime() const
+{
+  return tlsSessionLifetime_;
+}
+
+void NetworkConfig::setTLSSessionTickets(bool sessionTickets)
+{
+  tlsSessionTickets_ = sessionTickets;
+}
+
+bool NetworkConfig::tlsSessionTickets() const
+{
+  return tlsSessionTickets_;
+}
+
+void NetworkConfig::setConnectionTimeouts(std::chrono::seconds idleTimeout,
+                                          std::chrono::seconds headerTimeout,
+                                          std::chrono::seconds bodyTimeout)
+{
+  idleTimeout_ = idleTimeout;
+  headerTimeout_ = headerTimeout;
+  bodyTimeout_ = bodyTimeout;
+}
+
+std::chrono::seconds NetworkConfig::idleTimeout() const
+{
+  return idleTimeout_;
+}
+
+std::chrono::seconds NetworkConfig::headerTimeout() const
+{
+  return headerTimeout_;
+}
+
+std::chrono::seconds NetworkConfig::bodyTimeout() const
+{
+  return bodyTimeout_;
+}
+
+void NetworkConfig::setMaxConnections(std::size_t maxConnections)
+{
+  maxConnections_ = maxConnections;
+}
+
+std::size_t NetworkConfig::maxConnections() const
+{
+  return maxConnections_;
+}
+
+void NetworkConfig::setMaxRequestSize(std::size_t maxRequestSize)
+{
+  maxRequestSize_ = maxRequestSize;
+}
+
+std::size_t NetworkConfig::maxRequestSize() const
+{
+  return maxRequestSize_;
+}
+
+void NetworkConfig::setRequestRateLimit(double requestRate, std::size_t requestBurst)
+{
+  requestRate_ = std::max(requestRate, 0.0);
+  requestBurst_ = std::max<std::size_t>(requestBurst, 1);
+}
+
+double NetworkConfig::requestRate() const
+{
+  return requestRate_;
+}
+
+std::size_t NetworkConfig::requestBurst() const
+{
+  return requestBurst_;
+}
+
+void NetworkConfig::setMaxInFlightRequests(std::size_t maxInFlightRequests)
+{
+  maxInFlightRequests_ = maxInFlightRequests;
+}
+
+std::size_t NetworkConfig::maxInFlightRequests() const
+{
+  return maxInFlightRequests_;
+}
+
+void NetworkConfig::setStreamingAddress(std::string address, std::uint16_t port)
+{
+  streamingAddress_ = std::move(address);
+  streamingPort_ = port;
+}
+
+const std::string& NetworkConfig::streamingAddress() const
+{
+  return streamingAddress_;
+}
+
+std::uint16_t NetworkConfig::streamingPort() const
+{
+  return streamingPort_;
+}
+
+void NetworkConfig::addDiscoveryInterface(std::string address)
+{
+  discoveryInterfaces_.emplace_back(std::move(address));
+}
+
+const std::vector<std::string>& NetworkConfig::discoveryInterfaces() const
+{
+  return discoveryInterfaces_;
+}
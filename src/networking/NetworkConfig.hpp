@@ -1,6 +1,10 @@
 #pragma once
 
+#include "datamodel/MDPWSConstants.hpp"
+#include <chrono>
+#include <cstddef>
 #include <string>
+#include <vector>
 
 /// @brief NetworkConfig holds configuration of Network settings relevant to configure MicroSDC
 class NetworkConfig
@@ -23,6 +27,129 @@ public:
   /// @return the configured port
   std::uint16_t port() const;
 
+  /// @brief sets the number of threads serving requests of the web server
+  /// @param threadCount the number of I/O threads, at least 1
+  void setThreadCount(std::size_t threadCount);
+
+  /// @brief gets the number of threads serving requests of the web server
+  /// @return the configured number of I/O threads
+  std::size_t threadCount() const;
+
+  /// @brief sets whether the web server runs one acceptor per thread on the same port using
+  /// SO_REUSEPORT instead of a single acceptor shared by all threads. Only supported on linux.
+  /// @param reusePort whether to use one acceptor per thread
+  void setReusePort(bool reusePort);
+
+  /// @brief returns whether the web server runs one acceptor per thread using SO_REUSEPORT
+  /// @return whether SO_REUSEPORT multi acceptor mode is enabled
+  bool reusePort() const;
+
+  /// @brief sets the TLS session cache of the web server. Cached sessions let reconnecting clients
+  /// resume a session with an abbreviated handshake instead of a full one.
+  /// @param cacheSize the maximum number of cached sessions. Zero disables session caching.
+  /// @param lifetime the time a session can be resumed after its full handshake
+  void setTLSSessionCache(std::size_t cacheSize, std::chrono::seconds lifetime);
+
+  /// @brief gets the maximum number of sessions cached by the web server
+  /// @return the configured session cache size, zero if caching is disabled
+  std::size_t tlsSessionCacheSize() const;
+
+  /// @brief gets the time a TLS session can be resumed after its full handshake
+  /// @return the configured session lifetime
+  std::chrono::seconds tlsSessionLifetime() const;
+
+  /// @brief sets whether the web server issues session tickets (RFC 5077). Tickets store the
+  /// session state at the client, so resumption does not depend on the server side cache.
+  /// @param sessionTickets whether to issue session tickets
+  void setTLSSessionTickets(bool sessionTickets);
+
+  /// @brief returns whether the web server issues session tickets
+  /// @return whether session tickets are enabled
+  bool tlsSessionTickets() const;
+
+  /// @brief sets the timeouts of the web server. A timeout of zero disables it.
+  /// @param idleTimeout the time a kept-alive connection may wait for its next request
+  /// @param headerTimeout the time to complete the TLS handshake and to receive a request header
+  /// @param bodyTimeout the time to receive a request body and to send its response
+  void setConnectionTimeouts(std::chrono::seconds idleTimeout, std::chrono::seconds headerTimeout,
+                             std::chrono::seconds bodyTimeout);
+
+  /// @brief gets the time a kept-alive connection may wait for its next request
+  /// @return the configured idle timeout, zero if disabled
+  std::chrono::seconds idleTimeout() const;
+
+  /// @brief gets the time to complete the TLS handshake and to receive a request header
+  /// @return the configured header timeout, zero if disabled
+  std::chrono::seconds headerTimeout() const;
+
+  /// @brief gets the time to receive a request body and to send its response
+  /// @return the configured body timeout, zero if disabled
+  std::chrono::seconds bodyTimeout() const;
+
+  /// @brief sets the maximum number of connections the web server keeps open. Accepting a
+  /// connection beyond the limit closes the least recently used idle connection, or the accepted
+  /// connection itself if no connection is idle.
+  /// @param maxConnections the maximum number of open connections. Zero disables the limit.
+  void setMaxConnections(std::size_t maxConnections);
+
+  /// @brief gets the maximum number of connections the web server keeps open
+  /// @return the configured connection limit, zero if unlimited
+  std::size_t maxConnections() const;
+
+  /// @brief sets the maximum size of a request content. Larger requests are rejected with 413.
+  /// @param maxRequestSize the maximum request size in bytes
+  void setMaxRequestSize(std::size_t maxRequestSize);
+
+  /// @brief gets the maximum size of a request content
+  /// @return the maximum request size in bytes
+  std::size_t maxRequestSize() const;
+
+  /// @brief sets the request rate each client is limited to. Requests beyond it are rejected with
+  /// 429. The limit is enforced by a token bucket per client address.
+  /// @param requestRate the sustained number of requests per second. Zero disables the limit.
+  /// @param requestBurst the number of requests a client can send at once after being idle
+  void setRequestRateLimit(double requestRate, std::size_t requestBurst);
+
+  /// @brief gets the sustained number of requests per second each client is limited to
+  /// @return the configured request rate, zero if rates are not limited
+  double requestRate() const;
+
+  /// @brief gets the number of requests a client can send at once after being idle
+  /// @return the configured burst size
+  std::size_t requestBurst() const;
+
+  /// @brief sets the maximum number of requests the web server handles at the same time. Requests
+  /// beyond it are rejected with 503.
+  /// @param maxInFlightRequests the maximum number of requests in flight. Zero disables the limit.
+  void setMaxInFlightRequests(std::size_t maxInFlightRequests);
+
+  /// @brief gets the maximum number of requests the web server handles at the same time
+  /// @return the configured limit, zero if unlimited
+  std::size_t maxInFlightRequests() const;
+
+  /// @brief sets the multicast group waveform streams are published to
+  /// @param address the ipv4 multicast address of the stream
+  /// @param port the udp port of the stream
+  void setStreamingAddress(std::string address, std::uint16_t port);
+
+  /// @brief gets the multicast address waveform streams are published to
+  /// @return the ipv4 multicast address string
+  const std::string& streamingAddress() const;
+
+  /// @brief gets the udp port waveform streams are published to
+  /// @return the configured streaming port
+  std::uint16_t streamingPort() const;
+
+  /// @brief adds a network interface discovery messages are exchanged on. Without any interface
+  /// added, discovery runs on the default ipv4 interface.
+  /// @param address the ipv4 address of this device on the interface or its ipv6 address scoped
+  /// to the interface, e.g. "fe80::1%eth0"
+  void addDiscoveryInterface(std::string address);
+
+  /// @brief gets the addresses of the network interfaces discovery messages are exchanged on
+  /// @return the configured interface addresses, empty to use the default interface
+  const std::vector<std::string>& discoveryInterfaces() const;
+
 private:
   /// whether to use TLS encrypted communication
   bool useTLS_{true};
@@ -30,4 +157,36 @@ private:
   std::string ipAddress_;
   /// the configured port
   std::uint16_t port_;
+  /// the number of threads serving requests
+  std::size_t threadCount_{1};
+  /// whether to run one acceptor per thread using SO_REUSEPORT
+  bool reusePort_{false};
+  /// the maximum number of cached TLS sessions
+  std::size_t tlsSessionCacheSize_{128};
+  /// the time a TLS session can be resumed
+  std::chrono::seconds tlsSessionLifetime_{300};
+  /// whether to issue TLS session tickets
+  bool tlsSessionTickets_{true};
+  /// the time a kept-alive connection may wait for its next request
+  std::chrono::seconds idleTimeout_{30};
+  /// the time to complete the TLS handshake and to receive a request header
+  std::chrono::seconds headerTimeout_{10};
+  /// the time to receive a request body and to send its response
+  std::chrono::seconds bodyTimeout_{60};
+  /// the maximum number of open connections of the web server
+  std::size_t maxConnections_{128};
+  /// the maximum size of a request content
+  std::size_t maxRequestSize_{MDPWS::MAX_ENVELOPE_SIZE};
+  /// the sustained requests per second of each client
+  double requestRate_{0};
+  /// the number of requests a client can send at once
+  std::size_t requestBurst_{20};
+  /// the maximum number of requests in flight
+  std::size_t maxInFlightRequests_{32};
+  /// the multicast address of waveform streams
+  std::string streamingAddress_{MDPWS::UDP_MULTICAST_STREAMING_IP_V4};
+  /// the udp port of waveform streams
+  std::uint16_t streamingPort_{MDPWS::UDP_MULTICAST_STREAMING_PORT};
+  /// the addresses of the interfaces discovery messages are exchanged on
+  std::vector<std::string> discoveryInterfaces_;
 };
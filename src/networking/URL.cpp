@@ -0,0 +1,104 @@
+#include "URL.hpp"
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <stdexcept>
+
+static constexpr std::string_view SCHEME_SEPARATOR = "://";
+static constexpr std::uint16_t HTTP_PORT = 80;
+static constexpr std::uint16_t HTTPS_PORT = 443;
+
+URL URL::parse(std::string_view url)
+{
+  const auto invalid = [url](const std::string& reason) {
+    return std::runtime_error(reason + " in URL " + std::string(url));
+  };
+  URL result;
+  const auto schemeEnd = url.find(SCHEME_SEPARATOR);
+  if (schemeEnd == std::string_view::npos)
+  {
+    throw invalid("Missing scheme");
+  }
+  result.scheme = url.substr(0, schemeEnd);
+  for (auto& c : result.scheme)
+  {
+    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  }
+  if (result.scheme == "http")
+  {
+    result.port = HTTP_PORT;
+  }
+  else if (result.scheme == "https")
+  {
+    result.port = HTTPS_PORT;
+  }
+  else
+  {
+    throw invalid("Unsupported scheme");
+  }
+
+  auto remainder = url.substr(schemeEnd + SCHEME_SEPARATOR.size());
+  const auto pathBegin = std::min(remainder.find_first_of("/?"), remainder.size());
+  const auto authority = remainder.substr(0, pathBegin);
+  result.path = remainder.substr(pathBegin);
+  if (result.path.empty() || result.path.front() == '?')
+  {
+    result.path.insert(result.path.begin(), '/');
+  }
+
+  std::size_t hostEnd = 0;
+  if (!authority.empty() && authority.front() == '[')
+  {
+    // IPv6 literals are enclosed in brackets and contain colons themselves
+    const auto bracket = authority.find(']');
+    if (bracket == std::string_view::npos)
+    {
+      throw invalid("Invalid host");
+    }
+    hostEnd = bracket + 1;
+  }
+  else
+  {
+    hostEnd = std::min(authority.find(':'), authority.size());
+  }
+  result.host = authority.substr(0, hostEnd);
+  if (result.host.empty())
+  {
+    throw invalid("Missing host");
+  }
+  if (hostEnd == authority.size())
+  {
+    return result;
+  }
+
+  const auto port = authority.substr(hostEnd + 1);
+  if (authority[hostEnd] != ':' || port.empty())
+  {
+    throw invalid("Invalid port");
+  }
+  unsigned long value = 0;
+  for (const auto c : port)
+  {
+    if (c < '0' || c > '9')
+    {
+      throw invalid("Invalid port");
+    }
+    value = value * 10 + static_cast<unsigned long>(c - '0');
+    if (value > std::numeric_limits<std::uint16_t>::max())
+    {
+      throw invalid("Invalid port");
+    }
+  }
+  result.port = static_cast<std::uint16_t>(value);
+  return result;
+}
+
+bool URL::isSecure() const
+{
+  return scheme == "https";
+}
+
+std::string URL::hostPort() const
+{
+  return host + ":" + std::to_string(port);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/// @brief URL holds the components of an http(s) URL as used for WS-Addressing endpoints
+struct URL
+{
+  /// the scheme without "://", e.g. "https"
+  std::string scheme;
+  /// the host name or ip address. IPv6 addresses are kept in brackets.
+  std::string host;
+  /// the port, defaulted from the scheme if not given explicitly
+  std::uint16_t port{0};
+  /// the path including a query, at least "/"
+  std::string path;
+
+  /// @brief parses a URL of the form scheme://host[:port][/path]. Parsing is done by plain
+  /// character scanning, no regular expressions are involved.
+  /// @param url the URL to parse
+  /// @return the components of the URL
+  /// @throws std::runtime_error if the URL is malformed or the scheme is not http(s)
+  static URL parse(std::string_view url);
+
+  /// @brief returns whether this URL uses TLS
+  /// @return whether the scheme is https
+  bool isSecure() const;
+
+  /// @brief returns the authority part of this URL
+  /// @return host and port separated by a colon
+  std::string hostPort() const;
+};
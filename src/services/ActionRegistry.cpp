@@ -0,0 +1,29 @@
+#include "ActionRegistry.hpp"
+#include "datamodel/MessageModel.hpp"
+#include <stdexcept>
+
+void ActionRegistry::registerAction(std::string action, Handler handler)
+{
+  add(std::move(action), Action{std::move(handler), false});
+}
+
+void ActionRegistry::registerDeferredAction(std::string action, Handler handler)
+{
+  add(std::move(action), Action{std::move(handler), true});
+}
+
+const ActionRegistry::Action*
+ActionRegistry::find(const MESSAGEMODEL::Envelope& requestEnvelope) const
+{
+  const auto it = actions_.find(requestEnvelope.Header.Action);
+  return it == actions_.end() ? nullptr : &it->second;
+}
+
+void ActionRegistry::add(std::string name, Action action)
+{
+  const auto [it, inserted] = actions_.emplace(std::move(name), std::move(action));
+  if (!inserted)
+  {
+    throw std::runtime_error("Action " + it->first + " is already registered");
+  }
+}
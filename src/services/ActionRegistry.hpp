@@ -0,0 +1,58 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+class Request;
+namespace MESSAGEMODEL
+{
+  class Envelope;
+} // namespace MESSAGEMODEL
+
+/// @brief ActionRegistry maps SOAP actions to the handlers processing them. The hashes of the
+/// registered actions are computed once on registration, dispatching a request takes a single hash
+/// lookup regardless of the number of registered actions. Actions have to be registered before
+/// requests are dispatched, dispatching is safe to be done concurrently.
+class ActionRegistry
+{
+public:
+  /// a handler processing a request of a given action
+  using Handler =
+      std::function<void(Request& req, const MESSAGEMODEL::Envelope& requestEnvelope)>;
+
+  /// @brief a registered action
+  struct Action
+  {
+    /// the handler processing requests of this action
+    Handler handler;
+    /// whether requests of this action are handled on a worker thread instead of the thread of
+    /// the web server receiving them
+    bool deferred{false};
+  };
+
+  /// @brief registers a handler for a given action
+  /// @param action the SOAP action to register the handler for
+  /// @param handler the handler processing requests of this action
+  void registerAction(std::string action, Handler handler);
+
+  /// @brief registers a handler for a given action doing expensive work. Its requests are handed
+  /// to a worker thread, so the web server thread can serve other connections meanwhile.
+  /// @param action the SOAP action to register the handler for
+  /// @param handler the handler processing requests of this action
+  void registerDeferredAction(std::string action, Handler handler);
+
+  /// @brief finds the action registered for a request
+  /// @param requestEnvelope the parsed envelope of the request
+  /// @return the registered action or nullptr if the action of the request is unknown
+  const Action* find(const MESSAGEMODEL::Envelope& requestEnvelope) const;
+
+private:
+  /// registered actions by their name
+  std::unordered_map<std::string, Action> actions_;
+
+  /// @brief registers an action
+  /// @param name the SOAP action to register
+  /// @param action the handler and dispatch mode of the action
+  void add(std::string name, Action action);
+};
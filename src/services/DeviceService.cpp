@@ -3,39 +3,40 @@
 #include "MetadataProvider.hpp"
 #include "WebServer/Request.hpp"
 #include "datamodel/MDPWSConstants.hpp"
-#include "services/SoapFault.hpp"
+#include "datamodel/MessageModel.hpp"
 
 static constexpr const char* TAG = "DeviceService";
 
-DeviceService::DeviceService(std::shared_ptr<const MetadataProvider> metadata)
+DeviceService::DeviceService(std::shared_ptr<const MetadataProvider> metadata,
+                             DiscoveryService& discoveryService,
+                             DiscoveryService::TargetId discoveryTarget)
   : metadata_(std::move(metadata))
+  , discoveryService_(discoveryService)
+  , discoveryTarget_(discoveryTarget)
 {
+  actions_.registerAction(
+      MDPWS::WS_ACTION_GET, [this](Request& req, const MESSAGEMODEL::Envelope& requestEnvelope) {
+        MESSAGEMODEL::Envelope responseEnvelope;
+        fillResponseMessageFromRequestMessage(responseEnvelope, requestEnvelope);
+        responseEnvelope.Header.Action = WS::ADDRESSING::URIType(MDPWS::WS_ACTION_GET_RESPONSE);
+        metadata_->fillDeviceMetadata(responseEnvelope);
+        req.respond(responseEnvelope);
+      });
+  actions_.registerAction(MDPWS::WS_ACTION_GET_METADATA_REQUEST,
+                          [](Request& /*req*/, const MESSAGEMODEL::Envelope& /*requestEnvelope*/) {
+                            LOG(LogLevel::WARNING, "HANDLE ACTION_GETMETADATA_REQUEST");
+                          });
+  actions_.registerAction(
+      MDPWS::WS_ACTION_PROBE, [this](Request& req, const MESSAGEMODEL::Envelope& requestEnvelope) {
+        MESSAGEMODEL::Envelope responseEnvelope;
+        fillResponseMessageFromRequestMessage(responseEnvelope, requestEnvelope);
+        discoveryService_.fillDirectedProbeMatches(
+            discoveryTarget_, requestEnvelope.Body.Probe.value(), responseEnvelope);
+        req.respond(responseEnvelope);
+      });
 }
 
 std::string DeviceService::getURI() const
 {
-  return MetadataProvider::getDeviceServicePath();
-}
-
-void DeviceService::handleRequest(std::unique_ptr<Request> req)
-{
-  const auto requestEnvelope = req->getEnvelope();
-  const auto& soapAction = requestEnvelope.Header.Action;
-  if (soapAction == MDPWS::WS_ACTION_GET)
-  {
-    MESSAGEMODEL::Envelope responseEnvelope;
-    fillResponseMessageFromRequestMessage(responseEnvelope, requestEnvelope);
-    responseEnvelope.Header.Action = WS::ADDRESSING::URIType(MDPWS::WS_ACTION_GET_RESPONSE);
-    metadata_->fillDeviceMetadata(responseEnvelope);
-    req->respond(responseEnvelope);
-  }
-  else if (soapAction == MDPWS::WS_ACTION_GET_METADATA_REQUEST)
-  {
-    LOG(LogLevel::WARNING, "HANDLE ACTION_GETMETADATA_REQUEST");
-  }
-  else
-  {
-    LOG(LogLevel::ERROR, "Unknown soap action " << soapAction);
-    req->respond(SoapFault().envelope());
-  }
+  return metadata_->getDeviceServicePath();
 }
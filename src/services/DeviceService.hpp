@@ -1,22 +1,30 @@
 #pragma once
 
 #include "SoapService.hpp"
+#include "discovery/DiscoveryService.hpp"
 
 class MetadataProvider;
 
-/// @brief DeviceService implements the SDC Device service
+/// @brief DeviceService implements the SDC Device service. Besides the metadata of the device it
+/// answers WS-Discovery directed probes sent over HTTP, so a consumer knowing the address of the
+/// device can check it without multicast traffic.
 class DeviceService : public SoapService
 {
 public:
   /// @brief constructs a new DeviceService from given metadata
   /// @param metadata a pointer to the metadata describing configurational data
-  explicit DeviceService(std::shared_ptr<const MetadataProvider> metadata);
+  /// @param discoveryService the discovery service answering directed probes
+  /// @param discoveryTarget the target service of this device at the discovery service
+  DeviceService(std::shared_ptr<const MetadataProvider> metadata,
+                DiscoveryService& discoveryService, DiscoveryService::TargetId discoveryTarget);
 
   std::string getURI() const override;
 
-  void handleRequest(std::unique_ptr<Request> req) override;
-
 private:
   /// a pointer to the metadata
   const std::shared_ptr<const MetadataProvider> metadata_;
+  /// the discovery service answering directed probes
+  DiscoveryService& discoveryService_;
+  /// the target service of this device at the discovery service
+  const DiscoveryService::TargetId discoveryTarget_;
 };
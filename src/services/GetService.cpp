@@ -1,6 +1,5 @@
 #include "GetService.hpp"
 
-#include "Log.hpp"
 #include "MicroSDC.hpp"
 #include "WebServer/Request.hpp"
 #include "datamodel/ExpectedElement.hpp"
@@ -8,46 +7,34 @@
 #include "datamodel/MessageModel.hpp"
 #include "datamodel/MessageSerializer.hpp"
 #include "MetadataProvider.hpp"
-#include "services/SoapFault.hpp"
-
-static constexpr const char* TAG = "GetService";
 
 GetService::GetService(const MicroSDC& microSDC, std::shared_ptr<const MetadataProvider> metadata)
   : microSDC_(microSDC)
   , metadata_(std::move(metadata))
 {
+  actions_.registerAction(
+      MDPWS::WS_ACTION_GET_METADATA_REQUEST,
+      [this](Request& req, const MESSAGEMODEL::Envelope& requestEnvelope) {
+        MESSAGEMODEL::Envelope responseEnvelope;
+        fillResponseMessageFromRequestMessage(responseEnvelope, requestEnvelope);
+        metadata_->fillGetServiceMetadata(responseEnvelope);
+        responseEnvelope.Header.Action =
+            WS::ADDRESSING::URIType(MDPWS::WS_ACTION_GET_METADATA_RESPONSE);
+        req.respond(responseEnvelope);
+      });
+  actions_.registerDeferredAction(
+      SDC::ACTION_GET_MDIB_REQUEST,
+      [this](Request& req, const MESSAGEMODEL::Envelope& requestEnvelope) {
+        MESSAGEMODEL::Envelope responseEnvelope;
+        fillResponseMessageFromRequestMessage(responseEnvelope, requestEnvelope);
+        responseEnvelope.Header.Action = WS::ADDRESSING::URIType(SDC::ACTION_GET_MDIB_RESPONSE);
+        responseEnvelope.Body.GetMdibResponse =
+            std::make_optional<MESSAGEMODEL::Body::GetMdibResponseType>(microSDC_.getMdib());
+        req.respond(responseEnvelope);
+      });
 }
 
 std::string GetService::getURI() const
 {
-  return MetadataProvider::getGetServicePath();
-}
-
-void GetService::handleRequest(std::unique_ptr<Request> req)
-{
-  const auto& requestEnvelope = req->getEnvelope();
-  const auto& soapAction = requestEnvelope.Header.Action;
-  if (soapAction == MDPWS::WS_ACTION_GET_METADATA_REQUEST)
-  {
-    MESSAGEMODEL::Envelope responseEnvelope;
-    fillResponseMessageFromRequestMessage(responseEnvelope, requestEnvelope);
-    metadata_->fillGetServiceMetadata(responseEnvelope);
-    responseEnvelope.Header.Action =
-        WS::ADDRESSING::URIType(MDPWS::WS_ACTION_GET_METADATA_RESPONSE);
-    req->respond(responseEnvelope);
-  }
-  else if (soapAction == SDC::ACTION_GET_MDIB_REQUEST)
-  {
-    MESSAGEMODEL::Envelope responseEnvelope;
-    fillResponseMessageFromRequestMessage(responseEnvelope, requestEnvelope);
-    responseEnvelope.Header.Action = WS::ADDRESSING::URIType(SDC::ACTION_GET_MDIB_RESPONSE);
-    responseEnvelope.Body.GetMdibResponse =
-        std::make_optional<MESSAGEMODEL::Body::GetMdibResponseType>(microSDC_.getMdib());
-    req->respond(responseEnvelope);
-  }
-  else
-  {
-    LOG(LogLevel::ERROR, "Unknown soap action " << soapAction);
-    req->respond(SoapFault().envelope());
-  }
+  return metadata_->getGetServicePath();
 }
@@ -17,7 +17,8 @@ public:
   /// @return the URI
   virtual std::string getURI() const = 0;
 
-  /// @brief handles any kind of incoming request
+  /// @brief handles any kind of incoming request. The service takes ownership of the request and
+  /// may respond to it from another thread after deferring it, see Request::defer.
   /// @param req a pointer to the Request to be handled
   virtual void handleRequest(std::unique_ptr<Request> req) = 0;
 };
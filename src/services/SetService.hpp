@@ -24,7 +24,6 @@ public:
              std::shared_ptr<SubscriptionManager> subscriptionManager);
 
   std::string getURI() const override;
-  void handleRequest(std::unique_ptr<Request> req) override;
 
 private:
   /// a reference to the microSDC instance holding this service
@@ -1,6 +1,54 @@
 #include "SoapService.hpp"
+#include "Log.hpp"
 #include "MicroSDC.hpp"
+#include "SubscriptionManager.hpp"
+#include "WebServer/Request.hpp"
+#include "datamodel/ExpectedElement.hpp"
+#include "datamodel/MDPWSConstants.hpp"
 #include "datamodel/MessageModel.hpp"
+#include "services/SoapFault.hpp"
+
+static constexpr const char* TAG = "SoapService";
+
+void SoapService::handleRequest(std::unique_ptr<Request> req)
+{
+  const auto& requestEnvelope = req->getEnvelope();
+  const auto* action = actions_.find(requestEnvelope);
+  if (action == nullptr)
+  {
+    LOG(LogLevel::ERROR, "Unknown soap action " << requestEnvelope.Header.Action);
+    req->respond(SoapFault().envelope());
+    return;
+  }
+  if (action->deferred && workerExecutor_ && req->defer())
+  {
+    runDeferred(*action, std::move(req));
+    return;
+  }
+  action->handler(*req, requestEnvelope);
+}
+
+void SoapService::setWorkerExecutor(Executor executor)
+{
+  workerExecutor_ = std::move(executor);
+}
+
+void SoapService::runDeferred(const ActionRegistry::Action& action,
+                              std::unique_ptr<Request> req) const
+{
+  // std::function requires a copyable task
+  workerExecutor_([&action, req = std::shared_ptr<Request>(std::move(req))]() {
+    try
+    {
+      action.handler(*req, req->getEnvelope());
+    }
+    catch (const std::exception& e)
+    {
+      LOG(LogLevel::ERROR, "Error handling deferred request: " << e.what());
+      req->respond(SoapFault().envelope());
+    }
+  });
+}
 
 void SoapService::fillResponseMessageFromRequestMessage(MESSAGEMODEL::Envelope& envelope,
                                                         const MESSAGEMODEL::Envelope& request)
@@ -10,3 +58,49 @@ void SoapService::fillResponseMessageFromRequestMessage(MESSAGEMODEL::Envelope&
   envelope.Header.RelatesTo =
       WS::ADDRESSING::RelatesToType(request.Header.MessageID.value());
 }
+
+void SoapService::registerEventingActions(
+    std::shared_ptr<SubscriptionManager> subscriptionManager,
+    std::function<WS::ADDRESSING::URIType()> subscriptionManagerAddress)
+{
+  actions_.registerAction(
+      MDPWS::WS_ACTION_SUBSCRIBE,
+      [subscriptionManager, subscriptionManagerAddress = std::move(subscriptionManagerAddress)](
+          Request& req, const MESSAGEMODEL::Envelope& requestEnvelope) {
+        auto response = subscriptionManager->dispatch(requestEnvelope.Body.Subscribe.value(),
+                                                      subscriptionManagerAddress());
+        MESSAGEMODEL::Envelope responseEnvelope;
+        fillResponseMessageFromRequestMessage(responseEnvelope, requestEnvelope);
+        responseEnvelope.Header.Action =
+            WS::ADDRESSING::URIType(MDPWS::WS_ACTION_SUBSCRIBE_RESPONSE);
+        responseEnvelope.Body.SubscribeResponse = response;
+        req.respond(responseEnvelope);
+      });
+  actions_.registerAction(
+      MDPWS::WS_ACTION_RENEW,
+      [subscriptionManager](Request& req, const MESSAGEMODEL::Envelope& requestEnvelope) {
+        const auto& renewRequest = requestEnvelope.Body.Renew.value();
+        if (!requestEnvelope.Header.Identifier.has_value())
+        {
+          throw ExpectedElement("Identifier", MDPWS::WS_NS_EVENTING);
+        }
+        auto response =
+            subscriptionManager->dispatch(renewRequest, requestEnvelope.Header.Identifier.value());
+        MESSAGEMODEL::Envelope responseEnvelope;
+        fillResponseMessageFromRequestMessage(responseEnvelope, requestEnvelope);
+        responseEnvelope.Header.Action = WS::ADDRESSING::URIType(MDPWS::WS_ACTION_RENEW_RESPONSE);
+        responseEnvelope.Body.RenewResponse = response;
+        req.respond(responseEnvelope);
+      });
+  actions_.registerAction(
+      MDPWS::WS_ACTION_UNSUBSCRIBE,
+      [subscriptionManager](Request& req, const MESSAGEMODEL::Envelope& requestEnvelope) {
+        subscriptionManager->dispatch(requestEnvelope.Body.Unsubscribe.value(),
+                                      requestEnvelope.Header.Identifier.value());
+        MESSAGEMODEL::Envelope responseEnvelope;
+        fillResponseMessageFromRequestMessage(responseEnvelope, requestEnvelope);
+        responseEnvelope.Header.Action =
+            WS::ADDRESSING::URIType(MDPWS::WS_ACTION_UNSUBSCRIBE_RESPONSE);
+        req.respond(responseEnvelope);
+      });
+}
@@ -1,20 +1,57 @@
 #pragma once
 
+#include "ActionRegistry.hpp"
 #include "ServiceInterface.hpp"
 #include <exception>
+#include <functional>
 
+class SubscriptionManager;
 namespace MESSAGEMODEL
 {
   class Envelope;
 } // namespace MESSAGEMODEL
+namespace WS::ADDRESSING
+{
+  struct URIType;
+} // namespace WS::ADDRESSING
 
-/// @brief SoapService defines an interface to a very general SOAP service
+/// @brief SoapService defines an interface to a very general SOAP service. Requests are dispatched
+/// by their action to the handlers a service registers in its ActionRegistry.
 class SoapService : public ServiceInterface
 {
 public:
+  /// runs a task on a worker thread
+  using Executor = std::function<void(std::function<void()> task)>;
+
+  void handleRequest(std::unique_ptr<Request> req) final;
+
+  /// @brief sets the executor running the handlers of deferred actions. Without an executor they
+  /// are run on the web server thread like any other action.
+  /// @param executor the executor to run deferred actions on
+  void setWorkerExecutor(Executor executor);
+
   /// @brief fills the given envelope with reply header information from a given request
   /// @param[out] envelope the envelope of the header to fill
   /// @param request the request holding information of the reply data
   static void fillResponseMessageFromRequestMessage(MESSAGEMODEL::Envelope& envelope,
                                                     const MESSAGEMODEL::Envelope& request);
+
+protected:
+  /// the handlers of the actions this service provides
+  ActionRegistry actions_;
+  /// runs deferred actions
+  Executor workerExecutor_;
+
+  /// @brief registers the WS-Eventing Subscribe, Renew and Unsubscribe actions
+  /// @param subscriptionManager the SubscriptionManager maintaining the subscriptions
+  /// @param subscriptionManagerAddress returns the address of the service managing subscriptions
+  void registerEventingActions(
+      std::shared_ptr<SubscriptionManager> subscriptionManager,
+      std::function<WS::ADDRESSING::URIType()> subscriptionManagerAddress);
+
+private:
+  /// @brief runs a deferred action on a worker thread and responds with a SoapFault if it fails
+  /// @param action the action to run
+  /// @param req the deferred request to handle
+  void runDeferred(const ActionRegistry::Action& action, std::unique_ptr<Request> req) const;
 };
@@ -0,0 +1,195 @@
+#include "StreamingService.hpp"
+#include "Log.hpp"
+#include "MicroSDC.hpp"
+#include "SDCConstants.hpp"
+#include "datamodel/MessageModel.hpp"
+#include "datamodel/MessageSerializer.hpp"
+#include "uuid/UUID.hpp"
+#include <future>
+#include <memory>
+#include <utility>
+
+static constexpr const char* TAG = "Streaming";
+
+/// a MessageID of the length of generated ones, measuring messages without generating a UUID
+static const std::string MEASURE_MESSAGE_ID = std::string(SDC::UUID_SDC_PREFIX) + UUID().toString();
+
+StreamingService::StreamingService(const std::string& address, std::uint16_t port,
+                                   std::shared_ptr<asio::io_context> ioContext)
+  : ownsIOContext_(ioContext == nullptr)
+  , ioContext_(ownsIOContext_ ? std::make_shared<asio::io_context>() : std::move(ioContext))
+  , strand_(asio::make_strand(*ioContext_))
+  , multicastEndpoint_(asio::ip::make_address(address), port)
+  , socket_(strand_, multicastEndpoint_.protocol())
+{
+  socket_.set_option(asio::ip::multicast::hops(MDPWS::UDP_MULTICAST_TIMETOLIVE));
+}
+
+StreamingService::~StreamingService() noexcept
+{
+  stop();
+}
+
+void StreamingService::start()
+{
+  running_.store(true);
+  LOG(LogLevel::INFO, "Start streaming to " << getStreamAddress() << "...");
+  if (!ownsIOContext_)
+  {
+    return;
+  }
+  workGuard_.emplace(asio::make_work_guard(*ioContext_));
+  thread_ = std::thread([this]() {
+    ioContext_->run();
+    LOG(LogLevel::INFO, "Shutting down streaming service thread...");
+  });
+}
+
+void StreamingService::stop()
+{
+  if (!running_.exchange(false))
+  {
+    return;
+  }
+  LOG(LogLevel::INFO, "Stopping...");
+  if (ownsIOContext_)
+  {
+    workGuard_.reset();
+    socket_.close();
+    ioContext_->stop();
+    thread_.join();
+    return;
+  }
+  // the send handlers do not refer to this service, it is done once the queue was worked off
+  std::promise<void> stopped;
+  asio::post(strand_, [this, &stopped]() {
+    socket_.close();
+    stopped.set_value();
+  });
+  stopped.get_future().wait();
+}
+
+bool StreamingService::running() const
+{
+  return running_.load();
+}
+
+std::string StreamingService::getStreamAddress() const
+{
+  std::string address = MDPWS::SOAP_OVER_UDP_SCHEME;
+  if (multicastEndpoint_.address().is_v6())
+  {
+    // ipv6 literals are bracketed in URIs, the scope is local to this host
+    auto host = multicastEndpoint_.address().to_v6();
+    host.scope_id(0);
+    address += "[" + host.to_string() + "]";
+  }
+  else
+  {
+    address += multicastEndpoint_.address().to_string();
+  }
+  return address + ":" + std::to_string(multicastEndpoint_.port());
+}
+
+void StreamingService::publish(StateSequence states, unsigned int mdibVersion)
+{
+  if (!running_.load())
+  {
+    return;
+  }
+  asio::post(strand_, [this, states = std::move(states), mdibVersion]() {
+    doPublish(states, mdibVersion);
+  });
+}
+
+void StreamingService::doPublish(const StateSequence& states, unsigned int mdibVersion)
+{
+  // the size of an envelope without states. States add their serialized length to it.
+  const auto emptySize = serializeStream({}, mdibVersion, MEASURE_MESSAGE_ID).size();
+  std::vector<SizedState> parts;
+  for (const auto& state : states)
+  {
+    splitState(state, mdibVersion, emptySize, parts);
+  }
+  // only the messages actually sent are serialized with a MessageID of their own
+  StateSequence batch;
+  std::size_t batchSize = emptySize;
+  for (auto& [part, partSize] : parts)
+  {
+    if (!batch.empty() && batchSize + partSize > MDPWS::MAX_UDP_ENVELOPE_SIZE)
+    {
+      send(serializeStream(batch, mdibVersion, MicroSDC::calculateMessageID()));
+      batch.clear();
+      batchSize = emptySize;
+    }
+    batch.emplace_back(std::move(part));
+    batchSize += partSize;
+  }
+  if (!batch.empty())
+  {
+    send(serializeStream(batch, mdibVersion, MicroSDC::calculateMessageID()));
+  }
+}
+
+void StreamingService::splitState(const StateSequence::value_type& state,
+                                  unsigned int mdibVersion, std::size_t emptySize,
+                                  std::vector<SizedState>& parts) const
+{
+  const auto size = serializeStream({state}, mdibVersion, MEASURE_MESSAGE_ID).size();
+  if (size <= MDPWS::MAX_UDP_ENVELOPE_SIZE)
+  {
+    parts.emplace_back(state, size - emptySize);
+    return;
+  }
+  if (!state->MetricValue.has_value() || !state->MetricValue->Samples.has_value() ||
+      state->MetricValue->Samples->size() < 2)
+  {
+    LOG(LogLevel::ERROR, "Cannot fit state '" << state->DescriptorHandle
+                                              << "' into a single datagram. Dropping.");
+    return;
+  }
+  // halve the sample block and retry with each half in order
+  const auto& samples = state->MetricValue->Samples.value();
+  const auto middle = samples.begin() + static_cast<std::ptrdiff_t>(samples.size() / 2);
+  auto first = std::make_shared<BICEPS::PM::RealTimeSampleArrayMetricState>(*state);
+  first->MetricValue->Samples = BICEPS::PM::SampleArrayValue::SamplesType(samples.begin(), middle);
+  auto second = std::make_shared<BICEPS::PM::RealTimeSampleArrayMetricState>(*state);
+  second->MetricValue->Samples = BICEPS::PM::SampleArrayValue::SamplesType(middle, samples.end());
+  splitState(first, mdibVersion, emptySize, parts);
+  splitState(second, mdibVersion, emptySize, parts);
+}
+
+std::string StreamingService::serializeStream(const StateSequence& states,
+                                              unsigned int mdibVersion,
+                                              const std::string& messageId) const
+{
+  MESSAGEMODEL::Envelope envelope;
+  envelope.Header.Action = WS::ADDRESSING::URIType(SDC::ACTION_WAVEFORM_STREAM);
+  envelope.Header.MessageID = WS::ADDRESSING::URIType(messageId);
+  envelope.Header.To = WS::ADDRESSING::URIType(getStreamAddress());
+  auto& stream = envelope.Body.WaveformStream =
+      BICEPS::MM::WaveformStream(WS::ADDRESSING::URIType("0"));
+  stream->MdibVersion = mdibVersion;
+  stream->State = states;
+
+  MessageSerializer serializer;
+  serializer.serialize(envelope);
+  return serializer.str();
+}
+
+void StreamingService::send(std::string message)
+{
+  auto msg = std::make_shared<std::string>(std::move(message));
+  socket_.async_send_to(asio::buffer(*msg), multicastEndpoint_,
+                        [msg](const std::error_code& ec, const std::size_t bytesTransferred) {
+                          if (ec)
+                          {
+                            LOG(LogLevel::ERROR,
+                                "Error while sending waveform stream: ec " << ec.value() << ": "
+                                                                           << ec.message());
+                            return;
+                          }
+                          LOG(LogLevel::DEBUG, "Sent waveform stream msg (" << bytesTransferred
+                                                                            << " bytes)");
+                        });
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "datamodel/BICEPS_MessageModel.hpp"
+#include "datamodel/MDPWSConstants.hpp"
+#include <asio.hpp>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// @brief StreamingService publishes waveform data as MDPWS stream over SOAP-over-UDP multicast.
+/// Every sample block is sent once to the multicast group regardless of the number of consumers.
+class StreamingService
+{
+public:
+  using StateSequence = BICEPS::MM::WaveformStream::StateSequence;
+
+  /// @brief Constructs StreamingService publishing to a given multicast group
+  /// @param address the ipv4 or ipv6 multicast address to publish to
+  /// @param port the udp port to publish to
+  /// @param ioContext the io context to send on, shared with other components. A thread running an
+  /// io context of its own is started if none is given.
+  StreamingService(const std::string& address, std::uint16_t port,
+                   std::shared_ptr<asio::io_context> ioContext = nullptr);
+  StreamingService(const StreamingService&) = delete;
+  StreamingService(StreamingService&&) = delete;
+  StreamingService& operator=(const StreamingService&) = delete;
+  StreamingService& operator=(StreamingService&&) = delete;
+  ~StreamingService() noexcept;
+
+  /// @brief starts sending queued stream messages
+  void start();
+
+  /// @brief stops the streaming service. On a shared io context the queued messages are sent
+  /// first, so it must not be called on a thread running the io context.
+  void stop();
+
+  /// @brief Returns whether this streaming service is running
+  /// @return whether this service runs
+  bool running() const;
+
+  /// @brief gets the address this stream is published to, e.g. soap.udp://239.239.239.235:5555
+  /// @return the stream address
+  std::string getStreamAddress() const;
+
+  /// @brief publishes sample array states. The states are packed into as few WaveformStream
+  /// messages as fit into MDPWS::MAX_UDP_ENVELOPE_SIZE. Serialization and sending happen on the
+  /// io context in the order of publishing.
+  /// @param states the states to publish
+  /// @param mdibVersion the mdib version the states belong to
+  void publish(StateSequence states, unsigned int mdibVersion);
+
+private:
+  /// whether this streaming service runs
+  std::atomic_bool running_{false};
+  /// whether the io context was created by this service and is run by thread_
+  const bool ownsIOContext_;
+  /// asio IO context for the streaming service
+  const std::shared_ptr<asio::io_context> ioContext_;
+  /// keeps the stream messages in order on an io context run by several threads
+  const asio::strand<asio::io_context::executor_type> strand_;
+  /// thread running the io context if it is owned by this service
+  std::thread thread_;
+  /// keeps the owned io context running while no message is queued
+  std::optional<asio::executor_work_guard<asio::io_context::executor_type>> workGuard_;
+  /// multicast endpoint of the stream
+  const asio::ip::udp::endpoint multicastEndpoint_;
+  /// sending socket for stream messages of the protocol of the multicast endpoint
+  asio::ip::udp::socket socket_;
+
+  /// a state fitting into a single datagram and the length it adds to a message
+  using SizedState = std::pair<StateSequence::value_type, std::size_t>;
+
+  /// @brief packs and sends the given states to the multicast group
+  /// @param states the states to send
+  /// @param mdibVersion the mdib version the states belong to
+  void doPublish(const StateSequence& states, unsigned int mdibVersion);
+
+  /// @brief splits a state into states with fewer samples until each fits into a single datagram
+  /// @param state the state to split
+  /// @param mdibVersion the mdib version the state belongs to
+  /// @param emptySize the length of a message of this mdib version without states
+  /// @param[out] parts the resulting states with their serialized lengths
+  void splitState(const StateSequence::value_type& state, unsigned int mdibVersion,
+                  std::size_t emptySize, std::vector<SizedState>& parts) const;
+
+  /// @brief serializes a WaveformStream message containing the given states
+  /// @param states the states to serialize
+  /// @param mdibVersion the mdib version the states belong to
+  /// @param messageId the MessageID of the message
+  /// @return the serialized envelope
+  std::string serializeStream(const StateSequence& states, unsigned int mdibVersion,
+                              const std::string& messageId) const;
+
+  /// @brief sends a serialized message to the multicast endpoint
+  /// @param message the message to send
+  void send(std::string message);
+};